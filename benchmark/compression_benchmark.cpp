@@ -0,0 +1,514 @@
+#include "chacha20.h"
+#include "common.h"
+#include "compressor.h"
+#include "crc32c.h"
+#include "decompressor.h"
+#include "huffman.h"
+#include "lz77.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 完整的 Compressor::compressFile（含上下文模式、自适应分块、LZ77 前端、BWT 变换、ChaCha20 加密与共享字典）与三种解码方式的
+// 吞吐量（MB/s、ns/byte）及峰值内存（RSS）
+// 用法: CompressionBenchmark [--sizes 1K,64K,1M,16M] [--corpus uniform,text,skewed,repetitive,mixed]
+//                            [--repeats N] [--dir 临时目录]
+//       大小可带 K / M / G 后缀（如 --sizes 1G），每项取 N 次中最快的一次（256 MB 以上只运行一次）
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 基准用的 XOR 密钥
+    const std::string KEY = "benchmark-key";
+
+    const char *USAGE =
+        "Usage: CompressionBenchmark [options]\n"
+        "  --sizes LIST     input sizes, K/M/G suffixes allowed (default 1K,64K,1M,16M)\n"
+        "  --corpus LIST    corpora: uniform,text,skewed,repetitive,mixed (default all)\n"
+        "  --repeats N      best of N runs per measurement (default 3)\n"
+        "  --dir DIR        directory for temporary files\n"
+        "  -h, --help       show this help\n";
+
+    // 函数: parseSize
+    // 用途: 解析带 K / M / G 后缀的字节数，格式错误时返回 0
+    std::size_t parseSize(const std::string &text) {
+        char *end = nullptr;
+        std::size_t value = std::strtoull(text.c_str(), &end, 10);
+        switch (*end) {
+        case 'K': case 'k': return value << 10;
+        case 'M': case 'm': return value << 20;
+        case 'G': case 'g': return value << 30;
+        case '\0': return value;
+        default: return 0;
+        }
+    }
+
+    // 函数: sizeName
+    // 用途: 将字节数格式化为 1K、16M 这样的简写
+    std::string sizeName(std::size_t size) {
+        const char *suffix[] = {"", "K", "M", "G"};
+        int unit = 0;
+        while (unit < 3 && size >= 1024 && size % 1024 == 0) {
+            size /= 1024;
+            unit++;
+        }
+        return std::to_string(size) + suffix[unit];
+    }
+
+    // 函数: split
+    // 用途: 按逗号拆分参数列表
+    std::vector<std::string> split(const std::string &text) {
+        std::vector<std::string> items;
+        std::stringstream in(text);
+        std::string item;
+        while (std::getline(in, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    // 函数: generateCorpus
+    // 用途: 生成 size 字节的合成语料（固定随机种子，结果可重复）：
+    //       uniform    - 均匀分布的随机字节（几乎不可压缩）
+    //       text       - 类英文文本：按近似 Zipf 分布抽取常用词，夹杂标点与换行
+    //       skewed     - 高度倾斜：字节值服从几何分布，少数字节占绝大多数
+    //       repetitive - 高度重复：一段 4 KB 的文本反复出现
+    //       mixed      - 分布突变：text、uniform、skewed 各占三分之一依次拼接
+    bool generateCorpus(const std::string &kind, std::size_t size, std::vector<unsigned char> &data) {
+        if (kind == "mixed") {
+            const char *parts[] = {"text", "uniform", "skewed"};
+            std::vector<unsigned char> part;
+            data.clear();
+            for (int i = 0; i < 3; i++) {
+                generateCorpus(parts[i], size * (i + 1) / 3 - size * i / 3, part);
+                data.insert(data.end(), part.begin(), part.end());
+            }
+            return true;
+        }
+        data.resize(size);
+        std::mt19937_64 rng(12345);
+        if (kind == "uniform") {
+            for (std::size_t i = 0; i < size; i += 8) {
+                uint64_t word = rng();
+                for (std::size_t k = 0; k < 8 && i + k < size; k++) {
+                    data[i + k] = static_cast<unsigned char>(word >> (8 * k));
+                }
+            }
+            return true;
+        }
+        if (kind == "skewed") {
+            std::geometric_distribution<int> dist(0.35);
+            for (std::size_t i = 0; i < size; i++) {
+                data[i] = static_cast<unsigned char>('a' + std::min(dist(rng), 200));
+            }
+            return true;
+        }
+        if (kind != "text" && kind != "repetitive") {
+            return false;
+        }
+        static const char *words[] = {
+            "the", "of", "and", "to", "a", "in", "is", "it", "you", "that", "he", "was", "for", "on", "are",
+            "with", "as", "his", "they", "be", "at", "one", "have", "this", "from", "or", "had", "by", "word",
+            "but", "what", "some", "we", "can", "out", "other", "were", "all", "there", "when", "up", "use",
+            "your", "how", "said", "an", "each", "she", "which", "do", "their", "time", "if", "will", "way",
+            "about", "many", "then", "them", "write", "would", "like", "so", "these", "her", "long", "make",
+            "thing", "see", "him", "two", "has", "look", "more", "day", "could", "go", "come", "did", "number",
+            "sound", "no", "most", "people", "my", "over", "know", "water", "than", "call", "first", "who",
+            "may", "down", "side", "been", "now", "find", "compression", "Huffman", "encoding", "frequency"};
+        const std::size_t wordCount = sizeof(words) / sizeof(words[0]);
+        // 第 r 个词的权重约为 1 / (r + 1)
+        std::vector<double> weights(wordCount);
+        for (std::size_t r = 0; r < wordCount; r++) {
+            weights[r] = 1.0 / (r + 1);
+        }
+        std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+        std::size_t textSize = kind == "text" ? size : std::min<std::size_t>(size, 4096);
+        std::size_t pos = 0;
+        int sentence = 0;
+        while (pos < textSize) {
+            std::string token = words[pick(rng)];
+            if (sentence == 0) {
+                token[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(token[0])));
+            }
+            sentence++;
+            if (sentence > 6 && rng() % 8 == 0) {
+                token += rng() % 6 == 0 ? ".\n" : ". ";
+                sentence = 0;
+            } else {
+                token += rng() % 10 == 0 ? ", " : " ";
+            }
+            for (std::size_t k = 0; k < token.size() && pos < textSize; k++) {
+                data[pos++] = static_cast<unsigned char>(token[k]);
+            }
+        }
+        for (std::size_t i = textSize; i < size; i++) {
+            data[i] = data[i % textSize];
+        }
+        return true;
+    }
+
+    // 函数: resetPeakRss
+    // 用途: 将本进程的峰值内存（VmHWM）重置为当前内存，使每项测量只统计自身的峰值（Linux）
+    void resetPeakRss() {
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5" << std::flush;
+    }
+
+    // 函数: peakRssMB
+    // 用途: 读取本进程自上次重置以来的峰值内存（MB）
+    double peakRssMB() {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmHWM:") == 0) {
+                return std::strtod(line.c_str() + 6, nullptr) / 1024;
+            }
+        }
+        return 0;
+    }
+
+    // 函数: fileContent
+    // 用途: 读取整个文件，用于校验解压结果
+    std::vector<unsigned char> fileContent(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<unsigned char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // 函数: measure
+    // 用途: 运行 run 若干次（每次之前先调用 prepare，之后调用 check 校验结果，两者都不计入耗时），
+    //       输出最快一次的吞吐量、每字节耗时与峰值内存；run 或 check 返回 false 时标记为失败
+    void measure(const std::string &corpus, std::size_t size, const std::string &stage, int repeats,
+                 const std::function<void()> &prepare, const std::function<bool()> &run,
+                 const std::function<bool()> &check = nullptr) {
+        double best = 0;
+        double peak = 0;
+        bool ok = true;
+        for (int r = 0; r < repeats; r++) {
+            prepare();
+            resetPeakRss();
+            auto start = std::chrono::steady_clock::now();
+            ok = run() && ok;
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            best = r == 0 ? seconds : std::min(best, seconds);
+            peak = std::max(peak, peakRssMB());
+            ok = ok && (!check || check());
+        }
+        std::cout << std::left << std::setw(12) << corpus << std::right << std::setw(6) << sizeName(size)
+                  << "  " << std::left << std::setw(22) << stage << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << (best > 0 ? size / best / (1 << 20) : 0.0) << " MB/s"
+                  << std::setprecision(3) << std::setw(12) << best * 1e9 / size << " ns/B"
+                  << std::setprecision(1) << std::setw(10) << peak << " MB"
+                  << (ok ? "" : "  (FAILED)") << std::endl;
+    }
+
+    // 函数: runCorpus
+    // 用途: 对一份语料运行全部测量项
+    void runCorpus(const std::string &corpus, const std::vector<unsigned char> &original,
+                   const fs::path &dir, int repeats) {
+        const std::size_t size = original.size();
+        std::vector<unsigned char> work;
+        auto copyOriginal = [&]() { work = original; };
+        auto nothing = []() {};
+
+        // 1. 压缩各阶段的核心计算（数据已在内存中）
+        // CRC32C 各实现的校验和须相同
+        uint32_t hash = 0;
+        for (CRC32C::Implementation implementation :
+             {CRC32C::Implementation::SLICING_BY_8, CRC32C::Implementation::SSE42}) {
+            if (!CRC32C::supported(implementation)) {
+                continue;
+            }
+            uint32_t crc = 0;
+            measure(corpus, size, std::string("crc32c ") + CRC32C::implementationName(implementation), repeats,
+                    nothing, [&]() {
+                crc = CRC32C::update(0, original.data(), size, implementation);
+                return true;
+            }, [&]() {
+                if (implementation == CRC32C::Implementation::SLICING_BY_8) {
+                    hash = crc;
+                }
+                return crc == hash;
+            });
+        }
+        measure(corpus, size, "xor encrypt", repeats, copyOriginal, [&]() {
+            Common::encrypt(work.data(), size, KEY, 0);
+            return true;
+        });
+        std::vector<uint64_t> encryptedFreq(256, 0);
+        Common::countBytes(work.data(), size, encryptedFreq, 1);
+        std::vector<uint64_t> freq;
+        measure(corpus, size, "histogram", repeats, [&]() { freq.assign(256, 0); }, [&]() {
+            Common::countBytes(original.data(), size, freq, 1);
+            return true;
+        });
+        // 融合的校验和、加密与频率统计（单线程），结果须与分别计算的相同
+        std::vector<uint64_t> fusedFreq;
+        uint32_t fusedHash = 0;
+        Common::Cipher cipher(KEY);
+        measure(corpus, size, "crc+xor+histogram", repeats, [&]() {
+            copyOriginal();
+            fusedFreq.assign(256, 0);
+            fusedHash = 0;
+        }, [&]() {
+            Common::encryptAndCount(work.data(), size, 0, &cipher, &fusedHash, fusedFreq, 1);
+            return true;
+        }, [&]() { return fusedHash == hash && fusedFreq == encryptedFreq; });
+        // ChaCha20 各实现的密钥流异或，结果须与标量实现相同
+        const ChaCha20::Key chachaKey{};
+        std::vector<unsigned char> scalarResult;
+        for (ChaCha20::Implementation implementation :
+             {ChaCha20::Implementation::SCALAR, ChaCha20::Implementation::SSE2, ChaCha20::Implementation::AVX2}) {
+            if (!ChaCha20::supported(implementation)) {
+                continue;
+            }
+            ChaCha20::Stream stream(chachaKey, 0, implementation);
+            measure(corpus, size, std::string("chacha20 ") + ChaCha20::implementationName(implementation), repeats,
+                    copyOriginal, [&]() {
+                stream.apply(work.data(), size, 0);
+                return true;
+            }, [&]() {
+                if (implementation == ChaCha20::Implementation::SCALAR) {
+                    scalarResult = work;
+                }
+                return work == scalarResult;
+            });
+        }
+        std::vector<unsigned char>().swap(scalarResult);
+        std::vector<unsigned char>().swap(work);
+        std::vector<Huffman::Code> codes;
+        measure(corpus, size, "code table", repeats, nothing, [&]() {
+            codes = Huffman::canonicalCodes(Huffman::limitedCodeLengths(freq, Huffman::MAX_CODE_LENGTH));
+            return !codes.empty();
+        });
+        std::vector<Huffman::Code> table(256, Huffman::Code{0, 0, 0});
+        for (const Huffman::Code &code : codes) {
+            table[code.symbol] = code;
+        }
+        std::vector<unsigned char> packed;
+        measure(corpus, size, "encode", repeats, [&]() { packed.clear(); }, [&]() {
+            Huffman::BitWriter writer(packed);
+            writer.putSymbols(original.data(), size, table.data());
+            writer.finish();
+            return true;
+        });
+
+        // 释放中间结果，避免计入后续各项的峰值内存
+        std::vector<unsigned char>().swap(packed);
+
+        // 2. 完整的文件压缩与三种解码方式的文件解压
+        std::string name = corpus + "_" + sizeName(size);
+        std::string inputFile = (dir / (name + ".txt")).string();
+        std::string compressedFile = (dir / (name + ".hfm")).string();
+        std::string outputFile = (dir / (name + "_j.txt")).string();
+        {
+            std::ofstream out(inputFile, std::ios::binary);
+            out.write(reinterpret_cast<const char *>(original.data()), size);
+        }
+        Compressor::Options compressOptions;
+        compressOptions.outputDir = dir.string();
+        compressOptions.threads = 1;
+        compressOptions.verbosity = Verbosity::QUIET;
+        measure(corpus, size, "compressFile", repeats, nothing, [&]() {
+            return Compressor::compressFile(inputFile, "", "", false, "", compressOptions);
+        });
+
+        Decompressor::Options decompressOptions;
+        decompressOptions.outputDir = dir.string();
+        decompressOptions.threads = 1;
+        decompressOptions.verbosity = Verbosity::QUIET;
+        using DecompressFunction = bool (*)(const std::string &, const std::string &, const std::string &, bool,
+                                            const std::string &, const Decompressor::Options &);
+        const std::pair<const char *, DecompressFunction> engines[] = {
+            {"decompress table", TableDecompressor::decompressFile},
+            {"decompress trie", TrieDecompressor::decompressFile},
+            {"decompress hash", HashDecompressor::decompressFile}};
+        for (const auto &engine : engines) {
+            // 哈希映射解码逐位查找，大数据量时很慢，只测量 64 MB 以内的语料
+            if (engine.second == HashDecompressor::decompressFile && size > (std::size_t(64) << 20)) {
+                continue;
+            }
+            measure(corpus, size, engine.first, repeats, [&]() { fs::remove(outputFile); },
+                    [&]() { return engine.second(compressedFile, "", "", false, "", decompressOptions); },
+                    [&]() { return fileContent(outputFile) == original; });
+        }
+
+        // 3. 一阶上下文模式的压缩与查表解压，并显示两种模式的压缩文件大小
+        std::uintmax_t order0Size = fs::file_size(compressedFile);
+        compressOptions.contextModel = true;
+        measure(corpus, size, "compressFile order-1", repeats, nothing, [&]() {
+            return Compressor::compressFile(inputFile, "", "", false, "", compressOptions);
+        });
+        measure(corpus, size, "decompress order-1", repeats, [&]() { fs::remove(outputFile); },
+                [&]() { return TableDecompressor::decompressFile(compressedFile, "", "", false, "", decompressOptions); },
+                [&]() { return fileContent(outputFile) == original; });
+        std::uintmax_t order1Size = fs::file_size(compressedFile);
+
+        // 4. 自适应分块的压缩与查表解压
+        compressOptions.contextModel = false;
+        compressOptions.adaptiveBlocks = true;
+        measure(corpus, size, "compressFile adaptive", repeats, nothing, [&]() {
+            return Compressor::compressFile(inputFile, "", "", false, "", compressOptions);
+        });
+        measure(corpus, size, "decompress adaptive", repeats, [&]() { fs::remove(outputFile); },
+                [&]() { return TableDecompressor::decompressFile(compressedFile, "", "", false, "", decompressOptions); },
+                [&]() { return fileContent(outputFile) == original; });
+        std::uintmax_t adaptiveSize = fs::file_size(compressedFile);
+
+        // 5. LZ77 前端各匹配查找策略的压缩与查表解压
+        compressOptions.adaptiveBlocks = false;
+        std::string lzSizes;
+        for (LZ77::Level level : {LZ77::Level::GREEDY, LZ77::Level::LAZY, LZ77::Level::OPTIMAL}) {
+            std::string name = LZ77::levelName(level);
+            compressOptions.lzLevel = level;
+            measure(corpus, size, "compressFile lz " + name, repeats, nothing, [&]() {
+                return Compressor::compressFile(inputFile, "", "", false, "", compressOptions);
+            });
+            measure(corpus, size, "decompress lz " + name, repeats, [&]() { fs::remove(outputFile); },
+                    [&]() { return TableDecompressor::decompressFile(compressedFile, "", "", false, "", decompressOptions); },
+                    [&]() { return fileContent(outputFile) == original; });
+            lzSizes += ", lz " + name + " " + std::to_string(fs::file_size(compressedFile)) + " bytes";
+        }
+        compressOptions.lzLevel = LZ77::Level::NONE;
+
+        // 6. BWT 变换的压缩与查表解压
+        compressOptions.bwt = true;
+        measure(corpus, size, "compressFile bwt", repeats, nothing, [&]() {
+            return Compressor::compressFile(inputFile, "", "", false, "", compressOptions);
+        });
+        measure(corpus, size, "decompress bwt", repeats, [&]() { fs::remove(outputFile); },
+                [&]() { return TableDecompressor::decompressFile(compressedFile, "", "", false, "", decompressOptions); },
+                [&]() { return fileContent(outputFile) == original; });
+        std::uintmax_t bwtSize = fs::file_size(compressedFile);
+        compressOptions.bwt = false;
+
+        // 7. ChaCha20 加密的压缩与查表解压（含每个文件一次的 PBKDF2 密钥派生）
+        compressOptions.chacha20 = true;
+        measure(corpus, size, "compressFile chacha20", repeats, nothing, [&]() {
+            return Compressor::compressFile(inputFile, "", "", true, KEY, compressOptions);
+        });
+        measure(corpus, size, "decompress chacha20", repeats, [&]() { fs::remove(outputFile); },
+                [&]() { return TableDecompressor::decompressFile(compressedFile, "", "", true, KEY, decompressOptions); },
+                [&]() { return fileContent(outputFile) == original; });
+        compressOptions.chacha20 = false;
+
+        // 8. 记录同步点后只解压最后 64 KB（耗时应与范围大小成正比，不随语料增大）
+        compressOptions.syncInterval = std::size_t(64) << 10;
+        measure(corpus, size, "compressFile sync", repeats, nothing, [&]() {
+            return Compressor::compressFile(inputFile, "", "", false, "", compressOptions);
+        });
+        compressOptions.syncInterval = 0;
+        uint64_t rangeLength = std::min<uint64_t>(size, std::size_t(64) << 10);
+        uint64_t rangeOffset = size - rangeLength;
+        std::vector<unsigned char> range;
+        measure(corpus, size, "decompress last 64K", repeats, nothing,
+                [&]() {
+                    return TableDecompressor::decompressRange(compressedFile, rangeOffset, rangeLength, range, "", "",
+                                                              false, "", decompressOptions);
+                },
+                [&]() {
+                    return range.size() == rangeLength &&
+                           std::equal(range.begin(), range.end(), original.begin() + rangeOffset);
+                });
+
+        // 9. 使用共享字典（由语料本身训练）的压缩与解压：跳过频率统计与建树，文件头只记录字典 ID，
+        //    解码器在第一次解压后缓存（小文件时差别最明显）
+        std::string dictionaryFile = (dir / (name + ".hfd")).string();
+        compressOptions.dictionaryFile = dictionaryFile;
+        bool trained = Compressor::trainDictionary({inputFile}, compressOptions);
+        measure(corpus, size, "compressFile dictionary", repeats, nothing, [&]() {
+            return trained && Compressor::compressFile(inputFile, "", "", false, "", compressOptions);
+        });
+        compressOptions.dictionaryFile.clear();
+        std::uintmax_t dictionarySize = fs::file_size(compressedFile);
+        decompressOptions.dictionaryFile = dictionaryFile;
+        measure(corpus, size, "decompress dictionary", repeats, [&]() { fs::remove(outputFile); },
+                [&]() { return TableDecompressor::decompressFile(compressedFile, "", "", false, "", decompressOptions); },
+                [&]() { return fileContent(outputFile) == original; });
+        decompressOptions.dictionaryFile.clear();
+        fs::remove(dictionaryFile);
+        std::cout << std::left << std::setw(12) << corpus << std::right << std::setw(6) << sizeName(size)
+                  << "  compressed size: order-0 " << order0Size << " bytes, order-1 " << order1Size
+                  << " bytes, adaptive " << adaptiveSize << " bytes" << lzSizes << ", bwt " << bwtSize << " bytes"
+                  << ", dictionary " << dictionarySize << " bytes" << std::endl;
+        fs::remove(inputFile);
+        fs::remove(compressedFile);
+        fs::remove(outputFile);
+        (void)hash;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> sizes = {"1K", "64K", "1M", "16M"};
+    std::vector<std::string> corpora = {"uniform", "text", "skewed", "repetitive", "mixed"};
+    int repeats = 3;
+    fs::path dir = fs::temp_directory_path() / "huffman_benchmark";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::cout << USAGE;
+            return 0;
+        }
+        if (arg != "--sizes" && arg != "--corpus" && arg != "--repeats" && arg != "--dir") {
+            std::cerr << "Unknown option: " << arg << std::endl << USAGE;
+            return 2;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl << USAGE;
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--sizes") {
+            sizes = split(value);
+        } else if (arg == "--corpus") {
+            corpora = split(value);
+        } else if (arg == "--repeats") {
+            char *end = nullptr;
+            long number = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || number < 1 || number > 1000000) {
+                std::cerr << "Invalid option: " << arg << " " << value << std::endl << USAGE;
+                return 2;
+            }
+            repeats = static_cast<int>(number);
+        } else {
+            dir = value;
+        }
+    }
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Error creating directory: " << dir << std::endl;
+        return 1;
+    }
+
+    std::cout << "Compression benchmark: best of " << repeats << ", files in " << dir.string() << std::endl;
+    std::cout << "Peak RSS is the process high-water mark during each measurement (includes the corpus)" << std::endl;
+    std::vector<unsigned char> data;
+    for (const std::string &sizeText : sizes) {
+        std::size_t size = parseSize(sizeText);
+        if (size == 0) {
+            std::cerr << "Invalid size: " << sizeText << std::endl;
+            return 1;
+        }
+        for (const std::string &corpus : corpora) {
+            if (!generateCorpus(corpus, size, data)) {
+                std::cerr << "Unknown corpus: " << corpus << std::endl;
+                return 1;
+            }
+            runCorpus(corpus, data, dir, size >= (std::size_t(256) << 20) ? 1 : repeats);
+        }
+    }
+    return 0;
+}
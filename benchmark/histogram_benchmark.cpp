@@ -0,0 +1,92 @@
+#include "common.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// 字节频率统计微基准：比较逐字节计数与 Common::countBytes（单线程 / 多线程）的吞吐量
+// 用法: HistogramBenchmark [数据大小(MB)，默认 256] [重复次数，默认 5]
+
+namespace {
+    // 函数: countNaive
+    // 用途: 逐字节累加到同一张直方图（对照组）
+    void countNaive(const unsigned char *data, std::size_t size, std::vector<uint64_t> &freq) {
+        for (std::size_t i = 0; i < size; i++) {
+            freq[data[i]]++;
+        }
+    }
+
+    // 函数: measure
+    // 用途: 重复运行 count 若干次，返回最快一次的吞吐量（GB/s），并检查结果与 expected 一致
+    template<typename Count>
+    double measure(const std::vector<unsigned char> &data, int repeats, const std::vector<uint64_t> &expected,
+                   Count count, bool &matched) {
+        double best = 0;
+        matched = true;
+        for (int r = 0; r < repeats; r++) {
+            std::vector<uint64_t> freq(256, 0);
+            auto start = std::chrono::steady_clock::now();
+            count(data.data(), data.size(), freq);
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            best = std::max(best, data.size() / seconds / 1e9);
+            matched = matched && (expected.empty() || freq == expected);
+        }
+        return best;
+    }
+
+    // 函数: runCase
+    // 用途: 对一组输入数据运行全部统计方式并输出结果
+    void runCase(const std::string &name, const std::vector<unsigned char> &data, int repeats) {
+        std::vector<uint64_t> expected(256, 0);
+        countNaive(data.data(), data.size(), expected);
+
+        bool matched = false;
+        std::cout << std::left << std::setw(10) << name << std::fixed << std::setprecision(2);
+        double naive = measure(data, repeats, {}, countNaive, matched);
+        std::cout << "  naive " << std::setw(6) << naive << " GB/s";
+        double single = measure(data, repeats, expected,
+            [](const unsigned char *p, std::size_t n, std::vector<uint64_t> &f) { Common::countBytes(p, n, f, 1); },
+            matched);
+        std::cout << "  countBytes " << std::setw(6) << single << " GB/s" << (matched ? "" : " (MISMATCH)");
+        double threaded = measure(data, repeats, expected,
+            [](const unsigned char *p, std::size_t n, std::vector<uint64_t> &f) { Common::countBytes(p, n, f, 0); },
+            matched);
+        std::cout << "  countBytes x" << ThreadPool::resolveThreads(0) << " " << std::setw(6) << threaded << " GB/s"
+                  << (matched ? "" : " (MISMATCH)") << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::size_t size = megabytes << 20;
+    std::vector<unsigned char> data(size);
+
+    std::cout << "Histogram benchmark: " << megabytes << " MB, best of " << repeats << std::endl;
+
+    // 均匀分布：随机字节
+    std::mt19937_64 rng(12345);
+    for (std::size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t word = rng();
+        for (int k = 0; k < 8; k++) {
+            data[i + k] = static_cast<unsigned char>(word >> (8 * k));
+        }
+    }
+    runCase("uniform", data, repeats);
+
+    // 高度倾斜：约 95% 为同一字节
+    for (std::size_t i = 0; i < size; i++) {
+        data[i] = (rng() % 20 == 0) ? static_cast<unsigned char>(rng()) : 'e';
+    }
+    runCase("skewed", data, repeats);
+
+    // 极端情况：全部为同一字节
+    std::fill(data.begin(), data.end(), 0);
+    runCase("constant", data, repeats);
+    return 0;
+}
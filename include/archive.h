@@ -0,0 +1,108 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "compressor.h"
+#include "decompressor.h"
+
+// 多文件归档（HFMA）：将多个压缩文件作为成员依次存放在一个文件中，末尾为中央目录与定长的目录尾：
+//
+//   成员 0、成员 1、……  各成员为完整的压缩文件（HFMZ 格式，见 format.h），码表位于各自的文件头中
+//   中央目录            每个成员一项：
+//     2     成员名称字节数 n
+//     n     成员名称（添加时的相对路径，以 '/' 分隔）
+//     8     成员在归档中的偏移
+//     8     成员字节数
+//     8     原始数据字节数
+//     4     原始数据的 CRC32C（与成员文件头中记录的校验和相同，分块模式下为各块校验和的合并）
+//     2     成员文件头的标志位（压缩模式与加密方式）
+//     4     成员文件头字节数（码表所在的部分，编码数据自此开始）
+//   目录尾（32 字节）
+//     4     魔数 "HFMA"
+//     2     版本号
+//     2     保留（为 0）
+//     4     成员个数
+//     4     中央目录的 CRC32C
+//     8     中央目录在归档中的偏移
+//     8     中央目录字节数
+//
+// 列出成员只需读取目录尾与中央目录，提取一个成员时按目录中的偏移直接定位，不读取其他成员；
+// 追加成员时先将全部新成员压缩为临时文件（压缩失败时不修改归档），再写到归档末尾，最后写出新的中央目录与目录尾；
+// 原中央目录与目录尾不被覆盖（留在归档中不再使用），写出出错时截断回原长度即恢复原归档
+namespace Archive {
+    constexpr uint16_t VERSION = 1;
+    constexpr std::size_t TRAILER_SIZE = 32;
+
+    // 中央目录的一项
+    struct Entry {
+        std::string name;            // 成员名称（解压时相对于输出目录的路径）
+        uint64_t offset = 0;         // 成员在归档中的偏移
+        uint64_t compressedSize = 0; // 成员字节数
+        uint64_t originalLength = 0; // 原始数据字节数
+        uint32_t checksum = 0;       // 原始数据的 CRC32C
+        uint16_t flags = 0;          // 成员文件头的标志位
+        uint32_t headerSize = 0;     // 成员文件头字节数
+    };
+
+    // 添加到归档的一个文件及其参数
+    struct Input {
+        std::string path;         // 文件路径
+        std::string name;         // 成员名称
+        std::string senderInfo;   // 发送者信息
+        std::string receiverInfo; // 接收者信息
+        bool encrypt = false;     // 是否加密
+        std::string key;          // 密钥，为空时使用偏移量加密
+    };
+
+    // 类: Directory
+    // 用途: 归档的中央目录，按名称查找成员为 O(1)
+    class Directory {
+    public:
+        // 读取归档的中央目录（只读取目录尾与中央目录）
+        bool load(const std::string &archiveFile);
+
+        const std::vector<Entry> &entries() const { return list; }
+
+        // 按名称查找成员，不存在时返回空
+        const Entry *find(const std::string &name) const;
+
+        // 加入一项（名称已存在时返回 false）
+        bool add(const Entry &entry);
+
+        // 中央目录的偏移，各成员都位于其前（新归档为 0）
+        uint64_t dataEnd() const { return directoryOffset; }
+
+        // 序列化中央目录与目录尾，offset 为中央目录将要写入的偏移
+        std::vector<unsigned char> serialize(uint64_t offset) const;
+
+    private:
+        std::vector<Entry> list;
+        std::unordered_map<std::string, std::size_t> index;
+        uint64_t directoryOffset = 0;
+    };
+
+    // 函数: validName
+    // 用途: 成员名称是否合法：非空的相对路径，不含 "." 或 ".." 路径段，解压时不会写到输出目录之外
+    bool validName(const std::string &name);
+
+    // 函数: append
+    // 用途: 压缩各文件并追加到归档（归档不存在时创建），成员名称不能与已有成员重复
+    //
+    // 参数:
+    //    archiveFile - 归档文件路径
+    //    inputs      - 待添加的文件及其参数
+    //    options     - 压缩选项（outputDir、outputFile 不使用）
+    bool append(const std::string &archiveFile, const std::vector<Input> &inputs, const Compressor::Options &options);
+
+    // 函数: extract
+    // 用途: 定位并解压归档中的一个成员，输出到 options.outputFile，为空时为 输出目录/成员名称
+    bool extract(const std::string &archiveFile, const Directory &directory, const std::string &name,
+                 const std::string &senderInfo, const std::string &receiverInfo, bool decrypt, const std::string &key,
+                 const Decompressor::Options &options);
+}
+
+#endif // ARCHIVE_H
@@ -0,0 +1,97 @@
+#ifndef BWT_H
+#define BWT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// BWT 变换（与 bzip2 相同的流程）：对每块做 Burrows–Wheeler 变换，再做前移（move-to-front）变换
+// 与零游程编码，得到的符号流以一张哈夫曼码表编码。符号划分：
+//   0 (RUNA)、1 (RUNB) - 零游程长度的双射二进制表示（低位在前，RUNA 为 1、RUNB 为 2）
+//   2~256              - 前移变换的非零下标 1~255（下标 + 1）
+namespace BWT {
+    constexpr unsigned RUN_A = 0;
+    constexpr unsigned RUN_B = 1;
+    constexpr unsigned SYMBOLS = 257; // 符号个数
+
+    // 单块的最大字节数（后缀数组使用 32 位下标）
+    constexpr std::size_t MAX_BLOCK_SIZE = std::size_t(1) << 30;
+
+    // 函数: suffixArray
+    // 用途: 以 SA-IS 算法在线性时间内构造后缀数组
+    //
+    // 参数:
+    //    data - 数据
+    //    size - 字节数（不超过 MAX_BLOCK_SIZE）
+    //    sa   - 输出：size 个后缀起始位置，按后缀的字典序排列
+    void suffixArray(const unsigned char *data, std::size_t size, std::vector<int32_t> &sa);
+
+    // 函数: transform
+    // 用途: Burrows–Wheeler 变换。在数据末尾假想一个小于所有字节的结束符，
+    //       将全部循环移位按字典序排列后取各行的最后一个字节（不含结束符所在的行）
+    //
+    // 参数:
+    //    data - 数据
+    //    size - 字节数（1 ~ MAX_BLOCK_SIZE）
+    //    out  - 输出：size 个字节
+    //
+    // 返回:
+    //    主行号：以原数据开头的那一行（最后一个字节为结束符）在全部 size + 1 行中的行号（1 ~ size）
+    uint32_t transform(const unsigned char *data, std::size_t size, unsigned char *out);
+
+    // 函数: inverse
+    // 用途: BWT 逆变换，由各行最后一个字节与主行号还原原数据
+    //
+    // 返回:
+    //    主行号不在 1 ~ size 范围内时返回 false
+    bool inverse(const unsigned char *bwt, std::size_t size, uint32_t primary, unsigned char *out);
+
+    // 函数: encodeSymbols
+    // 用途: 对 BWT 输出做前移变换与零游程编码，symbols 返回符号流
+    void encodeSymbols(const unsigned char *bwt, std::size_t size, std::vector<uint16_t> &symbols);
+
+    // 类: SymbolDecoder
+    // 用途: 逐个接收符号流中的符号，还原前移变换与零游程编码之前的 BWT 输出
+    class SymbolDecoder {
+    public:
+        SymbolDecoder(unsigned char *out, std::size_t size);
+
+        // 接收一个符号，符号无效或输出超出 size 字节时返回 false
+        inline bool put(unsigned symbol) {
+            if (symbol <= RUN_B) {
+                run += weight << symbol;
+                weight <<= 1;
+                return run <= size - pos;
+            }
+            if (symbol >= SYMBOLS || !flushRun() || pos >= size) {
+                return false;
+            }
+            unsigned index = symbol - 1;
+            unsigned char byte = order[index];
+            for (unsigned i = index; i > 0; i--) {
+                order[i] = order[i - 1];
+            }
+            order[0] = byte;
+            out[pos++] = byte;
+            return true;
+        }
+
+        // 已还原的字节数（含尚未写出的零游程）
+        std::size_t produced() const { return pos + static_cast<std::size_t>(run); }
+
+        // 写出末尾的零游程，恰好还原 size 个字节时返回 true
+        bool finish() { return flushRun() && pos == size; }
+
+    private:
+        unsigned char *out;
+        std::size_t size;
+        std::size_t pos = 0;
+        uint64_t run = 0;    // 当前零游程的长度
+        uint64_t weight = 1; // 下一个游程符号的权重
+        unsigned char order[256];
+
+        bool flushRun();
+    };
+}
+
+#endif // BWT_H
@@ -0,0 +1,72 @@
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ChaCha20 流密码（Bernstein 原始版本：64 位块计数器与 64 位随机数；RFC 8439 的 32 位计数器、96 位随机数版本
+// 在其随机数前 4 字节为 0 时与之相同）。数据流第 offset 字节使用第 offset / 64 个密钥流块的第 offset % 64 字节，
+// 任一位置的密钥流都可直接算出，因此各块、各段可以独立且并行地加密与解密。
+// 密钥流按 4 块（SSE2）或 8 块（AVX2）一组并行生成，运行时按 CPU 支持的指令集选择实现，
+// 其他平台使用逐块计算的标量实现；各实现的结果完全相同
+namespace ChaCha20 {
+    constexpr std::size_t KEY_SIZE = 32;   // 密钥字节数
+    constexpr std::size_t BLOCK_SIZE = 64; // 密钥流块字节数
+    constexpr uint32_t KDF_ITERATIONS = 100000; // 派生密钥时 PBKDF2 的默认迭代次数
+
+    using Key = std::array<uint8_t, KEY_SIZE>;
+
+    // 密钥流的实现方式
+    enum class Implementation {
+        SCALAR, // 逐块计算
+        SSE2,   // 每次并行计算 4 块
+        AVX2    // 每次并行计算 8 块
+    };
+
+    // 函数: supported
+    // 用途: 当前 CPU 是否支持该实现（SCALAR 总是支持）
+    bool supported(Implementation implementation);
+
+    // 函数: detect
+    // 用途: 当前 CPU 支持的最快实现
+    Implementation detect();
+
+    // 函数: implementationName
+    // 用途: 实现方式的名称（scalar、sse2、avx2）
+    const char *implementationName(Implementation implementation);
+
+    // 函数: deriveKey
+    // 用途: 以 PBKDF2-HMAC-SHA256 由口令派生 256 位密钥
+    //
+    // 参数:
+    //    passphrase - 口令
+    //    salt       - 随机盐
+    //    saltSize   - 随机盐的字节数
+    //    iterations - 迭代次数（至少为 1）
+    Key deriveKey(const std::string &passphrase, const uint8_t *salt, std::size_t saltSize, uint32_t iterations);
+
+    // 函数: cachedKey
+    // 用途: 同 deriveKey，但在进程内按（口令、随机盐、迭代次数）缓存最近使用的若干个密钥，
+    //       同一批文件共用随机盐时只派生一次；可在多个线程中同时调用
+    Key cachedKey(const std::string &passphrase, const uint8_t *salt, std::size_t saltSize, uint32_t iterations);
+
+    // 类: Stream
+    // 用途: 由密钥与随机数确定的密钥流，可自任一位置起与数据异或（加密与解密相同）
+    class Stream {
+    public:
+        Stream(const Key &key, uint64_t nonce, Implementation implementation = detect());
+
+        // 将 data 与数据流第 offset 字节起的密钥流异或
+        void apply(unsigned char *data, std::size_t size, uint64_t offset) const;
+
+        Implementation implementation() const { return impl; }
+
+    private:
+        std::array<uint32_t, 16> state; // 初始状态，第 12、13 字（块计数器）在生成时填入
+        Implementation impl;
+    };
+}
+
+#endif // CHACHA20_H
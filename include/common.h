@@ -8,43 +8,32 @@
 #include <algorithm>
 #include <sstream>
 #include <cstdint>
+#include <optional>
 #include <stdexcept>
+#include "chacha20.h"
+#include "crc32c.h"
 
-namespace {
-    // FNV-1a 64位哈希初始值与质数因子定义
-    constexpr uint64_t FNV1A_64_INIT = 0xcbf29ce484222325ULL;
-    constexpr uint64_t FNV1A_64_PRIME = 0x100000001b3ULL;
-
-    // 模板函数: fnv1a_64
-    // 用途: 计算数据的 FNV-1a 64 位哈希值
-    // 参数:
-    //    data - 可迭代数据（例如 vector 或字符串）
-    // 返回:
-    //    计算得到的 64 位哈希值
-    template<typename T>
-    inline uint64_t fnv1a_64(const T &data) {
-        uint64_t hash = FNV1A_64_INIT;
-        for (unsigned char byte : data) {
-            hash ^= byte;
-            hash *= FNV1A_64_PRIME;
+namespace Common {
+    // 函数: hashToString
+    // 用途: 将校验和格式化为 8 位16进制字符串
+    inline std::string hashToString(uint32_t hashValue) {
+        static const char digits[] = "0123456789abcdef";
+        std::string text(8, '0');
+        for (int i = 7; i >= 0; i--, hashValue >>= 4) {
+            text[i] = digits[hashValue & 0xF];
         }
-        return hash;
+        return text;
     }
-}
 
-namespace Common {
     // 模板函数: calculateHash
-    // 用途: 计算数据的哈希值，并返回其16进制字符串格式表示
+    // 用途: 计算数据的校验和（CRC32C），并返回其16进制字符串格式表示
     // 参数:
-    //    data - 任意支持迭代的数据容器
+    //    data - 连续存储的字节容器（例如 vector 或字符串）
     // 返回:
-    //    16进制字符串表示的哈希值
+    //    16进制字符串表示的校验和
     template<typename T>
     inline std::string calculateHash(const T &data) {
-        uint64_t hashValue = fnv1a_64(data);
-        std::stringstream ss;
-        ss << std::hex << hashValue;
-        return ss.str();
+        return hashToString(CRC32C::update(0, reinterpret_cast<const unsigned char *>(data.data()), data.size()));
     }
 
     // 堆排序: heapify 函数
@@ -192,9 +181,81 @@ namespace Common {
     // 声明解密处理函数
     void decrypt(std::vector<unsigned char> &data, const std::string &key);
 
+    // 分块加密：offset 为该块在整个数据流中的起始位置，用于确定密钥的起始下标
+    void encrypt(unsigned char *data, std::size_t size, const std::string &key, uint64_t offset);
+
+    // 分块解密：offset 含义与分块加密相同
+    void decrypt(unsigned char *data, std::size_t size, const std::string &key, uint64_t offset);
+
+    // 类: Cipher
+    // 用途: 分块加密与解密（与上面的 encrypt、decrypt 结果相同）。密钥为空时为偏移量加密，否则为异或加密：
+    //       构造时将密钥重复展开为周期是 8 的倍数的密钥流，按 64 位字异或，不再逐字节对密钥长度取模。
+    //       也可使用 ChaCha20 加密（见 chacha20.h），密钥流同样由数据流中的位置确定。
+    //       需要对同一数据流的多个小段反复加密时应复用同一对象
+    class Cipher {
+    public:
+        explicit Cipher(const std::string &key);
+
+        // ChaCha20 加密：以 PBKDF2 由口令与随机盐派生密钥（随机盐相同的各文件共用，见 ChaCha20::cachedKey），
+        // nonce 为每个文件各不相同的随机数
+        Cipher(const std::string &passphrase, const uint8_t *salt, std::size_t saltSize, uint32_t iterations,
+               uint64_t nonce);
+
+        // offset 为 data 在整个数据流中的起始位置，用于确定密钥的起始下标；
+        // threads 不为 1 且数据足够大时切分为多段并行处理（含义与 countBytes 相同）
+        void encrypt(unsigned char *data, std::size_t size, uint64_t offset, unsigned threads = 1) const;
+        void decrypt(unsigned char *data, std::size_t size, uint64_t offset, unsigned threads = 1) const;
+
+    private:
+        std::size_t keySize;
+        std::size_t period;                // 密钥流周期：密钥长度与 8 的公倍数
+        std::vector<unsigned char> stream; // 密钥流：自任一起始下标（0 ~ keySize - 1）起都可连续读出一个周期
+        std::optional<ChaCha20::Stream> chacha; // ChaCha20 加密时的密钥流
+
+        void applyKey(unsigned char *data, std::size_t size, uint64_t offset) const;
+        void crypt(unsigned char *data, std::size_t size, uint64_t offset, bool inverse) const;
+        void cryptParallel(unsigned char *data, std::size_t size, uint64_t offset, bool inverse, unsigned threads) const;
+    };
+
+    // 融合的压缩前处理：按可常驻缓存的小段依次计算原始数据的校验和（checksum 不为空时，CRC32C）、
+    // 加密（cipher 不为空时）并统计字节频率，结果累加到 freq，整个数据只读写一遍；offset 为 data 在数据流中的位置；
+    // threads 含义与 countBytes 相同（并行时各段的校验和按顺序合并）
+    void encryptAndCount(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                         uint32_t *checksum, std::vector<uint64_t> &freq, unsigned threads = 1);
+
+    // 融合的压缩前处理（一阶频率）：与 encryptAndCount 相同，但统计的是一阶频率，
+    // previous、resetInterval 含义与 countPairs 相同（previous 为加密后的字节）
+    void encryptAndCountPairs(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                              uint32_t *checksum, unsigned char &previous, uint64_t resetInterval,
+                              std::vector<uint64_t> &freq, unsigned threads = 1);
+
+    // 融合的压缩前处理（不统计频率，如使用共享字典时）：按小段依次计算原始数据的校验和（checksum 不为空时）
+    // 并加密（cipher 不为空时），与 decryptAndChecksum 互逆
+    void checksumAndEncrypt(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                            uint32_t *checksum);
+
+    // 融合的解压后处理：按小段依次解密（cipher 不为空时）并计算解密后数据的校验和（checksum 不为空时），
+    // 解码得到的数据只需再读写一遍
+    void decryptAndChecksum(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                            uint32_t *checksum);
+
+    // 统计字节频率：将 data 中各字节值的出现次数累加到 freq（256 项，64 位计数）。
+    // 使用多张交错的子直方图打断相邻字节写同一计数器造成的依赖；
+    // threads 不为 1 且数据足够大时切分为多段并行统计后归并（0 表示硬件并发线程数）
+    void countBytes(const unsigned char *data, std::size_t size, std::vector<uint64_t> &freq, unsigned threads = 1);
+
+    // 统计一阶频率：将各（前一字节, 字节）的出现次数累加到 freq（65536 项，下标为 前一字节 * 256 + 字节）。
+    // previous 为 data[0] 之前的字节，返回时更新为 data 的最后一个字节；offset 为 data 在数据流中的位置，
+    // resetInterval 不为 0 时位于其整数倍处的字节以 0 为上下文；threads 含义与 countBytes 相同
+    void countPairs(const unsigned char *data, std::size_t size, unsigned char &previous, uint64_t offset,
+                    uint64_t resetInterval, std::vector<uint64_t> &freq, unsigned threads = 1);
+
     // 获取文件名（不包含扩展名），例如 "test/example.txt" 返回 "example"
     std::string extractFileName(const std::string &filename);
 
+    // 拼接目录与文件名，例如 ("test", "example.hfm") 返回 "test/example.hfm"
+    std::string joinPath(const std::string &directory, const std::string &fileName);
+
     // 将十六进制字符串转换为二进制字符串（"A3" 转为 "10100011"）
     std::string hexToBinary(const std::string &hex);
 
@@ -1,32 +1,102 @@
 #ifndef COMPRESSOR_H
 #define COMPRESSOR_H
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
+#include "lz77.h"
+#include "stats.h"
 
 namespace Compressor {
+    // 空子节点下标
+    constexpr uint16_t NO_CHILD = 0xFFFF;
+
+    // 哈夫曼树节点：子节点以 16 位下标引用同一 NodePool 中的节点
     struct Node {
-        unsigned char byteVal;
-        int freq;
-        Node *left, *right;
-
-        Node(unsigned char b, int f) : byteVal(b), freq(f), left(nullptr), right(nullptr) {}
-        // 节点合并
-        Node(Node *l, Node *r) : freq(l->freq + r->freq), left(l), right(r) {
-            byteVal = std::max(l->byteVal, r->byteVal);
+        uint64_t freq;
+        uint16_t left, right;
+        uint16_t symbol; // 叶子的符号值（字节值，或 LZ77 模式下的字面量/长度、距离符号）
+
+        bool isLeaf() const { return left == NO_CHILD; }
+    };
+
+    // 类: NodePool
+    // 用途: 连续存放一棵哈夫曼树的全部节点（256 种字节至多 511 个节点，LZ77 的 286 种字面量/长度符号至多 571 个），
+    //       节点不单独申请内存，整棵树随 NodePool 一次释放
+    class NodePool {
+    public:
+        static constexpr std::size_t CAPACITY = 2 * LZ77::LITLEN_SYMBOLS - 1;
+
+        // 新建叶子节点，返回其下标
+        uint16_t leaf(uint16_t s, uint64_t f) {
+            nodes[count] = Node{f, NO_CHILD, NO_CHILD, s};
+            return static_cast<uint16_t>(count++);
+        }
+
+        // 节点合并：新建以 l、r 为子节点的内部节点，返回其下标
+        uint16_t merge(uint16_t l, uint16_t r) {
+            nodes[count] = Node{nodes[l].freq + nodes[r].freq, l, r, std::max(nodes[l].symbol, nodes[r].symbol)};
+            return static_cast<uint16_t>(count++);
         }
+
+        Node &operator[](uint16_t index) { return nodes[index]; }
+        const Node &operator[](uint16_t index) const { return nodes[index]; }
+
+        std::size_t size() const { return count; }
+
+    private:
+        std::array<Node, CAPACITY> nodes;
+        std::size_t count = 0;
+    };
+
+    // 压缩选项
+    struct Options {
+        bool streaming = false;           // 流式压缩：分块读取与编码，内存占用与文件大小无关
+        std::size_t bufferSize = 1 << 20; // 流式压缩时每次读写的缓冲区字节数
+        std::size_t blockSize = 0;        // 分块模式的块大小（如 1~4 MB），0 表示不分块；自适应分块时为块的最大字节数（0 表示 4 MB）
+        bool adaptiveBlocks = false;      // 自适应分块：在字节分布变化处切分块，节省的位数超过一张码表时才开始新块
+        unsigned threads = 0;             // 分块压缩与频率统计的工作线程数，0 表示硬件并发线程数
+        std::size_t syncInterval = 0;     // 单一码表模式下每隔多少个原始字节记录一个同步点（供并行解码），0 表示不记录
+        unsigned maxCodeLength = 0;       // 最长编码长度（如 11、12、15），0 表示不限制；超出时使用包合并算法构造限长编码
+        bool contextModel = false;        // 一阶上下文模式：以前一字节为上下文选择码表，稀疏上下文合并为后备表
+        LZ77::Level lzLevel = LZ77::Level::NONE; // LZ77 前端的匹配查找策略，NONE 表示不使用；使用时总是分块压缩
+        bool bwt = false;                 // BWT 变换：各块经 BWT、前移变换与零游程编码后再做哈夫曼编码；总是分块压缩
+        bool chacha20 = false;            // 加密时使用 ChaCha20（key 为口令，不能为空），否则为偏移量或异或加密
+        std::string dictionaryFile;       // 共享字典文件（见 dictionary.h）：使用其中的码表，不统计频率，文件头只记录字典 ID；
+                                          // 只用于单一码表模式，训练字典时为输出文件
+        std::string outputDir = "test/";  // 压缩文件的输出目录
+        std::string outputFile;           // 压缩文件的路径，为空时为 outputDir/原文件名.hfm
+        Verbosity verbosity = Verbosity::SUMMARY; // 控制台输出的详细程度，DEBUG 时显示词频统计表、WPL 等
+        std::string statsFile;            // 各阶段耗时与统计指标的输出目标：空表示不收集，"-" 表示标准错误，否则追加到文件
+        Stats::Format statsFormat = Stats::JSON; // 统计信息的输出格式
     };
+
     /*
         inputFile 待压缩文件名
         senderInfo 发送人信息
         receiverInfo 接收人信息
         encrypt 是否加密
+        key 加密密钥
+        options 压缩选项
+        返回 是否压缩成功
     */
-    void compressFile(const std::string &inputFile,
+    bool compressFile(const std::string &inputFile,
                       const std::string &senderInfo,
                       const std::string &receiverInfo,
                       bool encrypt,
-                      const std::string &key);
+                      const std::string &key,
+                      const Options &options = Options());
+
+    /*
+        sampleFiles 样本文件（如大量同类的小文件）
+        options 训练选项：dictionaryFile 为输出的字典文件，contextModel 时训练一阶上下文码表，
+                maxCodeLength 限制最长编码长度，verbosity 控制输出
+        返回 是否训练成功
+    */
+    bool trainDictionary(const std::vector<std::string> &sampleFiles, const Options &options);
 }
 
 #endif // COMPRESSOR_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC32C 校验和（Castagnoli 多项式 0x1EDC6F41，与 iSCSI、ext4 等使用的相同）。
+// 支持 SSE4.2 的 CPU 上使用 crc32 指令每次处理 8 个字节，其他情况使用查表的 slicing-by-8 实现；
+// 各实现的结果完全相同。校验和可增量计算，分段并行计算的结果也可由 combine 按顺序合并
+namespace CRC32C {
+    // 校验和的实现方式
+    enum class Implementation {
+        SLICING_BY_8, // 查表，每次处理 8 个字节
+        SSE42         // crc32 指令，每次处理 8 个字节
+    };
+
+    // 函数: supported
+    // 用途: 当前 CPU 是否支持该实现（SLICING_BY_8 总是支持）
+    bool supported(Implementation implementation);
+
+    // 函数: detect
+    // 用途: 当前 CPU 支持的最快实现
+    Implementation detect();
+
+    // 函数: implementationName
+    // 用途: 实现方式的名称（slicing-by-8、sse4.2）
+    const char *implementationName(Implementation implementation);
+
+    // 函数: update
+    // 用途: 增量计算校验和
+    //
+    // 参数:
+    //    crc  - 此前各段的校验和（首段传入 0）
+    //    data - 当前段起始地址
+    //    size - 当前段字节数
+    //
+    // 返回:
+    //    累加当前段后的校验和
+    uint32_t update(uint32_t crc, const unsigned char *data, std::size_t size);
+
+    // 以指定的实现计算（用于基准测试与校验各实现的一致性）
+    uint32_t update(uint32_t crc, const unsigned char *data, std::size_t size, Implementation implementation);
+
+    // 函数: combine
+    // 用途: 由相邻两段各自的校验和得到两段拼接后的校验和（耗时与 secondSize 的位数成正比，与数据无关）
+    //
+    // 参数:
+    //    first      - 前一段的校验和
+    //    second     - 后一段（自 0 起计算）的校验和
+    //    secondSize - 后一段的字节数
+    uint32_t combine(uint32_t first, uint32_t second, uint64_t secondSize);
+}
+
+#endif // CRC32C_H
@@ -1,22 +1,116 @@
 #ifndef DECOMPRESSOR_H
 #define DECOMPRESSOR_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "stats.h"
 
+namespace Decompressor {
+    // 解压选项（三种解码方式通用）
+    struct Options {
+        bool streaming = false;           // 流式解压：固定大小的缓冲区逐块读取、解码与写出
+        std::size_t bufferSize = 1 << 20; // 流式解压时输入、输出缓冲区的字节数
+        unsigned threads = 1;             // 并行解码的线程数（分块模式下各块并行），0 表示硬件并发线程数
+        std::string outputDir = "test/";  // 解压文件的输出目录
+        std::string outputFile;           // 解压文件的路径，为空时为 outputDir/原文件名_j.txt
+        std::string dictionaryFile;       // 共享字典文件（见 dictionary.h），解压引用字典的文件时须提供；
+                                          // 由字典构建的解码器按字典 ID 在进程内缓存，字典文件未修改时各次解压共用
+        Verbosity verbosity = Verbosity::SUMMARY; // 控制台输出的详细程度：SUMMARY 时显示收发人信息、HASH 值、耗时等
+        std::string statsFile;            // 各阶段耗时与统计指标的输出目标：空表示不收集，"-" 表示标准错误，否则追加到文件
+        Stats::Format statsFormat = Stats::JSON; // 统计信息的输出格式
+    };
+}
+
+// 各解压函数成功时返回 true，出错时（错误信息已输出到标准错误）返回 false。
+// decompressRange 只解压原始数据中 [offset, offset + length) 的部分（超出末尾的部分截去）到 out，不写出文件：
+// 分块模式下只解码覆盖该范围的块，单一码表模式下从该范围之前最近的同步点开始解码，
+// 耗时与范围大小成正比（单一码表模式下未记录同步点时须从头解码）
+// decompressMember 只解压文件中自 memberOffset 起的 memberSize 个字节（归档中的一个成员，见 archive.h）
 namespace TrieDecompressor {
-    void decompressFile(const std::string &inputFile,
+    bool decompressFile(const std::string &inputFile,
                         const std::string &senderInfo,
                         const std::string &receiverInfo,
                         bool encrypt,
-                        const std::string &key);
+                        const std::string &key,
+                        const Decompressor::Options &options = Decompressor::Options());
+
+    bool decompressRange(const std::string &inputFile,
+                         uint64_t offset,
+                         uint64_t length,
+                         std::vector<unsigned char> &out,
+                         const std::string &senderInfo,
+                         const std::string &receiverInfo,
+                         bool encrypt,
+                         const std::string &key,
+                         const Decompressor::Options &options = Decompressor::Options());
+
+    bool decompressMember(const std::string &inputFile,
+                          uint64_t memberOffset,
+                          uint64_t memberSize,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool encrypt,
+                          const std::string &key,
+                          const Decompressor::Options &options = Decompressor::Options());
 }
 
 namespace HashDecompressor {
-    void decompressFile(const std::string &inputFile,
+    bool decompressFile(const std::string &inputFile,
                         const std::string &senderInfo,
                         const std::string &receiverInfo,
                         bool encrypt,
-                        const std::string &key);
+                        const std::string &key,
+                        const Decompressor::Options &options = Decompressor::Options());
+
+    bool decompressRange(const std::string &inputFile,
+                         uint64_t offset,
+                         uint64_t length,
+                         std::vector<unsigned char> &out,
+                         const std::string &senderInfo,
+                         const std::string &receiverInfo,
+                         bool encrypt,
+                         const std::string &key,
+                         const Decompressor::Options &options = Decompressor::Options());
+
+    bool decompressMember(const std::string &inputFile,
+                          uint64_t memberOffset,
+                          uint64_t memberSize,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool encrypt,
+                          const std::string &key,
+                          const Decompressor::Options &options = Decompressor::Options());
+}
+
+// 多位查表解码：以接下来若干位为下标一次查出一个完整符号
+namespace TableDecompressor {
+    bool decompressFile(const std::string &inputFile,
+                        const std::string &senderInfo,
+                        const std::string &receiverInfo,
+                        bool encrypt,
+                        const std::string &key,
+                        const Decompressor::Options &options = Decompressor::Options());
+
+    bool decompressRange(const std::string &inputFile,
+                         uint64_t offset,
+                         uint64_t length,
+                         std::vector<unsigned char> &out,
+                         const std::string &senderInfo,
+                         const std::string &receiverInfo,
+                         bool encrypt,
+                         const std::string &key,
+                         const Decompressor::Options &options = Decompressor::Options());
+
+    bool decompressMember(const std::string &inputFile,
+                          uint64_t memberOffset,
+                          uint64_t memberSize,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool encrypt,
+                          const std::string &key,
+                          const Decompressor::Options &options = Decompressor::Options());
 }
 
 #endif // DECOMPRESSOR_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "format.h"
+
+// 共享字典（HFMD）：由样本数据预先训练的码表，供大量小文件共用。
+// 压缩时使用字典中的码表，不统计字节频率也不构建哈夫曼树，文件头中只记录 4 字节的字典 ID（见 format.h）；
+// 解压时须提供同一字典，由字典构建的解码器在进程内缓存，各次解压共用。
+// 字典文件格式（整数均为小端序）：
+//
+//   0     4     魔数 "HFMD"
+//   4     1     版本号
+//   5     1     保留（为 0）
+//   6     2     标志位：第 0 位为 1 表示一阶上下文码表，否则为单一码表
+//   8     4     字典 ID：其后码表部分的 CRC32C，相同的码表 ID 相同
+//   12          码表：单一码表为 256 个字节值的编码长度；上下文码表的格式与文件头中的相同（见 format.h）
+//
+// 每张码表为全部 256 个字节值都分配了编码（训练时未出现的字节值分配较长的编码），任意数据都可按字典编码
+namespace Dictionary {
+    constexpr unsigned char MAGIC[4] = {'H', 'F', 'M', 'D'};
+    constexpr uint8_t VERSION = 1;
+    constexpr uint16_t FLAG_CONTEXT = 0x0001;
+
+    // 字典内容
+    struct Tables {
+        uint32_t id = 0;                        // 字典 ID
+        bool contextual = false;                // 是否为一阶上下文码表
+        std::array<uint8_t, 256> codeLengths{}; // 单一码表的编码长度
+        Format::ContextTables contexts;         // 一阶上下文码表
+    };
+
+    // 函数: computeId
+    // 用途: 计算字典 ID，即码表部分的 CRC32C
+    uint32_t computeId(const Tables &tables);
+
+    // 函数: save
+    // 用途: 将字典写入文件（ID 由码表重新计算）
+    bool save(const std::string &path, const Tables &tables);
+
+    // 函数: load
+    // 用途: 读取并校验字典文件：魔数、版本号、ID 与码表一致，且每张码表为 256 个字节值都分配了合法的前缀码
+    bool load(const std::string &path, Tables &tables);
+
+    // 函数: open
+    // 用途: 读取字典文件并在进程内按路径缓存最近使用的若干个字典（文件的修改时间或大小变化后重新读取），
+    //       失败时返回空；可在多个线程中同时调用
+    std::shared_ptr<const Tables> open(const std::string &path);
+
+    // 函数: fillHeader
+    // 用途: 将字典的码表填入单一码表模式的文件头，并设置 FLAG_DICTIONARY（上下文码表同时设置 FLAG_CONTEXT）与字典 ID
+    void fillHeader(const Tables &tables, Format::Header &header);
+}
+
+#endif // DICTIONARY_H
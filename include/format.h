@@ -0,0 +1,187 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// .hfm 文件格式：文件开头为二进制文件头，紧随其后为哈夫曼编码后的数据（以下整数均为小端序）
+//
+//   偏移  长度  内容
+//   0     4     魔数 "HFMZ"
+//   4     1     格式版本号
+//   5     1     保留（为 0）
+//   6     2     标志位（见 Format::Flag）
+//   8     4     文件头总长度（即编码数据在文件中的起始偏移）
+//   12    8     原始数据字节长度
+//
+// 原始数据长度之后按以下顺序为可选字段，各模式的内容紧随其后（以下各模式的偏移均按没有可选字段时给出）：
+//
+// ChaCha20 加密（设置 FLAG_CHACHA20，须同时设置 FLAG_ENCRYPTED）时为密钥派生参数：
+//   8     随机盐：与口令经 PBKDF2 派生密钥；同一批压缩的文件共用，密钥只需派生一次
+//   8     随机数：ChaCha20 的 64 位随机数（小端序），每个文件各不相同，因此共用密钥的各文件密钥流互不相同
+//   4     PBKDF2 迭代次数
+// 偏移量加密与异或加密在编码前加密原始数据流；ChaCha20 加密的是编码后的数据（否则密文无法压缩），
+// 密钥流位置：单一码表模式为编码数据中的偏移，分块模式下每块数据为该块原始数据在数据流中的起始偏移
+// （块数据不超过块原始字节数，各块使用的密钥流互不重叠），各块可独立并行解密；
+// 原样存储的数据即原始数据流，两种方式相同
+//
+// 收发人信息（设置 FLAG_PARTIES）：解压时在解码之前校验，不属于数据流
+//   4     发送者信息字节数 s
+//   s     发送者信息
+//   4     接收者信息字节数 r
+//   r     接收者信息
+// 加密时两者依次按加密方式加密，密钥流位置自 PARTIES_STREAM_OFFSET 起（不与数据流共用密钥流）。
+// 未设置 FLAG_PARTIES 的文件（旧版本）中收发人信息以换行符结尾，位于数据流开头
+//
+// 校验和（设置 FLAG_CHECKSUM）：原始数据流（加密前）的 CRC32C（见 crc32c.h），解压时随解码校验。
+// 分块模式下记录在各块的块索引项中（各块独立校验，此处没有该字段）；其他模式下为整个数据流的校验和：
+//   4     CRC32C
+//
+// 单一码表模式（未设置 FLAG_BLOCKS）：
+//   20    256   各字节值的范式哈夫曼编码长度，其后的编码数据为一整段比特流
+//   若设置 FLAG_SYNC_POINTS，码表之后为同步点索引：
+//   276   8     同步点间隔（原始字节数）
+//   284   4     同步点个数 m
+//   288   16*m  同步点，每项依次为：比特流中的位偏移、对应的原始数据偏移，各 8 字节
+//   使用共享字典（设置 FLAG_DICTIONARY，见 dictionary.h）时码表不写入文件头，
+//   256 个编码长度（上下文模式下为上下文码表）改为 4 字节的字典 ID，其后各字段相应前移
+//
+// 分块模式（设置 FLAG_BLOCKS）：
+//   20    4     块数 n
+//   24    24*n  块索引，每项依次为：块数据偏移（相对编码数据起始处）、块数据字节数、块原始字节数，各 8 字节；
+//               设置 FLAG_CHECKSUM 时每项为 28 字节，其后为该块原始数据的 CRC32C（4 字节）
+//   每块数据为该块 256 个编码长度加上该块的比特流，各块相互独立；
+//   块数据字节数等于块原始字节数的块为原样存储（块数据即按需加密后的原始数据），
+//   编码后节省不明显的块（含以下各模式）均原样存储，因此编码的块总是小于原始字节数
+//
+// 一阶上下文模式（设置 FLAG_CONTEXT）：每个字节以前一字节为上下文选择码表编码，
+// 上述 256 个编码长度（单一码表模式的文件头中、分块模式的每块开头）改为上下文码表：
+//   32    上下文位图：第 c 位（第 c/8 字节的第 c%8 位）为 1 表示上下文 c 使用自己的码表，
+//         为 0 表示使用共用的后备表
+//   其后依次为后备表与各自有码表（按上下文递增），每张表为：
+//   32    符号位图：第 s 位为 1 表示字节值 s 有编码
+//   k     各有编码的字节值的编码长度，按字节值递增，各 1 字节
+//   数据流开头（以及单一码表模式下每个同步点处）的字节以 0 为上下文，使各段可独立解码
+//
+// LZ77 模式（设置 FLAG_LZ77，须同时为分块模式）：每块数据改为
+//   286   字面量/长度符号 0~285 的范式哈夫曼编码长度
+//   30    距离符号 0~29 的范式哈夫曼编码长度
+//   其后为该块字面量与匹配的比特流（符号划分与附加位见 lz77.h），匹配不跨越块边界
+//
+// BWT 模式（设置 FLAG_BWT，须同时为分块模式）：每块数据改为
+//   4     BWT 主行号
+//   257   BWT 输出经前移变换与零游程编码后各符号（见 bwt.h）的范式哈夫曼编码长度
+//   其后为该块符号流的比特流
+//
+// 原样存储（设置 FLAG_STORED，不与其他编码方式同时使用）：文件头在原始数据长度（及密钥派生参数）之后结束，
+//   编码数据即按需加密后的原始数据流（originalLength 字节）
+namespace Format {
+    constexpr unsigned char MAGIC[4] = {'H', 'F', 'M', 'Z'};
+    constexpr uint8_t VERSION = 1;
+    // 固定前导部分长度（魔数、版本、标志位与文件头总长度）
+    constexpr std::size_t PREAMBLE_SIZE = 12;
+    // ChaCha20 加密时随机盐的字节数
+    constexpr std::size_t SALT_SIZE = 8;
+    // 文件头中允许的最大 PBKDF2 迭代次数（防止损坏的文件头导致长时间的密钥派生）
+    constexpr uint32_t MAX_KDF_ITERATIONS = uint32_t(1) << 24;
+    // 加密收发人信息时的密钥流起始位置（远大于任何数据流的长度）
+    constexpr uint64_t PARTIES_STREAM_OFFSET = uint64_t(1) << 62;
+
+    // 文件头标志位
+    enum Flag : uint16_t {
+        FLAG_ENCRYPTED = 0x0001, // 数据已加密
+        FLAG_XOR_KEY   = 0x0002, // 使用异或+密钥加密（否则为偏移量加密）
+        FLAG_BLOCKS    = 0x0004, // 分块模式：各块使用独立的码表
+        FLAG_SYNC_POINTS = 0x0008, // 单一码表模式下记录了同步点索引，可多线程并行解码
+        FLAG_CONTEXT   = 0x0010, // 一阶上下文模式：以前一字节为上下文选择码表
+        FLAG_LZ77      = 0x0020, // LZ77 模式：各块先转换为字面量与匹配，再以两张码表编码
+        FLAG_BWT       = 0x0040, // BWT 模式：各块经 BWT、前移变换与零游程编码后再编码
+        FLAG_STORED    = 0x0080, // 原样存储：数据不经编码（估计节省不明显时）
+        FLAG_CHACHA20  = 0x0100, // 使用 ChaCha20 加密，密钥由口令与文件头中的随机盐派生
+        FLAG_CHECKSUM  = 0x0200, // 记录了原始数据的 CRC32C 校验和
+        FLAG_PARTIES   = 0x0400, // 文件头中记录了收发人信息
+        FLAG_DICTIONARY = 0x0800 // 单一码表模式下码表来自共享字典，文件头中只记录字典 ID
+    };
+
+    // 与加密方式有关的标志位
+    constexpr uint16_t CIPHER_FLAGS = FLAG_ENCRYPTED | FLAG_XOR_KEY | FLAG_CHACHA20;
+
+    // 同步点：比特流中从 bitOffset 位开始解码即得到原始数据第 outputOffset 字节起的内容
+    struct SyncPoint {
+        uint64_t bitOffset = 0;
+        uint64_t outputOffset = 0;
+    };
+
+    // 块索引项
+    struct BlockEntry {
+        uint64_t offset = 0;         // 块数据相对编码数据起始处的偏移
+        uint64_t compressedSize = 0; // 块数据字节数（含码表）
+        uint64_t rawSize = 0;        // 块原始字节数
+        uint32_t checksum = 0;       // 块原始数据的 CRC32C（设置 FLAG_CHECKSUM）
+    };
+
+    // 分块模式下每块数据开头的码表长度
+    constexpr std::size_t BLOCK_TABLE_SIZE = 256;
+
+    // LZ77 模式下每块数据开头的码表长度（字面量/长度码表与距离码表）
+    constexpr std::size_t LZ_TABLE_SIZE = 286 + 30;
+
+    // BWT 模式下每块数据开头的主行号与码表长度
+    constexpr std::size_t BWT_TABLE_SIZE = 4 + 257;
+
+    // 一阶上下文模式的码表：各上下文（前一字节）使用一张编码长度表，
+    // 出现次数少的上下文合并为共用的后备表（第 0 张）
+    struct ContextTables {
+        std::vector<std::array<uint8_t, 256>> lengths; // 各码表的编码长度，第 0 张为后备表
+        std::array<uint16_t, 256> tableOf{};           // 各上下文使用的码表下标
+    };
+
+    struct Header {
+        uint8_t version = VERSION;
+        uint16_t flags = 0;
+        uint64_t originalLength = 0;            // 原始数据字节长度
+        std::array<uint8_t, SALT_SIZE> salt{};  // 派生 ChaCha20 密钥的随机盐（设置 FLAG_CHACHA20）
+        uint64_t nonce = 0;                     // ChaCha20 的随机数（设置 FLAG_CHACHA20）
+        uint32_t kdfIterations = 0;             // 派生 ChaCha20 密钥的 PBKDF2 迭代次数（设置 FLAG_CHACHA20）
+        std::string senderInfo;                 // 发送者信息（设置 FLAG_PARTIES，加密时为密文）
+        std::string receiverInfo;               // 接收者信息（设置 FLAG_PARTIES，加密时为密文）
+        uint32_t checksum = 0;                  // 原始数据流的 CRC32C（设置 FLAG_CHECKSUM，分块模式除外）
+        std::array<uint8_t, 256> codeLengths{}; // 各字节值的编码长度（单一码表模式）
+        uint32_t dictionaryId = 0;              // 共享字典的 ID（设置 FLAG_DICTIONARY，码表由字典填入）
+        std::vector<BlockEntry> blocks;         // 块索引（分块模式）
+        uint64_t syncInterval = 0;              // 同步点间隔（单一码表模式）
+        std::vector<SyncPoint> syncPoints;      // 同步点索引（单一码表模式）
+        ContextTables contexts;                 // 上下文码表（单一码表模式且设置 FLAG_CONTEXT）
+    };
+
+    // 是否加密的是编码后的数据（ChaCha20 加密，原样存储除外），否则加密的是原始数据流
+    inline bool encryptsPayload(const Header &header) {
+        return (header.flags & FLAG_CHACHA20) && !(header.flags & FLAG_STORED);
+    }
+
+    // 是否记录了整个数据流的校验和（分块模式下各块分别记录）
+    inline bool hasStreamChecksum(const Header &header) {
+        return (header.flags & FLAG_CHECKSUM) && !(header.flags & FLAG_BLOCKS);
+    }
+
+    // 将文件头序列化为字节数组
+    std::vector<unsigned char> serializeHeader(const Header &header);
+
+    // 从内存中解析文件头，headerSize 返回文件头总长度（即比特流起始偏移）
+    bool parseHeader(const unsigned char *data, std::size_t size, Header &header, std::size_t &headerSize);
+
+    // 从输入流中读取并解析完整的文件头，读取后流位置位于比特流起始处
+    bool readHeader(std::istream &in, Header &header);
+
+    // 将上下文码表按上述格式追加到 out
+    void serializeContextTables(const ContextTables &tables, std::vector<unsigned char> &out);
+
+    // 从内存中解析上下文码表，used 返回其字节数
+    bool parseContextTables(const unsigned char *data, std::size_t size, ContextTables &tables, std::size_t &used);
+}
+
+#endif // FORMAT_H
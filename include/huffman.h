@@ -0,0 +1,304 @@
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Huffman {
+    // 类: BitReader
+    // 用途: 以 64 位缓冲区按高位优先（MSB-first）顺序读取比特流，
+    //       一次补充多个字节，供多位查表解码使用
+    class BitReader {
+    public:
+        BitReader(const unsigned char *data, std::size_t size)
+            : data(data), size(size), pos(0), buffer(0), count(0) {}
+
+        // 从第 bitOffset 位开始读取
+        BitReader(const unsigned char *data, std::size_t size, uint64_t bitOffset)
+            : data(data), size(size), pos(static_cast<std::size_t>(bitOffset >> 3)), buffer(0), count(0) {
+            if (bitOffset & 7) {
+                refill();
+                consume(static_cast<unsigned>(bitOffset & 7));
+            }
+        }
+
+        // 补充缓冲区，保证其中至少有 57 位可用（超出数据末尾的部分以 0 填充）
+        inline void refill() {
+            if (count > 56) {
+                return;
+            }
+            if (pos + 8 <= size) {
+                uint64_t word = 0;
+                for (int i = 0; i < 8; i++) {
+                    word = (word << 8) | data[pos + i];
+                }
+                // 低于 count 的位与流中后续数据一致，下次补充时重复 OR 不影响结果
+                buffer |= word >> count;
+                unsigned bytes = (64 - count) >> 3;
+                pos += bytes;
+                count += bytes << 3;
+                return;
+            }
+            while (count <= 56) {
+                uint64_t byte = pos < size ? data[pos] : 0;
+                buffer |= byte << (56 - count);
+                pos++;
+                count += 8;
+            }
+        }
+
+        // 查看缓冲区最高的 n 位（1 <= n <= 57），不消耗
+        inline uint32_t peek(unsigned n) const {
+            return static_cast<uint32_t>(buffer >> (64 - n));
+        }
+
+        // 消耗缓冲区最高的 n 位
+        inline void consume(unsigned n) {
+            buffer <<= n;
+            count -= n;
+        }
+
+        // 读取 n 位（0 <= n <= 32）作为无符号整数，高位在前
+        inline uint32_t readBits(unsigned n) {
+            if (n == 0) {
+                return 0;
+            }
+            refill();
+            uint32_t value = peek(n);
+            consume(n);
+            return value;
+        }
+
+        // 逐位读取（供按位遍历的解码器使用）
+        inline unsigned readBit() {
+            if (count == 0) {
+                refill();
+            }
+            unsigned bit = static_cast<unsigned>(buffer >> 63);
+            consume(1);
+            return bit;
+        }
+
+        // 已消耗的位数（即下一个待读取位的位置）
+        inline uint64_t bitPosition() const {
+            return static_cast<uint64_t>(pos) * 8 - count;
+        }
+
+    private:
+        const unsigned char *data; // 比特流起始地址
+        std::size_t size;          // 比特流字节数
+        std::size_t pos;           // 下一个待装入缓冲区的字节位置
+        uint64_t buffer;           // 位缓冲区，有效位靠高位对齐
+        unsigned count;            // 缓冲区中有效位数
+    };
+
+    // 结构体: Code
+    // 用途: 描述一个符号的哈夫曼编码（编码值的低 length 位有效，高位在前）
+    struct Code {
+        uint32_t symbol;
+        uint64_t bits;
+        unsigned length;
+    };
+
+    // 哈夫曼编码允许的最大长度（位）
+    constexpr unsigned MAX_CODE_LENGTH = 64;
+
+    // 结构体: AlignedCode
+    // 用途: 编码主循环使用的紧凑编码表项，编码值左移至最高位对齐
+    struct AlignedCode {
+        uint64_t bits;
+        uint64_t length;
+    };
+
+    // 类: ContextCodes
+    // 用途: 一阶上下文模型的编码表：以前一字节（上下文）选择编码表，多个上下文可共用同一张表。
+    //       构建时即转换为编码主循环使用的高位对齐形式，编码各段数据时不再重复转换
+    class ContextCodes {
+    public:
+        // tables 为各编码表（每张以字节值为下标，共 256 项），tableOf 为各上下文使用的表下标
+        ContextCodes(const std::vector<std::vector<Code>> &tables, const std::array<uint16_t, 256> &tableOf);
+
+        // 上下文 context 下字节 symbol 的编码
+        const Code &code(unsigned char context, unsigned char symbol) const {
+            return codes[offset[context] + symbol];
+        }
+
+        // 各表中最长编码的位数
+        unsigned maxLength() const { return longest; }
+
+    private:
+        friend class BitWriter;
+        std::vector<Code> codes;                // 各表依次排列，每张 256 项
+        std::vector<AlignedCode> aligned;       // 与 codes 对应的高位对齐形式
+        std::array<std::size_t, 256> offset{};  // 各上下文所用表在 codes 中的起始下标
+        unsigned longest = 0;
+    };
+
+    // 函数: storeBigEndian64
+    // 用途: 以大端序写出 64 位整数（逐字节展开书写，编译器会将其合并为一次字节交换加一次写入）
+    inline void storeBigEndian64(unsigned char *dst, uint64_t value) {
+        dst[0] = static_cast<unsigned char>(value >> 56);
+        dst[1] = static_cast<unsigned char>(value >> 48);
+        dst[2] = static_cast<unsigned char>(value >> 40);
+        dst[3] = static_cast<unsigned char>(value >> 32);
+        dst[4] = static_cast<unsigned char>(value >> 24);
+        dst[5] = static_cast<unsigned char>(value >> 16);
+        dst[6] = static_cast<unsigned char>(value >> 8);
+        dst[7] = static_cast<unsigned char>(value);
+    }
+
+    // 类: BitWriter
+    // 用途: 以 64 位累加器按高位优先（MSB-first）顺序写入比特流。每次写入后将累加器中的
+    //       整字节以一次 8 字节写入的方式写出（不做分支判断），避免逐位移位与逐字节 push_back；
+    //       输出数组预先分配并在末尾保留 8 字节余量
+    class BitWriter {
+    public:
+        // 从 out 的末尾开始追加
+        explicit BitWriter(std::vector<unsigned char> &out) : out(out), pos(out.size()), buffer(0), count(0) {}
+
+        // 保证还能再写入至少 bytes 个字节而无需扩容
+        inline void reserve(std::size_t bytes) {
+            if (out.size() < pos + bytes + 8) {
+                out.resize(pos + bytes + 8);
+            }
+        }
+
+        // 写入 bits 的低 length 位（0 <= length <= 64）
+        inline void put(uint64_t bits, unsigned length) {
+            if (length > 56) {
+                put(bits >> 32, length - 32);
+                bits &= 0xFFFFFFFFu;
+                length = 32;
+            }
+            reserve(8);
+            buffer = (buffer << length) | bits;
+            count += length;
+            pos += flushBytes(out.data() + pos, buffer, count);
+        }
+
+        // 按编码表依次写入 size 个字节的编码（codes 以字节值为下标，共 256 项），编码主循环见 huffman.cpp
+        void putSymbols(const unsigned char *data, std::size_t size, const Code *codes);
+
+        // 按一阶上下文编码表依次写入 size 个字节的编码：每个字节以前一字节为上下文选择编码表，
+        // previous 为 data[0] 的上下文
+        void putContextSymbols(const unsigned char *data, std::size_t size, unsigned char previous,
+                               const ContextCodes &contexts);
+
+        // 已写入的位数（含累加器中尚未写出的位）
+        inline uint64_t bitPosition() const {
+            return static_cast<uint64_t>(pos) * 8 + count;
+        }
+
+        // 已完整写入输出数组的字节数
+        inline std::size_t size() const { return pos; }
+
+        // 丢弃已写入输出数组的字节（调用方已将其写出），累加器中的位保留
+        inline void clear() { pos = 0; }
+
+        // 写出累加器中剩余的位（最后不足 8 位的部分低位补 0），并将输出数组截断为实际长度
+        void finish() {
+            reserve(1);
+            if (count > 0) {
+                out[pos++] = static_cast<unsigned char>(buffer << (8 - count));
+                count = 0;
+            }
+            out.resize(pos);
+        }
+
+        // 将累加器中的整字节写到 dst（固定写 8 个字节，多写的部分会被后续写入覆盖），
+        // 返回写出的字节数；调用前 1 <= count <= 64，调用后 count < 8
+        static inline std::size_t flushBytes(unsigned char *dst, uint64_t buffer, unsigned &count) {
+            if (count == 0) {
+                return 0;
+            }
+            storeBigEndian64(dst, buffer << (64 - count));
+            std::size_t bytes = count >> 3;
+            count &= 7;
+            return bytes;
+        }
+
+    private:
+        // 编码主循环：自第 begin 个符号起写入至第 size 个符号，lookup(i) 返回第 i 个符号的高位对齐编码
+        template<typename Lookup>
+        void putAligned(std::size_t begin, std::size_t size, unsigned maxLength, const Lookup &lookup);
+
+        std::vector<unsigned char> &out; // 输出数组
+        std::size_t pos;                 // 下一个待写入字节的位置
+        uint64_t buffer;                 // 累加器，低 count 位有效
+        unsigned count;                  // 累加器中有效位数（写入之间始终小于 8）
+    };
+
+    // 函数: canonicalCodes
+    // 用途: 由各符号的编码长度生成范式哈夫曼编码：按（长度, 符号值）递增的顺序依次分配编码，
+    //       因此只需保存编码长度即可在解码端重建完全相同的编码
+    //
+    // 参数:
+    //    lengths - 下标为符号值、值为编码长度的数组（0 表示符号未出现）
+    //
+    // 返回:
+    //    各符号的编码（下标与 lengths 对应，未出现的符号长度为 0）；
+    //    长度超过 MAX_CODE_LENGTH 或长度集合不满足 Kraft 不等式时返回空数组
+    std::vector<Code> canonicalCodes(const std::vector<uint8_t> &lengths);
+
+    // 函数: limitedCodeLengths
+    // 用途: 使用包合并（package-merge）算法构造最长不超过 maxLength 位的最优编码长度，
+    //       即在长度限制下带权路径长度最小的前缀码
+    //
+    // 参数:
+    //    freq      - 下标为符号值、值为出现频率的数组
+    //    maxLength - 最长编码长度（1 ~ MAX_CODE_LENGTH）
+    //
+    // 返回:
+    //    各符号的编码长度（未出现的符号为 0，只有一个符号时为 1）；
+    //    maxLength 非法或 2^maxLength 小于出现的符号个数时返回空数组
+    std::vector<uint8_t> limitedCodeLengths(const std::vector<uint64_t> &freq, unsigned maxLength);
+
+    // 类: DecodeTable
+    // 用途: 多位查表解码器。主表以接下来的 primaryBits 位为下标，
+    //       每项给出符号及其编码长度；长于主表位数的编码通过二级子表继续查找
+    class DecodeTable {
+    public:
+        static constexpr unsigned DEFAULT_PRIMARY_BITS = 11;
+        static constexpr uint32_t INVALID_SYMBOL = 0xFFFFFFFFu;
+
+        // 由编码列表构建解码表，编码不构成前缀码或长度超过 64 位时返回 false
+        bool build(const std::vector<Code> &codes, unsigned primaryBits = DEFAULT_PRIMARY_BITS);
+
+        // 解码一个符号，遇到无效编码时返回 INVALID_SYMBOL
+        inline uint32_t decode(BitReader &reader) const {
+            reader.refill();
+            const Entry *entry = &entries[reader.peek(rootBits)];
+            while (entry->kind == LINK) {
+                reader.consume(entry->length);
+                reader.refill();
+                entry = &entries[entry->value + reader.peek(entry->subBits)];
+            }
+            if (entry->kind != SYMBOL) {
+                return INVALID_SYMBOL;
+            }
+            reader.consume(entry->length);
+            return entry->value;
+        }
+
+    private:
+        enum Kind : uint8_t { EMPTY = 0, SYMBOL = 1, LINK = 2 };
+
+        // 表项：符号项记录符号值与本级消耗位数；子表项记录子表起始下标与子表索引位数
+        struct Entry {
+            uint32_t value;
+            uint8_t length;
+            uint8_t subBits;
+            uint8_t kind;
+        };
+
+        std::vector<Entry> entries; // 主表位于开头，子表依次追加在后
+        unsigned rootBits = 1;      // 主表索引位数
+
+        bool buildLevel(const std::vector<const Code *> &codes, unsigned depth,
+                        std::size_t offset, unsigned bits, unsigned maxBits);
+    };
+}
+
+#endif // HUFFMAN_H
\ No newline at end of file
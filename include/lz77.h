@@ -0,0 +1,84 @@
+#ifndef LZ77_H
+#define LZ77_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "huffman.h"
+
+// LZ77 前端：在滑动窗口内查找重复串，将数据转换为字面量与（长度, 距离）匹配的序列，
+// 再以两张哈夫曼码表分别编码字面量/长度符号流与距离符号流（与 DEFLATE 相同的符号划分）：
+//   字面量/长度符号 0~255 为字面量，256 保留不用，257~285 为匹配长度（附加若干位给出基值之上的偏移）
+//   距离符号 0~29 为匹配距离（同样附加若干位）
+namespace LZ77 {
+    // 匹配查找的策略
+    enum class Level {
+        NONE,    // 不使用 LZ77
+        GREEDY,  // 贪心：每个位置直接使用找到的最长匹配
+        LAZY,    // 惰性：若下一位置的匹配更长，则当前位置输出字面量
+        OPTIMAL  // 最优解析：以估计的编码位数为代价，动态规划求代价最小的字面量/匹配序列
+    };
+
+    constexpr std::size_t WINDOW_SIZE = 32768; // 滑动窗口字节数（最大匹配距离）
+    constexpr unsigned MIN_MATCH = 3;          // 最短匹配长度
+    constexpr unsigned MAX_MATCH = 258;        // 最长匹配长度
+
+    constexpr unsigned LITERALS = 256;         // 字面量符号个数
+    constexpr unsigned LITLEN_SYMBOLS = 286;   // 字面量/长度符号个数
+    constexpr unsigned DISTANCE_SYMBOLS = 30;  // 距离符号个数
+
+    // 字面量或匹配：length 为 0 时 value 为字面量字节值，否则 value 为匹配距离（1 ~ WINDOW_SIZE）
+    struct Token {
+        uint16_t length;
+        uint16_t value;
+    };
+
+    // 长度或距离符号所代表的取值范围：基值与附加位数
+    struct SymbolRange {
+        uint16_t base;
+        uint8_t extra;
+    };
+
+    // 长度符号 257~285 依次对应的取值范围
+    extern const SymbolRange LENGTH_RANGES[LITLEN_SYMBOLS - LITERALS - 1];
+
+    // 距离符号 0~29 依次对应的取值范围
+    extern const SymbolRange DISTANCE_RANGES[DISTANCE_SYMBOLS];
+
+    // 函数: parseLevel
+    // 用途: 由名称（greedy、lazy、optimal）得到匹配查找策略，名称无效时返回 false
+    bool parseLevel(const std::string &name, Level &level);
+
+    // 函数: levelName
+    // 用途: 匹配查找策略的名称
+    const char *levelName(Level level);
+
+    // 函数: parse
+    // 用途: 以哈希链查找匹配，将数据转换为字面量与匹配的序列（匹配不引用 data 之前的内容）
+    //
+    // 参数:
+    //    data   - 待解析数据
+    //    size   - 字节数
+    //    level  - 匹配查找策略（不为 NONE）
+    //    tokens - 输出：字面量与匹配的序列
+    void parse(const unsigned char *data, std::size_t size, Level level, std::vector<Token> &tokens);
+
+    // 函数: countSymbols
+    // 用途: 统计序列中各字面量/长度符号与距离符号的出现次数（litLen、distance 分别被重置为相应的符号个数）
+    void countSymbols(const std::vector<Token> &tokens, std::vector<uint64_t> &litLen, std::vector<uint64_t> &distance);
+
+    // 函数: encode
+    // 用途: 按两张码表写入序列：每个字面量写入其编码；每个匹配依次写入长度符号的编码、长度附加位、
+    //       距离符号的编码、距离附加位（附加位高位在前）
+    //
+    // 参数:
+    //    tokens   - 字面量与匹配的序列
+    //    litLen   - 字面量/长度符号的编码（共 LITLEN_SYMBOLS 项）
+    //    distance - 距离符号的编码（共 DISTANCE_SYMBOLS 项）
+    //    writer   - 比特流写入器
+    void encode(const std::vector<Token> &tokens, const std::vector<Huffman::Code> &litLen,
+                const std::vector<Huffman::Code> &distance, Huffman::BitWriter &writer);
+}
+
+#endif // LZ77_H
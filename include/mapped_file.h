@@ -0,0 +1,52 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 类: MappedFile
+// 用途: 以内存映射（mmap）方式访问文件，读写数据时不经过流缓冲区，也不复制到中间数组
+class MappedFile {
+public:
+    // 映射方式
+    enum Mode {
+        READ_ONLY,     // 只读
+        COPY_ON_WRITE, // 可原地修改映射内容，修改不写回文件（MAP_PRIVATE）
+        READ_WRITE     // 修改直接写回文件（MAP_SHARED）
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // 映射已有文件的全部内容，失败时返回 false
+    bool open(const std::string &path, Mode mode = READ_ONLY);
+
+    // 创建（或截断）文件，将其长度设为 size 字节后以 READ_WRITE 方式映射
+    bool create(const std::string &path, uint64_t size);
+
+    // 访问模式提示：顺序读取（内核加大预读并及时回收已读页）
+    void adviseSequential();
+
+    // 访问模式提示：即将访问全部内容（内核提前异步读入）
+    void adviseWillNeed();
+
+    // 解除映射并关闭文件
+    void close();
+
+    unsigned char *data() { return address; }
+    const unsigned char *data() const { return address; }
+    std::size_t size() const { return length; }
+
+private:
+    int fd = -1;
+    unsigned char *address = nullptr;
+    std::size_t length = 0;
+
+    bool map(int protection, int flags);
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,76 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 控制台输出的详细程度（错误信息总是输出到标准错误）
+enum class Verbosity {
+    QUIET = 0,   // 不输出
+    SUMMARY = 1, // 只输出 HASH 值、数据大小、收发人信息等摘要
+    DEBUG = 2    // 另外输出词频统计表、WPL、压缩数据末尾字节等调试信息
+};
+
+// 类: Stats
+// 用途: 统计信息收集器。记录一次压缩或解压中各阶段的耗时（同名阶段累加，按首次出现的顺序保存）
+//       以及字节数、WPL、压缩率、熵等指标，输出为 JSON（每次一行）或 CSV（每项一行）
+class Stats {
+public:
+    // 输出格式
+    enum Format { JSON, CSV };
+
+    // 类: Stats::Timer
+    // 用途: 计时器，从构造起到 stop() 或析构为止的耗时累加到指定阶段；stats 为空指针时不计时
+    class Timer {
+    public:
+        Timer(Stats *stats, const char *phase);
+        ~Timer() { stop(); }
+
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+        // 结束计时（只记录一次）
+        void stop();
+
+    private:
+        Stats *stats;
+        const char *phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // 累加阶段耗时（毫秒）
+    void addTime(const std::string &phase, double milliseconds);
+
+    // 记录数值或字符串指标（同名指标覆盖）
+    void set(const std::string &name, double value);
+    void set(const std::string &name, const std::string &value);
+
+    // 格式化为单行 JSON 对象：{"name":...,"phases_ms":{...}}
+    std::string toJson() const;
+
+    // 格式化为 CSV 行：metric,value（阶段耗时的指标名为 time_ms.阶段名），不含表头
+    std::string toCsv() const;
+
+    // 追加输出到 target："-" 表示标准错误，否则为文件（CSV 文件为空时先写表头）。
+    // 多个线程可同时写同一目标
+    bool write(const std::string &target, Format format) const;
+
+    // 由字节频率计算信息熵（位/字节）
+    static double entropy(const std::vector<uint64_t> &freq);
+
+private:
+    struct Value {
+        std::string name;
+        std::string text;
+        bool isNumber;
+    };
+
+    std::vector<std::pair<std::string, double>> phases;
+    std::vector<Value> values;
+
+    void setValue(const std::string &name, const std::string &text, bool isNumber);
+};
+
+#endif // STATS_H
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 类: ThreadPool
+// 用途: 固定数量工作线程的工作窃取（work-stealing）线程池。每个工作线程有自己的任务队列：
+//       外部线程提交的任务轮流放入各队列，工作线程在任务中提交的新任务放入自己的队列；
+//       工作线程优先从自己队列的尾部取任务，自己的队列为空时从其他队列的头部窃取，
+//       各任务耗时差别很大时（如批量压缩大小不一的文件）空闲线程不会等待
+class ThreadPool {
+public:
+    // threads 为 0 时使用硬件并发线程数
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // 提交一个任务
+    void submit(std::function<void()> task);
+
+    // 等待所有已提交的任务执行完毕（不能在本线程池的任务中调用）
+    void wait();
+
+    // 工作线程数
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // 将 [0, count) 中的每个下标作为一个任务并行执行 func，返回时全部完成
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)> &func);
+
+    // 解析线程数参数：0 表示硬件并发线程数（至少为 1）
+    static unsigned resolveThreads(unsigned threads);
+
+private:
+    // 单个工作线程的任务队列
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues; // 与 workers 一一对应
+    std::atomic<std::size_t> queued{0};         // 各队列中尚未取出的任务总数
+    std::atomic<std::size_t> nextQueue{0};      // 外部提交任务时轮流选择的队列
+    std::mutex mutex;                           // 保护 pending、stopping 及等待条件
+    std::condition_variable taskReady;
+    std::condition_variable allDone;
+    std::size_t pending = 0; // 已提交但尚未完成的任务数
+    bool stopping = false;
+
+    bool takeTask(std::size_t self, std::function<void()> &task);
+    void workerLoop(std::size_t self);
+};
+
+#endif // THREAD_POOL_H
@@ -1,15 +1,28 @@
 #ifndef UI_H
 #define UI_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace UI {
+    // 文件大小达到该阈值时改用流式压缩/解压，避免将整个文件读入内存
+    constexpr std::uintmax_t STREAMING_THRESHOLD = 256ULL << 20;
+
+    // 单一码表压缩时同步点的间隔（原始字节数），解压时据此将比特流分段并行解码
+    constexpr std::size_t SYNC_INTERVAL = 1 << 20;
+
+    // 判断文件是否足够大，需要使用流式处理
+    bool useStreaming(const std::string &path);
+
     // 显示主菜单
     void showMenu();
     // 处理压缩操作
     void processCompression();
     // 处理解压缩操作
     void processDecompression();
+    // 命令行批处理：不弹出对话框，批量压缩或解压多个文件与目录，返回进程退出码（见 cli.cpp）
+    int runCommandLine(int argc, char *argv[]);
 }
 
 #endif // UI_H
\ No newline at end of file
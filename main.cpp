@@ -1,10 +1,15 @@
 #include "ui.h"
 #include <iostream>
 
-int main() {
+int main(int argc, char *argv[]) {
+    // 带参数启动时以命令行方式批量处理，不显示图形界面
+    if (argc > 1) {
+        return UI::runCommandLine(argc, argv);
+    }
+
     std::cout << "Welcome to Text Compression & Decompression System" << std::endl;
     
     UI::showMenu();
 
     return 0;
-}
\ No newline at end of file
+}
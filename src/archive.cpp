@@ -0,0 +1,297 @@
+#include "archive.h"
+#include "common.h"
+#include "crc32c.h"
+#include "format.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+// 匿名命名空间：按小端序读写定长整数
+namespace {
+    const char MAGIC[4] = {'H', 'F', 'M', 'A'};
+
+    void putLE(std::vector<unsigned char> &out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    // 自 pos 起读取 bytes 个字节的整数并后移 pos，越界时将 ok 置为 false
+    uint64_t getLE(const std::vector<unsigned char> &data, std::size_t &pos, int bytes, bool &ok) {
+        if (!ok || data.size() - pos < static_cast<std::size_t>(bytes)) {
+            ok = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (int i = bytes - 1; i >= 0; i--) {
+            value = (value << 8) | data[pos + i];
+        }
+        pos += bytes;
+        return value;
+    }
+
+    // 函数: describeMember
+    // 用途: 由压缩文件的文件头填写目录项中的原始数据长度、校验和、标志位与文件头字节数
+    bool describeMember(const std::string &memberFile, Archive::Entry &entry) {
+        std::ifstream in(memberFile, std::ios::binary);
+        Format::Header header;
+        if (!in || !Format::readHeader(in, header)) {
+            return false;
+        }
+        entry.originalLength = header.originalLength;
+        entry.flags = header.flags;
+        entry.headerSize = static_cast<uint32_t>(in.tellg());
+        entry.checksum = header.checksum;
+        if (header.flags & Format::FLAG_BLOCKS) {
+            entry.checksum = 0;
+            for (const Format::BlockEntry &block : header.blocks) {
+                entry.checksum = CRC32C::combine(entry.checksum, block.checksum, block.rawSize);
+            }
+        }
+        return true;
+    }
+}
+
+namespace Archive {
+    bool validName(const std::string &name) {
+        if (name.empty() || name.size() > 0xFFFF || name[0] == '/' || name.find('\\') != std::string::npos) {
+            return false;
+        }
+        std::size_t begin = 0;
+        while (begin <= name.size()) {
+            std::size_t slash = std::min(name.find('/', begin), name.size());
+            std::string segment = name.substr(begin, slash - begin);
+            if (segment.empty() || segment == "." || segment == "..") {
+                return false;
+            }
+            begin = slash + 1;
+        }
+        return true;
+    }
+
+    // 函数: load
+    // 用途: 读取目录尾，校验魔数、版本号与中央目录的位置，再读取并校验中央目录（CRC32C），建立名称索引
+    bool Directory::load(const std::string &archiveFile) {
+        list.clear();
+        index.clear();
+        std::ifstream in(archiveFile, std::ios::binary | std::ios::ate);
+        if (!in) {
+            std::cerr << "Error opening archive: " << archiveFile << std::endl;
+            return false;
+        }
+        uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+        std::vector<unsigned char> trailer(TRAILER_SIZE);
+        if (fileSize < TRAILER_SIZE ||
+            !in.seekg(static_cast<std::streamoff>(fileSize - TRAILER_SIZE), std::ios::beg) ||
+            !in.read(reinterpret_cast<char *>(trailer.data()), TRAILER_SIZE) ||
+            std::memcmp(trailer.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            std::cerr << "Not an archive: " << archiveFile << std::endl;
+            return false;
+        }
+        bool ok = true;
+        std::size_t pos = sizeof(MAGIC);
+        uint64_t version = getLE(trailer, pos, 2, ok);
+        getLE(trailer, pos, 2, ok);
+        uint64_t count = getLE(trailer, pos, 4, ok);
+        uint32_t checksum = static_cast<uint32_t>(getLE(trailer, pos, 4, ok));
+        uint64_t offset = getLE(trailer, pos, 8, ok);
+        uint64_t size = getLE(trailer, pos, 8, ok);
+        if (version != VERSION) {
+            std::cerr << "Unsupported archive version " << version << ": " << archiveFile << std::endl;
+            return false;
+        }
+        if (offset > fileSize - TRAILER_SIZE || size != fileSize - TRAILER_SIZE - offset) {
+            std::cerr << "Invalid archive directory: " << archiveFile << std::endl;
+            return false;
+        }
+
+        std::vector<unsigned char> data(static_cast<std::size_t>(size));
+        in.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        if (!in.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size())) ||
+            CRC32C::update(0, data.data(), data.size()) != checksum) {
+            std::cerr << "Archive directory checksum mismatch: " << archiveFile << std::endl;
+            return false;
+        }
+        pos = 0;
+        for (uint64_t i = 0; ok && i < count; i++) {
+            Entry entry;
+            std::size_t nameSize = static_cast<std::size_t>(getLE(data, pos, 2, ok));
+            if (!ok || data.size() - pos < nameSize) {
+                ok = false;
+                break;
+            }
+            entry.name.assign(data.begin() + pos, data.begin() + pos + nameSize);
+            pos += nameSize;
+            entry.offset = getLE(data, pos, 8, ok);
+            entry.compressedSize = getLE(data, pos, 8, ok);
+            entry.originalLength = getLE(data, pos, 8, ok);
+            entry.checksum = static_cast<uint32_t>(getLE(data, pos, 4, ok));
+            entry.flags = static_cast<uint16_t>(getLE(data, pos, 2, ok));
+            entry.headerSize = static_cast<uint32_t>(getLE(data, pos, 4, ok));
+            // 成员须位于中央目录之前
+            ok = ok && validName(entry.name) && entry.offset <= offset &&
+                 entry.compressedSize <= offset - entry.offset && add(entry);
+        }
+        if (!ok || pos != data.size()) {
+            list.clear();
+            index.clear();
+            std::cerr << "Invalid archive directory: " << archiveFile << std::endl;
+            return false;
+        }
+        directoryOffset = offset;
+        return true;
+    }
+
+    const Entry *Directory::find(const std::string &name) const {
+        auto it = index.find(name);
+        return it == index.end() ? nullptr : &list[it->second];
+    }
+
+    bool Directory::add(const Entry &entry) {
+        if (!index.emplace(entry.name, list.size()).second) {
+            return false;
+        }
+        list.push_back(entry);
+        return true;
+    }
+
+    std::vector<unsigned char> Directory::serialize(uint64_t offset) const {
+        std::vector<unsigned char> out;
+        for (const Entry &entry : list) {
+            putLE(out, entry.name.size(), 2);
+            out.insert(out.end(), entry.name.begin(), entry.name.end());
+            putLE(out, entry.offset, 8);
+            putLE(out, entry.compressedSize, 8);
+            putLE(out, entry.originalLength, 8);
+            putLE(out, entry.checksum, 4);
+            putLE(out, entry.flags, 2);
+            putLE(out, entry.headerSize, 4);
+        }
+        uint64_t directorySize = out.size();
+        uint32_t checksum = CRC32C::update(0, out.data(), out.size());
+        out.insert(out.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        putLE(out, VERSION, 2);
+        putLE(out, 0, 2);
+        putLE(out, list.size(), 4);
+        putLE(out, checksum, 4);
+        putLE(out, offset, 8);
+        putLE(out, directorySize, 8);
+        return out;
+    }
+
+    // 函数: append
+    // 用途: 主要步骤：
+    //       1. 读取已有归档的中央目录（归档不存在时为空），检查新成员的名称
+    //       2. 将各文件分别压缩为临时文件并由其文件头填写目录项，此时尚未修改归档
+    //       3. 将各成员依次复制到归档末尾（原中央目录与目录尾之后，二者不被覆盖），最后写出新的中央目录与目录尾；
+    //          写出出错时将归档截断回原长度，恢复原样
+    bool append(const std::string &archiveFile, const std::vector<Input> &inputs, const Compressor::Options &options) {
+        // 1. 读取已有的中央目录并检查名称
+        Directory directory;
+        std::error_code ec;
+        bool exists = fs::exists(archiveFile, ec);
+        if (exists && !directory.load(archiveFile)) {
+            return false;
+        }
+        Directory added;
+        for (const Input &input : inputs) {
+            Entry entry;
+            entry.name = input.name;
+            if (!validName(input.name)) {
+                std::cerr << "Invalid member name: " << input.name << std::endl;
+                return false;
+            }
+            if (directory.find(input.name) || !added.add(entry)) {
+                std::cerr << "Duplicate member name: " << input.name << std::endl;
+                return false;
+            }
+        }
+
+        // 2. 压缩为临时文件（文件名含随机部分，同一归档的多次追加互不干扰）
+        std::string tempPrefix = archiveFile + "." + Common::hashToString(std::random_device()()) + ".member";
+        std::vector<std::string> memberFiles;
+        std::vector<Entry> entries(inputs.size());
+        auto removeMembers = [&]() {
+            for (const std::string &memberFile : memberFiles) {
+                std::remove(memberFile.c_str());
+            }
+        };
+        Compressor::Options memberOptions = options;
+        for (std::size_t i = 0; i < inputs.size(); i++) {
+            memberFiles.push_back(tempPrefix + std::to_string(i) + ".tmp");
+            memberOptions.outputFile = memberFiles.back();
+            entries[i].name = inputs[i].name;
+            if (!Compressor::compressFile(inputs[i].path, inputs[i].senderInfo, inputs[i].receiverInfo,
+                                          inputs[i].encrypt, inputs[i].key, memberOptions) ||
+                !describeMember(memberFiles.back(), entries[i])) {
+                std::cerr << "Error adding " << inputs[i].path << " to archive: " << archiveFile << std::endl;
+                removeMembers();
+                return false;
+            }
+        }
+
+        // 3. 复制到归档末尾，再写出新的中央目录与目录尾
+        uint64_t originalSize = exists ? fs::file_size(archiveFile, ec) : 0;
+        std::ofstream out(archiveFile, exists ? std::ios::in | std::ios::out | std::ios::binary
+                                              : std::ios::out | std::ios::binary);
+        if (ec || !out) {
+            std::cerr << "Error opening archive: " << archiveFile << std::endl;
+            removeMembers();
+            return false;
+        }
+        out.seekp(static_cast<std::streamoff>(originalSize), std::ios::beg);
+        uint64_t position = originalSize;
+        bool ok = true;
+        for (std::size_t i = 0; ok && i < inputs.size(); i++) {
+            std::ifstream member(memberFiles[i], std::ios::binary);
+            ok = member && static_cast<bool>(out << member.rdbuf());
+            entries[i].offset = position;
+            entries[i].compressedSize = static_cast<uint64_t>(out.tellp()) - position;
+            position += entries[i].compressedSize;
+            directory.add(entries[i]);
+        }
+        removeMembers();
+        if (ok) {
+            std::vector<unsigned char> tail = directory.serialize(position);
+            out.write(reinterpret_cast<const char *>(tail.data()), static_cast<std::streamsize>(tail.size()));
+        }
+        out.close();
+        if (!ok || !out) {
+            std::cerr << "Error writing archive: " << archiveFile << std::endl;
+            if (exists) {
+                fs::resize_file(archiveFile, originalSize, ec);
+            } else {
+                std::remove(archiveFile.c_str());
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool extract(const std::string &archiveFile, const Directory &directory, const std::string &name,
+                 const std::string &senderInfo, const std::string &receiverInfo, bool decrypt, const std::string &key,
+                 const Decompressor::Options &options) {
+        const Entry *entry = directory.find(name);
+        if (!entry) {
+            std::cerr << "No such member: " << name << " in " << archiveFile << std::endl;
+            return false;
+        }
+        Decompressor::Options memberOptions = options;
+        if (memberOptions.outputFile.empty()) {
+            memberOptions.outputFile = Common::joinPath(options.outputDir, entry->name);
+        }
+        std::error_code ec;
+        fs::path parent = fs::path(memberOptions.outputFile).parent_path();
+        if (!parent.empty()) {
+            fs::create_directories(parent, ec);
+        }
+        return TableDecompressor::decompressMember(archiveFile, entry->offset, entry->compressedSize, senderInfo,
+                                                   receiverInfo, decrypt, key, memberOptions);
+    }
+}
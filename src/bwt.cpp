@@ -0,0 +1,283 @@
+#include "bwt.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // 函数: getBuckets
+    // 作用: 统计各符号的出现次数，得到各符号桶的起始位置（end 为 false）或结束位置（end 为 true）
+    template<typename Symbol>
+    void getBuckets(const Symbol *s, int32_t n, int32_t k, std::vector<int32_t> &bucket, bool end) {
+        bucket.assign(static_cast<std::size_t>(k), 0);
+        for (int32_t i = 0; i < n; i++) {
+            bucket[static_cast<std::size_t>(s[i])]++;
+        }
+        int32_t sum = 0;
+        for (int32_t c = 0; c < k; c++) {
+            sum += bucket[static_cast<std::size_t>(c)];
+            bucket[static_cast<std::size_t>(c)] = end ? sum : sum - bucket[static_cast<std::size_t>(c)];
+        }
+    }
+
+    // 函数: induce
+    // 作用: 由已放入各桶的 LMS 后缀诱导排序：先自左向右放入 L 型后缀（桶的起始处），
+    //       再自右向左放入 S 型后缀（桶的结束处）
+    template<typename Symbol>
+    void induce(const Symbol *s, int32_t *sa, const std::vector<bool> &isS, int32_t n, int32_t k,
+                std::vector<int32_t> &bucket) {
+        getBuckets(s, n, k, bucket, false);
+        for (int32_t i = 0; i < n; i++) {
+            int32_t j = sa[i] - 1;
+            if (sa[i] > 0 && !isS[static_cast<std::size_t>(j)]) {
+                sa[bucket[static_cast<std::size_t>(s[j])]++] = j;
+            }
+        }
+        getBuckets(s, n, k, bucket, true);
+        for (int32_t i = n - 1; i >= 0; i--) {
+            int32_t j = sa[i] - 1;
+            if (sa[i] > 0 && isS[static_cast<std::size_t>(j)]) {
+                sa[--bucket[static_cast<std::size_t>(s[j])]] = j;
+            }
+        }
+    }
+
+    // 函数: sais
+    // 作用: SA-IS 后缀数组构造（Nong、Zhang、Chan 2009）。s[n-1] 须为唯一且最小的符号（结束符），
+    //       符号取值 0 ~ k-1。主要步骤：
+    //       1. 将后缀分为 S 型与 L 型，左侧为 L 型的 S 型后缀称为 LMS 后缀；
+    //          将 LMS 后缀放入各桶末尾后诱导排序，即得到按 LMS 子串排好序的 LMS 后缀
+    //       2. 为各 LMS 子串命名，名称互不相同时即得到 LMS 后缀的顺序，否则对名称串递归求后缀数组
+    //       3. 按 LMS 后缀的顺序将其放入各桶末尾，再诱导排序得到完整的后缀数组
+    template<typename Symbol>
+    void sais(const Symbol *s, int32_t *sa, int32_t n, int32_t k) {
+        std::vector<bool> isS(static_cast<std::size_t>(n), false);
+        isS[static_cast<std::size_t>(n - 1)] = true;
+        for (int32_t i = n - 2; i >= 0; i--) {
+            isS[static_cast<std::size_t>(i)] =
+                s[i] < s[i + 1] || (s[i] == s[i + 1] && isS[static_cast<std::size_t>(i + 1)]);
+        }
+        auto isLms = [&](int32_t i) {
+            return i > 0 && isS[static_cast<std::size_t>(i)] && !isS[static_cast<std::size_t>(i - 1)];
+        };
+
+        // 1. 按 LMS 子串排序 LMS 后缀
+        std::vector<int32_t> bucket;
+        getBuckets(s, n, k, bucket, true);
+        std::fill(sa, sa + n, -1);
+        for (int32_t i = 1; i < n; i++) {
+            if (isLms(i)) {
+                sa[--bucket[static_cast<std::size_t>(s[i])]] = i;
+            }
+        }
+        induce(s, sa, isS, n, k, bucket);
+
+        // 将排好序的 LMS 后缀移到 sa 开头
+        int32_t n1 = 0;
+        for (int32_t i = 0; i < n; i++) {
+            if (isLms(sa[i])) {
+                sa[n1++] = sa[i];
+            }
+        }
+
+        // 2. 为 LMS 子串命名：相邻两个子串（字节与类型）完全相同时名称相同。
+        //    名称暂存于 sa 后半部分以位置 / 2 为下标处（LMS 位置互不相邻，不会冲突）
+        std::fill(sa + n1, sa + n, -1);
+        int32_t name = 0;
+        int32_t previous = -1;
+        for (int32_t i = 0; i < n1; i++) {
+            int32_t pos = sa[i];
+            bool differ = false;
+            for (int32_t d = 0; d < n; d++) {
+                if (previous == -1 || s[pos + d] != s[previous + d] ||
+                    isS[static_cast<std::size_t>(pos + d)] != isS[static_cast<std::size_t>(previous + d)]) {
+                    differ = true;
+                    break;
+                }
+                if (d > 0 && (isLms(pos + d) || isLms(previous + d))) {
+                    break;
+                }
+            }
+            if (differ) {
+                name++;
+                previous = pos;
+            }
+            sa[n1 + pos / 2] = name - 1;
+        }
+        for (int32_t i = n - 1, j = n - 1; i >= n1; i--) {
+            if (sa[i] >= 0) {
+                sa[j--] = sa[i];
+            }
+        }
+
+        // 名称串位于 sa 末尾的 n1 项，其后缀数组写入 sa 开头的 n1 项
+        int32_t *s1 = sa + n - n1;
+        if (name < n1) {
+            sais(s1, sa, n1, name);
+        } else {
+            for (int32_t i = 0; i < n1; i++) {
+                sa[s1[i]] = i;
+            }
+        }
+
+        // 3. 由 LMS 后缀的顺序诱导排序全部后缀
+        getBuckets(s, n, k, bucket, true);
+        for (int32_t i = 1, j = 0; i < n; i++) {
+            if (isLms(i)) {
+                s1[j++] = i;
+            }
+        }
+        for (int32_t i = 0; i < n1; i++) {
+            sa[i] = s1[sa[i]];
+        }
+        std::fill(sa + n1, sa + n, -1);
+        for (int32_t i = n1 - 1; i >= 0; i--) {
+            int32_t j = sa[i];
+            sa[i] = -1;
+            sa[--bucket[static_cast<std::size_t>(s[j])]] = j;
+        }
+        induce(s, sa, isS, n, k, bucket);
+    }
+
+    // 函数: walk
+    // 作用: BWT 逆变换的主循环。next 的第 j 项为第 j 行首字节（低 8 位）与原数据中下一个位置所在的行号（其余高位），
+    //       自主行起依次输出各行首字节即得到原数据
+    template<typename Word>
+    void walk(const unsigned char *bwt, std::size_t size, uint32_t primary, unsigned char *out) {
+        // 第 0 行以结束符开头；字节 c 开头的各行紧随其后，按在最后一列中出现的顺序排列
+        std::size_t start[256];
+        std::size_t count[256] = {0};
+        for (std::size_t i = 0; i < size; i++) {
+            count[bwt[i]]++;
+        }
+        std::size_t sum = 1;
+        for (unsigned c = 0; c < 256; c++) {
+            start[c] = sum;
+            sum += count[c];
+        }
+        std::vector<Word> next(size + 1, 0);
+        for (std::size_t row = 0; row <= size; row++) {
+            if (row == primary) {
+                continue;
+            }
+            unsigned char c = bwt[row < primary ? row : row - 1];
+            next[start[c]++] = (static_cast<Word>(row) << 8) | c;
+        }
+        Word entry = next[primary];
+        for (std::size_t i = 0; i < size; i++) {
+            out[i] = static_cast<unsigned char>(entry);
+            entry = next[static_cast<std::size_t>(entry >> 8)];
+        }
+    }
+}
+
+namespace BWT {
+    // 函数: suffixArray
+    // 用途: 构造后缀数组：各字节加 1 后在末尾补上结束符 0，求出后缀数组后去掉结束符对应的一项
+    void suffixArray(const unsigned char *data, std::size_t size, std::vector<int32_t> &sa) {
+        int32_t n = static_cast<int32_t>(size) + 1;
+        std::vector<int32_t> s(static_cast<std::size_t>(n));
+        for (std::size_t i = 0; i < size; i++) {
+            s[i] = data[i] + 1;
+        }
+        s[size] = 0;
+        sa.assign(static_cast<std::size_t>(n), 0);
+        sais(s.data(), sa.data(), n, 257);
+        sa.erase(sa.begin());
+    }
+
+    // 函数: transform
+    // 用途: Burrows–Wheeler 变换：第 i 行（按后缀数组排列）的最后一个字节即该行后缀的前一个字节
+    uint32_t transform(const unsigned char *data, std::size_t size, unsigned char *out) {
+        std::vector<int32_t> sa;
+        suffixArray(data, size, sa);
+        // 第 0 行为结束符开头的那一行，其最后一个字节为原数据的最后一个字节
+        out[0] = data[size - 1];
+        uint32_t primary = 0;
+        for (std::size_t i = 0, j = 1; i < size; i++) {
+            if (sa[i] == 0) {
+                primary = static_cast<uint32_t>(i + 1);
+                continue;
+            }
+            out[j++] = data[sa[i] - 1];
+        }
+        return primary;
+    }
+
+    // 函数: inverse
+    // 用途: BWT 逆变换（行号可用 24 位表示时使用 32 位数组，减少内存访问量）
+    bool inverse(const unsigned char *bwt, std::size_t size, uint32_t primary, unsigned char *out) {
+        if (primary == 0 || primary > size) {
+            return false;
+        }
+        if (size < (std::size_t(1) << 24)) {
+            walk<uint32_t>(bwt, size, primary, out);
+        } else {
+            walk<uint64_t>(bwt, size, primary, out);
+        }
+        return true;
+    }
+
+    // 函数: encodeSymbols
+    // 用途: 前移变换：每个字节输出其在最近使用顺序表中的下标并将其移到表头；
+    //       连续的下标 0 合并为零游程，游程长度 r 以双射二进制（数字 1、2 分别记为 RUNA、RUNB）低位在前输出
+    void encodeSymbols(const unsigned char *bwt, std::size_t size, std::vector<uint16_t> &symbols) {
+        symbols.clear();
+        symbols.reserve(size / 2 + 16);
+        unsigned char order[256];
+        for (unsigned i = 0; i < 256; i++) {
+            order[i] = static_cast<unsigned char>(i);
+        }
+        uint64_t run = 0;
+        auto flushRun = [&]() {
+            if (run == 0) {
+                return;
+            }
+            uint64_t pending = run - 1;
+            while (true) {
+                symbols.push_back(static_cast<uint16_t>((pending & 1) ? RUN_B : RUN_A));
+                if (pending < 2) {
+                    break;
+                }
+                pending = (pending - 2) / 2;
+            }
+            run = 0;
+        };
+        for (std::size_t i = 0; i < size; i++) {
+            unsigned char byte = bwt[i];
+            if (order[0] == byte) {
+                run++;
+                continue;
+            }
+            flushRun();
+            unsigned index = 1;
+            unsigned char moving = order[0];
+            // 自表头起逐项后移，直到遇到该字节
+            while (order[index] != byte) {
+                std::swap(moving, order[index]);
+                index++;
+            }
+            order[index] = moving;
+            order[0] = byte;
+            symbols.push_back(static_cast<uint16_t>(index + 1));
+        }
+        flushRun();
+    }
+
+    SymbolDecoder::SymbolDecoder(unsigned char *out, std::size_t size) : out(out), size(size) {
+        for (unsigned i = 0; i < 256; i++) {
+            order[i] = static_cast<unsigned char>(i);
+        }
+    }
+
+    // 函数: SymbolDecoder::flushRun
+    // 用途: 写出当前零游程（重复表头的字节），游程超出输出缓冲区时返回 false
+    bool SymbolDecoder::flushRun() {
+        if (run > size - pos) {
+            return false;
+        }
+        std::memset(out + pos, order[0], static_cast<std::size_t>(run));
+        pos += static_cast<std::size_t>(run);
+        run = 0;
+        weight = 1;
+        return true;
+    }
+}
@@ -0,0 +1,502 @@
+#include "chacha20.h"
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define CHACHA20_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    // 双轮次数（ChaCha20 共 20 轮：列轮与对角线轮交替各 10 次）
+    constexpr int DOUBLE_ROUNDS = 10;
+
+    inline uint32_t rotl(uint32_t x, int n) {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    inline uint32_t loadLE32(const uint8_t *p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    inline void quarterRound(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d) {
+        a += b; d ^= a; d = rotl(d, 16);
+        c += d; b ^= c; b = rotl(b, 12);
+        a += b; d ^= a; d = rotl(d, 8);
+        c += d; b ^= c; b = rotl(b, 7);
+    }
+
+    // 函数: keyBlock
+    // 用途: 计算第 counter 个密钥流块（64 字节，各字按小端序输出）
+    void keyBlock(const uint32_t *state, uint64_t counter, unsigned char *out) {
+        uint32_t input[16];
+        std::memcpy(input, state, sizeof(input));
+        input[12] = static_cast<uint32_t>(counter);
+        input[13] = static_cast<uint32_t>(counter >> 32);
+        uint32_t x[16];
+        std::memcpy(x, input, sizeof(x));
+        for (int round = 0; round < DOUBLE_ROUNDS; round++) {
+            quarterRound(x[0], x[4], x[8], x[12]);
+            quarterRound(x[1], x[5], x[9], x[13]);
+            quarterRound(x[2], x[6], x[10], x[14]);
+            quarterRound(x[3], x[7], x[11], x[15]);
+            quarterRound(x[0], x[5], x[10], x[15]);
+            quarterRound(x[1], x[6], x[11], x[12]);
+            quarterRound(x[2], x[7], x[8], x[13]);
+            quarterRound(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; i++) {
+            uint32_t word = x[i] + input[i];
+            out[4 * i] = static_cast<unsigned char>(word);
+            out[4 * i + 1] = static_cast<unsigned char>(word >> 8);
+            out[4 * i + 2] = static_cast<unsigned char>(word >> 16);
+            out[4 * i + 3] = static_cast<unsigned char>(word >> 24);
+        }
+    }
+
+    // 函数: xorScalar
+    // 用途: 逐块生成密钥流并与数据异或，size 可以不是块大小的整数倍
+    void xorScalar(const uint32_t *state, uint64_t counter, unsigned char *data, std::size_t size) {
+        unsigned char block[ChaCha20::BLOCK_SIZE];
+        for (std::size_t done = 0; done < size; done += ChaCha20::BLOCK_SIZE, counter++) {
+            keyBlock(state, counter, block);
+            std::size_t step = std::min(size - done, ChaCha20::BLOCK_SIZE);
+            unsigned char *p = data + done;
+            std::size_t i = 0;
+            for (; i + 8 <= step; i += 8) {
+                uint64_t word, mask;
+                std::memcpy(&word, p + i, 8);
+                std::memcpy(&mask, block + i, 8);
+                word ^= mask;
+                std::memcpy(p + i, &word, 8);
+            }
+            for (; i < step; i++) {
+                p[i] ^= block[i];
+            }
+        }
+    }
+
+#ifdef CHACHA20_X86
+    // SSE2 实现：16 个向量分别存放 4 个块的同一状态字，每个 32 位通道计算一个块
+
+    template<int N>
+    inline __m128i rotl128(__m128i x) {
+        return _mm_or_si128(_mm_slli_epi32(x, N), _mm_srli_epi32(x, 32 - N));
+    }
+
+    // 循环左移 16 位即交换各字的高低 16 位
+    template<>
+    inline __m128i rotl128<16>(__m128i x) {
+        return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);
+    }
+
+    inline void quarterRound128(__m128i &a, __m128i &b, __m128i &c, __m128i &d) {
+        a = _mm_add_epi32(a, b); d = rotl128<16>(_mm_xor_si128(d, a));
+        c = _mm_add_epi32(c, d); b = rotl128<12>(_mm_xor_si128(b, c));
+        a = _mm_add_epi32(a, b); d = rotl128<8>(_mm_xor_si128(d, a));
+        c = _mm_add_epi32(c, d); b = rotl128<7>(_mm_xor_si128(b, c));
+    }
+
+    // 函数: xorSse2
+    // 用途: 每次并行生成 4 个密钥流块并与数据异或，共处理 groups 组（每组 256 字节）
+    void xorSse2(const uint32_t *state, uint64_t counter, unsigned char *data, std::size_t groups) {
+        __m128i input[16];
+        for (int i = 0; i < 16; i++) {
+            input[i] = _mm_set1_epi32(static_cast<int>(state[i]));
+        }
+        for (std::size_t group = 0; group < groups; group++, counter += 4, data += 4 * ChaCha20::BLOCK_SIZE) {
+            uint64_t c0 = counter, c1 = counter + 1, c2 = counter + 2, c3 = counter + 3;
+            input[12] = _mm_set_epi32(static_cast<int>(c3), static_cast<int>(c2),
+                                      static_cast<int>(c1), static_cast<int>(c0));
+            input[13] = _mm_set_epi32(static_cast<int>(c3 >> 32), static_cast<int>(c2 >> 32),
+                                      static_cast<int>(c1 >> 32), static_cast<int>(c0 >> 32));
+            __m128i x[16];
+            for (int i = 0; i < 16; i++) {
+                x[i] = input[i];
+            }
+            for (int round = 0; round < DOUBLE_ROUNDS; round++) {
+                quarterRound128(x[0], x[4], x[8], x[12]);
+                quarterRound128(x[1], x[5], x[9], x[13]);
+                quarterRound128(x[2], x[6], x[10], x[14]);
+                quarterRound128(x[3], x[7], x[11], x[15]);
+                quarterRound128(x[0], x[5], x[10], x[15]);
+                quarterRound128(x[1], x[6], x[11], x[12]);
+                quarterRound128(x[2], x[7], x[8], x[13]);
+                quarterRound128(x[3], x[4], x[9], x[14]);
+            }
+            // 每 4 个状态字转置一次：转置后第 k 个向量即第 k 块的这 4 个字
+            for (int g = 0; g < 4; g++) {
+                __m128i a = _mm_add_epi32(x[4 * g], input[4 * g]);
+                __m128i b = _mm_add_epi32(x[4 * g + 1], input[4 * g + 1]);
+                __m128i c = _mm_add_epi32(x[4 * g + 2], input[4 * g + 2]);
+                __m128i d = _mm_add_epi32(x[4 * g + 3], input[4 * g + 3]);
+                __m128i t0 = _mm_unpacklo_epi32(a, b);
+                __m128i t1 = _mm_unpacklo_epi32(c, d);
+                __m128i t2 = _mm_unpackhi_epi32(a, b);
+                __m128i t3 = _mm_unpackhi_epi32(c, d);
+                __m128i rows[4] = {_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+                                   _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)};
+                for (int k = 0; k < 4; k++) {
+                    __m128i *p = reinterpret_cast<__m128i *>(data + k * ChaCha20::BLOCK_SIZE + 16 * g);
+                    _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), rows[k]));
+                }
+            }
+        }
+    }
+
+    // AVX2 实现：与 SSE2 实现相同，但每个向量有 8 个通道，每次计算 8 个块
+
+    template<int N>
+    __attribute__((target("avx2"))) inline __m256i rotl256(__m256i x) {
+        return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N));
+    }
+
+    // 循环左移 16、8 位是字节的重排，以字节洗牌完成
+    template<>
+    __attribute__((target("avx2"))) inline __m256i rotl256<16>(__m256i x) {
+        const __m256i order = _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                              13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+        return _mm256_shuffle_epi8(x, order);
+    }
+
+    template<>
+    __attribute__((target("avx2"))) inline __m256i rotl256<8>(__m256i x) {
+        const __m256i order = _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+                                              14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+        return _mm256_shuffle_epi8(x, order);
+    }
+
+    __attribute__((target("avx2")))
+    inline void quarterRound256(__m256i &a, __m256i &b, __m256i &c, __m256i &d) {
+        a = _mm256_add_epi32(a, b); d = rotl256<16>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi32(c, d); b = rotl256<12>(_mm256_xor_si256(b, c));
+        a = _mm256_add_epi32(a, b); d = rotl256<8>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi32(c, d); b = rotl256<7>(_mm256_xor_si256(b, c));
+    }
+
+    // 函数: xorAvx2
+    // 用途: 每次并行生成 8 个密钥流块并与数据异或，共处理 groups 组（每组 512 字节）
+    __attribute__((target("avx2")))
+    void xorAvx2(const uint32_t *state, uint64_t counter, unsigned char *data, std::size_t groups) {
+        __m256i input[16];
+        for (int i = 0; i < 16; i++) {
+            input[i] = _mm256_set1_epi32(static_cast<int>(state[i]));
+        }
+        for (std::size_t group = 0; group < groups; group++, counter += 8, data += 8 * ChaCha20::BLOCK_SIZE) {
+            int low[8], high[8];
+            for (int k = 0; k < 8; k++) {
+                low[k] = static_cast<int>(counter + k);
+                high[k] = static_cast<int>((counter + k) >> 32);
+            }
+            input[12] = _mm256_set_epi32(low[7], low[6], low[5], low[4], low[3], low[2], low[1], low[0]);
+            input[13] = _mm256_set_epi32(high[7], high[6], high[5], high[4], high[3], high[2], high[1], high[0]);
+            __m256i x[16];
+            for (int i = 0; i < 16; i++) {
+                x[i] = input[i];
+            }
+            for (int round = 0; round < DOUBLE_ROUNDS; round++) {
+                quarterRound256(x[0], x[4], x[8], x[12]);
+                quarterRound256(x[1], x[5], x[9], x[13]);
+                quarterRound256(x[2], x[6], x[10], x[14]);
+                quarterRound256(x[3], x[7], x[11], x[15]);
+                quarterRound256(x[0], x[5], x[10], x[15]);
+                quarterRound256(x[1], x[6], x[11], x[12]);
+                quarterRound256(x[2], x[7], x[8], x[13]);
+                quarterRound256(x[3], x[4], x[9], x[14]);
+            }
+            // 在每个 128 位半边内按 SSE2 实现的方式转置：rows[g][k] 的低半边为第 k 块、
+            // 高半边为第 k + 4 块的第 4g ~ 4g+3 字，再两两拼接出各块的前、后 32 字节
+            __m256i rows[4][4];
+            for (int g = 0; g < 4; g++) {
+                __m256i a = _mm256_add_epi32(x[4 * g], input[4 * g]);
+                __m256i b = _mm256_add_epi32(x[4 * g + 1], input[4 * g + 1]);
+                __m256i c = _mm256_add_epi32(x[4 * g + 2], input[4 * g + 2]);
+                __m256i d = _mm256_add_epi32(x[4 * g + 3], input[4 * g + 3]);
+                __m256i t0 = _mm256_unpacklo_epi32(a, b);
+                __m256i t1 = _mm256_unpacklo_epi32(c, d);
+                __m256i t2 = _mm256_unpackhi_epi32(a, b);
+                __m256i t3 = _mm256_unpackhi_epi32(c, d);
+                rows[g][0] = _mm256_unpacklo_epi64(t0, t1);
+                rows[g][1] = _mm256_unpackhi_epi64(t0, t1);
+                rows[g][2] = _mm256_unpacklo_epi64(t2, t3);
+                rows[g][3] = _mm256_unpackhi_epi64(t2, t3);
+            }
+            for (int k = 0; k < 4; k++) {
+                __m256i blocks[4] = {_mm256_permute2x128_si256(rows[0][k], rows[1][k], 0x20),
+                                     _mm256_permute2x128_si256(rows[2][k], rows[3][k], 0x20),
+                                     _mm256_permute2x128_si256(rows[0][k], rows[1][k], 0x31),
+                                     _mm256_permute2x128_si256(rows[2][k], rows[3][k], 0x31)};
+                unsigned char *first = data + k * ChaCha20::BLOCK_SIZE;
+                unsigned char *second = data + (k + 4) * ChaCha20::BLOCK_SIZE;
+                __m256i *targets[4] = {reinterpret_cast<__m256i *>(first), reinterpret_cast<__m256i *>(first + 32),
+                                       reinterpret_cast<__m256i *>(second), reinterpret_cast<__m256i *>(second + 32)};
+                for (int i = 0; i < 4; i++) {
+                    _mm256_storeu_si256(targets[i], _mm256_xor_si256(_mm256_loadu_si256(targets[i]), blocks[i]));
+                }
+            }
+        }
+    }
+#endif
+
+    // 类: Sha256
+    // 用途: SHA-256 哈希（FIPS 180-4），仅用于派生密钥
+    class Sha256 {
+    public:
+        static constexpr std::size_t DIGEST_SIZE = 32;
+        static constexpr std::size_t BLOCK = 64;
+
+        void update(const uint8_t *data, std::size_t size) {
+            if (size == 0) {
+                return;
+            }
+            length += size;
+            if (buffered > 0) {
+                std::size_t step = std::min(size, BLOCK - buffered);
+                std::memcpy(buffer + buffered, data, step);
+                buffered += step;
+                data += step;
+                size -= step;
+                if (buffered < BLOCK) {
+                    return;
+                }
+                compress(buffer);
+                buffered = 0;
+            }
+            for (; size >= BLOCK; data += BLOCK, size -= BLOCK) {
+                compress(data);
+            }
+            std::memcpy(buffer, data, size);
+            buffered = size;
+        }
+
+        void finish(uint8_t *digest) {
+            uint64_t bits = length * 8;
+            uint8_t pad[BLOCK + 8] = {0x80};
+            std::size_t padSize = (buffered < 56 ? 56 : 120) - buffered;
+            for (int i = 0; i < 8; i++) {
+                pad[padSize + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+            }
+            update(pad, padSize + 8);
+            for (int i = 0; i < 8; i++) {
+                for (int j = 0; j < 4; j++) {
+                    digest[4 * i + j] = static_cast<uint8_t>(h[i] >> (24 - 8 * j));
+                }
+            }
+        }
+
+    private:
+        uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        uint8_t buffer[BLOCK] = {};
+        std::size_t buffered = 0;
+        uint64_t length = 0;
+
+        static inline uint32_t rotr(uint32_t x, int n) {
+            return (x >> n) | (x << (32 - n));
+        }
+
+        void compress(const uint8_t *block) {
+            static const uint32_t K[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+            uint32_t w[64];
+            for (int i = 0; i < 16; i++) {
+                w[i] = (static_cast<uint32_t>(block[4 * i]) << 24) | (static_cast<uint32_t>(block[4 * i + 1]) << 16) |
+                       (static_cast<uint32_t>(block[4 * i + 2]) << 8) | block[4 * i + 3];
+            }
+            for (int i = 16; i < 64; i++) {
+                uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+            for (int i = 0; i < 64; i++) {
+                uint32_t t1 = k + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                k = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+            h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+        }
+    };
+}
+
+namespace ChaCha20 {
+    // 函数: supported
+    // 用途: SSE2 是 x86-64 的基本指令集，AVX2 在运行时检测
+    bool supported(Implementation implementation) {
+        switch (implementation) {
+            case Implementation::SCALAR:
+                return true;
+#ifdef CHACHA20_X86
+            case Implementation::SSE2:
+                return true;
+            case Implementation::AVX2:
+                return __builtin_cpu_supports("avx2");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    Implementation detect() {
+        if (supported(Implementation::AVX2)) {
+            return Implementation::AVX2;
+        }
+        return supported(Implementation::SSE2) ? Implementation::SSE2 : Implementation::SCALAR;
+    }
+
+    const char *implementationName(Implementation implementation) {
+        switch (implementation) {
+            case Implementation::SSE2:
+                return "sse2";
+            case Implementation::AVX2:
+                return "avx2";
+            default:
+                return "scalar";
+        }
+    }
+
+    // 函数: deriveKey
+    // 用途: PBKDF2（RFC 8018）以 HMAC-SHA256 为伪随机函数，只需输出第一块（32 字节即密钥长度）。
+    //       HMAC 内外两层的密钥块只哈希一次，各次迭代从保存的中间状态继续
+    Key deriveKey(const std::string &passphrase, const uint8_t *salt, std::size_t saltSize, uint32_t iterations) {
+        uint8_t block[Sha256::BLOCK] = {};
+        if (passphrase.size() > Sha256::BLOCK) {
+            Sha256 hasher;
+            hasher.update(reinterpret_cast<const uint8_t *>(passphrase.data()), passphrase.size());
+            hasher.finish(block);
+        } else {
+            std::memcpy(block, passphrase.data(), passphrase.size());
+        }
+        uint8_t pad[Sha256::BLOCK];
+        Sha256 inner, outer;
+        for (std::size_t i = 0; i < Sha256::BLOCK; i++) {
+            pad[i] = block[i] ^ 0x36;
+        }
+        inner.update(pad, Sha256::BLOCK);
+        for (std::size_t i = 0; i < Sha256::BLOCK; i++) {
+            pad[i] = block[i] ^ 0x5c;
+        }
+        outer.update(pad, Sha256::BLOCK);
+        auto hmac = [&](const uint8_t *data, std::size_t size, const uint8_t *tail, std::size_t tailSize,
+                        uint8_t *out) {
+            Sha256 hasher = inner;
+            hasher.update(data, size);
+            hasher.update(tail, tailSize);
+            uint8_t digest[Sha256::DIGEST_SIZE];
+            hasher.finish(digest);
+            hasher = outer;
+            hasher.update(digest, sizeof(digest));
+            hasher.finish(out);
+        };
+
+        // U1 = HMAC(口令, 盐 || 块序号 1)，Ui = HMAC(口令, Ui-1)，密钥为各 Ui 的异或
+        const uint8_t index[4] = {0, 0, 0, 1};
+        uint8_t u[Sha256::DIGEST_SIZE];
+        hmac(salt, saltSize, index, sizeof(index), u);
+        Key key;
+        std::memcpy(key.data(), u, KEY_SIZE);
+        for (uint32_t i = 1; i < iterations; i++) {
+            hmac(u, sizeof(u), nullptr, 0, u);
+            for (std::size_t j = 0; j < KEY_SIZE; j++) {
+                key[j] ^= u[j];
+            }
+        }
+        return key;
+    }
+
+    // 函数: cachedKey
+    // 用途: 缓存为按最近使用排序的链表，超过 KEY_CACHE_SIZE 项时丢弃最久未使用的一项；
+    //       派生在锁外进行，多个线程同时未命中同一项时各自派生，结果相同
+    Key cachedKey(const std::string &passphrase, const uint8_t *salt, std::size_t saltSize, uint32_t iterations) {
+        struct Entry {
+            std::string passphrase;
+            std::vector<uint8_t> salt;
+            uint32_t iterations;
+            Key key;
+        };
+        constexpr std::size_t KEY_CACHE_SIZE = 8;
+        static std::mutex mutex;
+        static std::list<Entry> cache;
+        std::vector<uint8_t> saltBytes(salt, salt + saltSize);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = cache.begin(); it != cache.end(); ++it) {
+                if (it->iterations == iterations && it->salt == saltBytes && it->passphrase == passphrase) {
+                    cache.splice(cache.begin(), cache, it);
+                    return it->key;
+                }
+            }
+        }
+        Key key = deriveKey(passphrase, salt, saltSize, iterations);
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.push_front(Entry{passphrase, std::move(saltBytes), iterations, key});
+        if (cache.size() > KEY_CACHE_SIZE) {
+            cache.pop_back();
+        }
+        return key;
+    }
+
+    // 函数: Stream::Stream
+    // 用途: 初始状态：4 个常量字、8 个密钥字、2 个块计数器字、2 个随机数字（均为小端序）
+    Stream::Stream(const Key &key, uint64_t nonce, Implementation implementation)
+        : impl(supported(implementation) ? implementation : Implementation::SCALAR) {
+        state[0] = 0x61707865; // "expand 32-byte k"
+        state[1] = 0x3320646e;
+        state[2] = 0x79622d32;
+        state[3] = 0x6b206574;
+        for (int i = 0; i < 8; i++) {
+            state[4 + i] = loadLE32(key.data() + 4 * i);
+        }
+        state[12] = 0;
+        state[13] = 0;
+        state[14] = static_cast<uint32_t>(nonce);
+        state[15] = static_cast<uint32_t>(nonce >> 32);
+    }
+
+    // 函数: Stream::apply
+    // 用途: 先处理 offset 所在块的剩余部分，再按所选实现成组处理整块，最后逐块处理不足一组的部分
+    void Stream::apply(unsigned char *data, std::size_t size, uint64_t offset) const {
+        uint64_t counter = offset / BLOCK_SIZE;
+        std::size_t skip = static_cast<std::size_t>(offset % BLOCK_SIZE);
+        if (skip > 0 && size > 0) {
+            unsigned char block[BLOCK_SIZE];
+            keyBlock(state.data(), counter++, block);
+            std::size_t step = std::min(size, BLOCK_SIZE - skip);
+            for (std::size_t i = 0; i < step; i++) {
+                data[i] ^= block[skip + i];
+            }
+            data += step;
+            size -= step;
+        }
+#ifdef CHACHA20_X86
+        if (impl == Implementation::AVX2) {
+            std::size_t groups = size / (8 * BLOCK_SIZE);
+            xorAvx2(state.data(), counter, data, groups);
+            counter += 8 * groups;
+            data += groups * 8 * BLOCK_SIZE;
+            size -= groups * 8 * BLOCK_SIZE;
+        }
+        if (impl != Implementation::SCALAR) {
+            std::size_t groups = size / (4 * BLOCK_SIZE);
+            xorSse2(state.data(), counter, data, groups);
+            counter += 4 * groups;
+            data += groups * 4 * BLOCK_SIZE;
+            size -= groups * 4 * BLOCK_SIZE;
+        }
+#endif
+        xorScalar(state.data(), counter, data, size);
+    }
+}
@@ -0,0 +1,695 @@
+#include "ui.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <filesystem>
+#include <system_error>
+#include "archive.h"
+#include "common.h"
+#include "compressor.h"
+#include "decompressor.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 批处理操作（ARCHIVE、LIST、EXTRACT 操作多文件归档，见 archive.h；TRAIN 训练共享字典，见 dictionary.h）
+    enum class Operation { COMPRESS, DECOMPRESS, ARCHIVE, LIST, EXTRACT, TRAIN };
+
+    // 解压使用的解码方式
+    enum class Engine { TABLE, TRIE, HASH };
+
+    // 一个文件的处理参数（命令行中的收发人信息与密钥为默认值，清单文件中可逐个文件指定）
+    struct Job {
+        std::string path;         // 输入文件路径
+        std::string outputDir;    // 输出目录（输入为目录时保留其中的相对目录结构）
+        std::string senderInfo;   // 发送者信息
+        std::string receiverInfo; // 接收者信息
+        bool encrypt = false;     // 是否加密（解压时为是否解密）
+        std::string key;          // 密钥，为空时使用偏移量加密
+        uint64_t inputSize = 0;   // 输入文件字节数
+    };
+
+    // 命令行参数
+    struct Arguments {
+        Operation operation = Operation::COMPRESS;
+        Engine engine = Engine::TABLE;
+        Job defaults;                    // 默认的收发人信息、密钥与输出目录
+        std::vector<std::string> paths;  // 命令行中列出的文件与目录（归档操作时为成员名称）
+        std::string archive;             // 归档操作的归档文件
+        std::string dictionary;          // 共享字典文件（训练时为输出文件）
+        std::vector<std::string> manifests;
+        unsigned jobs = 0;               // 同时处理的文件数，0 表示硬件并发线程数
+        unsigned threads = 0;            // 单个文件内部的线程数，0 表示自动（见 threadsPerFile）
+        unsigned fileThreads = 1;        // 实际分给每个文件的线程数（由 threadsPerFile 确定）
+        std::size_t blockSize = 0;       // 压缩：分块模式的块大小
+        unsigned maxCodeLength = 0;      // 压缩：最长编码长度
+        bool contextModel = false;       // 压缩：一阶上下文模式
+        bool adaptiveBlocks = false;     // 压缩：自适应分块
+        LZ77::Level lzLevel = LZ77::Level::NONE; // 压缩：LZ77 前端的匹配查找策略
+        bool bwt = false;                // 压缩：BWT 变换模式
+        bool chacha20 = false;           // 压缩：以 ChaCha20 加密（密钥为口令）
+        Verbosity verbosity = Verbosity::QUIET; // 每个文件的控制台输出级别
+        std::string statsFile;           // 统计信息输出目标（"-" 表示标准错误输出）
+        Stats::Format statsFormat = Stats::JSON;
+        bool help = false;               // 只显示帮助信息
+    };
+
+    const char *USAGE =
+        "Usage: ProgramDesign                                  (interactive menu)\n"
+        "       ProgramDesign compress   [options] PATH...\n"
+        "       ProgramDesign decompress [options] PATH...\n"
+        "       ProgramDesign archive    [options] ARCHIVE PATH...\n"
+        "       ProgramDesign list       ARCHIVE\n"
+        "       ProgramDesign extract    [options] ARCHIVE [MEMBER...]\n"
+        "       ProgramDesign train      [options] DICTIONARY PATH...\n"
+        "\n"
+        "PATH may be a file or a directory; directories are searched recursively\n"
+        "(all regular files when compressing, *.hfm files when decompressing).\n"
+        "archive compresses PATHs into members of ARCHIVE (created if missing, appended to\n"
+        "otherwise), named by their path relative to the listed directory; list prints the\n"
+        "central directory; extract decompresses the named members (all by default) into -o DIR.\n"
+        "train builds a shared Huffman dictionary from the sample files in PATHs (-c trains\n"
+        "order-1 context tables, -l limits code lengths); files compressed with -D DICTIONARY\n"
+        "store only its ID instead of a code table and need the same -D to decompress.\n"
+        "\n"
+        "Options:\n"
+        "  -s, --sender INFO        sender information\n"
+        "  -r, --receiver INFO      receiver information\n"
+        "  -k, --key KEY            encrypt/decrypt with XOR key KEY\n"
+        "  -e, --encrypt            encrypt/decrypt with the offset cipher (no key)\n"
+        "  -x, --chacha20           compress: encrypt with ChaCha20 instead of XOR, KEY is a passphrase\n"
+        "                           (decompression detects the cipher from the file header)\n"
+        "  -m, --manifest FILE      read per-file parameters from FILE, one file per line:\n"
+        "                           PATH<TAB>SENDER<TAB>RECEIVER[<TAB>KEY]\n"
+        "                           KEY '-' disables encryption, '+' uses the offset cipher;\n"
+        "                           omitted columns use the command-line values\n"
+        "  -o, --output DIR         output directory (default: test/)\n"
+        "  -j, --jobs N             number of files processed in parallel (default: all cores)\n"
+        "      --threads N          threads used within each file: parallel blocks when compressing,\n"
+        "                           parallel sync-point segments and blocks when decompressing\n"
+        "                           (default: cores divided among the files processed in parallel)\n"
+        "  -b, --block-size BYTES   compress: independent blocks of BYTES bytes\n"
+        "  -a, --adaptive           compress: split blocks where the byte distribution changes\n"
+        "                           (-b then sets the largest block, default 4 MiB)\n"
+        "  -l, --max-code-length N  compress: limit Huffman codes to N bits\n"
+        "  -c, --context            compress: order-1 context model (code tables keyed by the previous byte)\n"
+        "  -z, --lz77 LEVEL         compress: LZ77 match finding before Huffman coding, LEVEL is\n"
+        "                           greedy, lazy or optimal (always uses blocks, default 4 MiB)\n"
+        "  -t, --bwt                compress: BWT + move-to-front + zero-run coding before Huffman\n"
+        "                           coding (always uses blocks, default 4 MiB)\n"
+        "  -D, --dictionary FILE    use the shared dictionary FILE (single code table mode only)\n"
+        "  -d, --decoder NAME       decompress: table (default), trie or hash\n"
+        "  -v, --verbose            print a summary of each file; repeat (-vv) for debug dumps\n"
+        "      --stats FILE         append per-phase timings and statistics of each file to\n"
+        "                           FILE ('-' for standard error)\n"
+        "      --stats-format FMT   statistics format: json (default, one object per line) or csv\n"
+        "  -h, --help               show this help\n";
+
+    // 函数: parseNumber
+    // 用途: 解析非负整数参数，格式错误时返回 false
+    bool parseNumber(const std::string &text, uint64_t &value) {
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        std::istringstream in(text);
+        return static_cast<bool>(in >> value);
+    }
+
+    // 函数: parseArguments
+    // 用途: 解析命令行参数（argv[1] 为操作名称）
+    //
+    // 返回:
+    //    参数合法（或要求显示帮助信息）返回 true；否则输出错误信息并返回 false
+    bool parseArguments(int argc, char *argv[], Arguments &args) {
+        std::string operation = argv[1];
+        if (operation == "-h" || operation == "--help") {
+            std::cout << USAGE;
+            args.help = true;
+            return true;
+        }
+        if (operation == "compress") {
+            args.operation = Operation::COMPRESS;
+        } else if (operation == "decompress") {
+            args.operation = Operation::DECOMPRESS;
+        } else if (operation == "archive") {
+            args.operation = Operation::ARCHIVE;
+        } else if (operation == "list") {
+            args.operation = Operation::LIST;
+        } else if (operation == "extract") {
+            args.operation = Operation::EXTRACT;
+        } else if (operation == "train") {
+            args.operation = Operation::TRAIN;
+        } else {
+            std::cerr << "Unknown operation: " << operation << std::endl << USAGE;
+            return false;
+        }
+        args.defaults.outputDir = Compressor::Options().outputDir;
+
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.empty() || arg[0] != '-' || arg == "-") {
+                args.paths.push_back(arg);
+                continue;
+            }
+            if (arg == "-h" || arg == "--help") {
+                std::cout << USAGE;
+                args.help = true;
+                return true;
+            }
+            if (arg == "-e" || arg == "--encrypt") {
+                args.defaults.encrypt = true;
+                continue;
+            }
+            if (arg == "-c" || arg == "--context") {
+                args.contextModel = true;
+                continue;
+            }
+            if (arg == "-a" || arg == "--adaptive") {
+                args.adaptiveBlocks = true;
+                continue;
+            }
+            if (arg == "-t" || arg == "--bwt") {
+                args.bwt = true;
+                continue;
+            }
+            if (arg == "-x" || arg == "--chacha20") {
+                args.chacha20 = true;
+                continue;
+            }
+            if (arg == "-v" || arg == "--verbose") {
+                if (args.verbosity < Verbosity::DEBUG) {
+                    args.verbosity = static_cast<Verbosity>(static_cast<int>(args.verbosity) + 1);
+                }
+                continue;
+            }
+            if (arg == "-vv") {
+                args.verbosity = Verbosity::DEBUG;
+                continue;
+            }
+            // 其余选项都带一个参数值
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for option " << arg << std::endl;
+                return false;
+            }
+            std::string value = argv[++i];
+            uint64_t number = 0;
+            if (arg == "-s" || arg == "--sender") {
+                args.defaults.senderInfo = value;
+            } else if (arg == "-r" || arg == "--receiver") {
+                args.defaults.receiverInfo = value;
+            } else if (arg == "-k" || arg == "--key") {
+                args.defaults.encrypt = true;
+                args.defaults.key = value;
+            } else if (arg == "-m" || arg == "--manifest") {
+                args.manifests.push_back(value);
+            } else if (arg == "-o" || arg == "--output") {
+                args.defaults.outputDir = value;
+            } else if (arg == "-D" || arg == "--dictionary") {
+                args.dictionary = value;
+            } else if ((arg == "-j" || arg == "--jobs") && parseNumber(value, number)) {
+                args.jobs = static_cast<unsigned>(number);
+            } else if (arg == "--threads" && parseNumber(value, number) && number > 0) {
+                args.threads = static_cast<unsigned>(number);
+            } else if ((arg == "-b" || arg == "--block-size") && parseNumber(value, number)) {
+                args.blockSize = static_cast<std::size_t>(number);
+            } else if ((arg == "-l" || arg == "--max-code-length") && parseNumber(value, number)) {
+                args.maxCodeLength = static_cast<unsigned>(number);
+            } else if ((arg == "-z" || arg == "--lz77") && LZ77::parseLevel(value, args.lzLevel)) {
+                // 匹配查找策略已由 parseLevel 写入
+            } else if (arg == "--stats") {
+                args.statsFile = value;
+            } else if (arg == "--stats-format" && (value == "json" || value == "csv")) {
+                args.statsFormat = value == "json" ? Stats::JSON : Stats::CSV;
+            } else if ((arg == "-d" || arg == "--decoder") && (value == "table" || value == "trie" || value == "hash")) {
+                args.engine = value == "table" ? Engine::TABLE : value == "trie" ? Engine::TRIE : Engine::HASH;
+            } else {
+                std::cerr << "Invalid option: " << arg << " " << value << std::endl;
+                return false;
+            }
+        }
+        // 归档操作的第一个路径为归档文件
+        bool archiveOperation = args.operation == Operation::ARCHIVE || args.operation == Operation::LIST ||
+                                args.operation == Operation::EXTRACT;
+        if (archiveOperation) {
+            if (args.paths.empty()) {
+                std::cerr << "No archive file" << std::endl << USAGE;
+                return false;
+            }
+            args.archive = args.paths.front();
+            args.paths.erase(args.paths.begin());
+        }
+        // 训练操作的第一个路径为输出的字典文件
+        if (args.operation == Operation::TRAIN) {
+            if (args.paths.empty()) {
+                std::cerr << "No dictionary file" << std::endl << USAGE;
+                return false;
+            }
+            args.dictionary = args.paths.front();
+            args.paths.erase(args.paths.begin());
+        }
+        if (args.paths.empty() && args.manifests.empty() &&
+            (args.operation == Operation::COMPRESS || args.operation == Operation::DECOMPRESS ||
+             args.operation == Operation::ARCHIVE || args.operation == Operation::TRAIN)) {
+            std::cerr << "No input files" << std::endl << USAGE;
+            return false;
+        }
+        if (args.contextModel && args.lzLevel != LZ77::Level::NONE) {
+            std::cerr << "Options -c and -z cannot be combined" << std::endl;
+            return false;
+        }
+        if (args.bwt && (args.contextModel || args.lzLevel != LZ77::Level::NONE)) {
+            std::cerr << "Option -t cannot be combined with -c or -z" << std::endl;
+            return false;
+        }
+        if (!args.dictionary.empty() && args.operation != Operation::TRAIN &&
+            (args.blockSize > 0 || args.adaptiveBlocks || args.bwt || args.lzLevel != LZ77::Level::NONE)) {
+            std::cerr << "Option -D cannot be combined with -b, -a, -z or -t" << std::endl;
+            return false;
+        }
+        // 清单文件可逐个文件指定密钥，未使用清单时须在命令行中给出密钥
+        if (args.chacha20 && args.defaults.key.empty() && args.manifests.empty()) {
+            std::cerr << "Option -x requires a key (-k)" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 函数: addPath
+    // 用途: 将一个文件或目录加入任务列表。目录递归查找其中的文件（解压时只取 .hfm 文件），
+    //       各文件的输出目录为 基础输出目录/该文件相对于输入目录的上级目录
+    //
+    // 参数:
+    //    path      - 文件或目录
+    //    base      - 任务模板（收发人信息、密钥、基础输出目录）
+    //    operation - 批处理操作
+    //    jobs      - 输出：任务列表
+    bool addPath(const std::string &path, const Job &base, Operation operation, std::vector<Job> &jobs) {
+        std::error_code ec;
+        auto addFile = [&](const fs::path &file, const std::string &outputDir) {
+            Job job = base;
+            job.path = file.string();
+            job.outputDir = outputDir;
+            job.inputSize = fs::file_size(file, ec);
+            jobs.push_back(job);
+        };
+        if (fs::is_regular_file(path, ec)) {
+            addFile(path, base.outputDir);
+            return true;
+        }
+        if (!fs::is_directory(path, ec)) {
+            std::cerr << "Error opening input file: " << path << std::endl;
+            return false;
+        }
+        std::vector<fs::path> files;
+        for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) {
+                continue;
+            }
+            if (operation == Operation::DECOMPRESS && it->path().extension() != ".hfm") {
+                continue;
+            }
+            files.push_back(it->path());
+        }
+        if (ec) {
+            std::cerr << "Error reading directory: " << path << std::endl;
+            return false;
+        }
+        // 按路径排序，使任务顺序与目录遍历顺序无关
+        std::sort(files.begin(), files.end());
+        for (const fs::path &file : files) {
+            fs::path relative = file.parent_path().lexically_relative(path);
+            std::string outputDir = base.outputDir;
+            if (!relative.empty() && relative != ".") {
+                outputDir = Common::joinPath(base.outputDir, relative.string());
+            }
+            addFile(file, outputDir);
+        }
+        return true;
+    }
+
+    // 函数: loadManifest
+    // 用途: 读取清单文件，每行一个文件或目录及其参数，以制表符分隔：
+    //       路径、发送者信息、接收者信息、密钥（"-" 表示不加密，"+" 表示偏移量加密）；
+    //       省略的列使用命令行中的值，空行与 '#' 开头的行忽略，相对路径相对于清单文件所在目录
+    bool loadManifest(const std::string &manifest, const Arguments &args, std::vector<Job> &jobs) {
+        std::ifstream in(manifest);
+        if (!in) {
+            std::cerr << "Error opening manifest file: " << manifest << std::endl;
+            return false;
+        }
+        fs::path directory = fs::path(manifest).parent_path();
+        std::string line;
+        int lineNumber = 0;
+        bool ok = true;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::vector<std::string> fields;
+            std::size_t begin = 0;
+            while (true) {
+                std::size_t tab = line.find('\t', begin);
+                fields.push_back(line.substr(begin, tab == std::string::npos ? std::string::npos : tab - begin));
+                if (tab == std::string::npos) {
+                    break;
+                }
+                begin = tab + 1;
+            }
+            if (fields.size() > 4 || fields[0].empty()) {
+                std::cerr << "Invalid manifest line " << lineNumber << ": " << manifest << std::endl;
+                ok = false;
+                continue;
+            }
+            Job base = args.defaults;
+            if (fields.size() > 1) {
+                base.senderInfo = fields[1];
+            }
+            if (fields.size() > 2) {
+                base.receiverInfo = fields[2];
+            }
+            if (fields.size() > 3) {
+                base.encrypt = fields[3] != "-";
+                base.key = fields[3] == "-" || fields[3] == "+" ? "" : fields[3];
+            }
+            fs::path path = fields[0];
+            if (path.is_relative()) {
+                path = directory / path;
+            }
+            ok = addPath(path.string(), base, args.operation, jobs) && ok;
+        }
+        return ok;
+    }
+
+    // 函数: outputFileOf
+    // 用途: 任务的输出文件路径（与压缩、解压模块的命名规则一致）
+    std::string outputFileOf(const Job &job, Operation operation) {
+        std::string suffix = operation == Operation::COMPRESS ? ".hfm" : "_j.txt";
+        return Common::joinPath(job.outputDir, Common::extractFileName(job.path) + suffix);
+    }
+
+    // 函数: threadsPerFile
+    // 用途: 单个文件内部使用的线程数：给出 --threads 时为该值；否则由同时处理的文件均分硬件并发线程
+    //       （文件数少于 -j 时各文件可使用更多线程，如只处理一个大文件时使用全部核心），至少为 1
+    //
+    // 参数:
+    //    args  - 命令行参数
+    //    files - 待处理的文件数
+    unsigned threadsPerFile(const Arguments &args, std::size_t files) {
+        if (args.threads > 0) {
+            return args.threads;
+        }
+        std::size_t workers = std::min<std::size_t>(ThreadPool::resolveThreads(args.jobs),
+                                                    std::max<std::size_t>(files, 1));
+        return std::max(1u, static_cast<unsigned>(ThreadPool::resolveThreads(0) / workers));
+    }
+
+    // 函数: compressOptions
+    // 用途: 由命令行参数构造一个文件的压缩选项（单个文件内部使用 args.fileThreads 个线程）
+    Compressor::Options compressOptions(const Arguments &args, const std::string &path) {
+        Compressor::Options options;
+        options.streaming = UI::useStreaming(path);
+        options.blockSize = args.blockSize;
+        options.threads = args.fileThreads;
+        options.syncInterval = UI::SYNC_INTERVAL;
+        options.maxCodeLength = args.maxCodeLength;
+        options.contextModel = args.contextModel;
+        options.adaptiveBlocks = args.adaptiveBlocks;
+        options.lzLevel = args.lzLevel;
+        options.bwt = args.bwt;
+        options.chacha20 = args.chacha20;
+        options.dictionaryFile = args.dictionary;
+        options.verbosity = args.verbosity;
+        options.statsFile = args.statsFile;
+        options.statsFormat = args.statsFormat;
+        return options;
+    }
+
+    // 函数: runJob
+    // 用途: 压缩或解压一个文件。批处理时并行发生在文件之间，单个文件内部使用 args.fileThreads 个线程
+    bool runJob(const Job &job, const Arguments &args) {
+        std::error_code ec;
+        fs::create_directories(job.outputDir, ec);
+        if (args.operation == Operation::COMPRESS) {
+            Compressor::Options options = compressOptions(args, job.path);
+            options.outputDir = job.outputDir;
+            return Compressor::compressFile(job.path, job.senderInfo, job.receiverInfo, job.encrypt, job.key, options);
+        }
+        Decompressor::Options options;
+        options.streaming = UI::useStreaming(job.path);
+        options.threads = args.fileThreads;
+        options.outputDir = job.outputDir;
+        options.dictionaryFile = args.dictionary;
+        options.verbosity = args.verbosity;
+        options.statsFile = args.statsFile;
+        options.statsFormat = args.statsFormat;
+        switch (args.engine) {
+        case Engine::TRIE:
+            return TrieDecompressor::decompressFile(job.path, job.senderInfo, job.receiverInfo, job.encrypt, job.key, options);
+        case Engine::HASH:
+            return HashDecompressor::decompressFile(job.path, job.senderInfo, job.receiverInfo, job.encrypt, job.key, options);
+        default:
+            return TableDecompressor::decompressFile(job.path, job.senderInfo, job.receiverInfo, job.encrypt, job.key, options);
+        }
+    }
+
+    // 函数: runArchive
+    // 用途: 归档操作：archive 收集文件（成员名称为相对于所列目录的路径）并追加到归档，
+    //       list 只读取中央目录并列出各成员，extract 按名称定位并解压成员（未列出名称时解压全部成员）
+    //
+    // 返回:
+    //    0 表示全部成功，1 表示有失败
+    int runArchive(Arguments args) {
+        auto startTime = std::chrono::steady_clock::now();
+        if (args.operation == Operation::ARCHIVE) {
+            // 输出目录为空时 addPath 得到的输出目录即相对目录，与文件名拼接为成员名称
+            args.defaults.outputDir.clear();
+            std::vector<Job> jobs;
+            bool ok = true;
+            for (const std::string &path : args.paths) {
+                ok = addPath(path, args.defaults, args.operation, jobs) && ok;
+            }
+            for (const std::string &manifest : args.manifests) {
+                ok = loadManifest(manifest, args, jobs) && ok;
+            }
+            std::vector<Archive::Input> inputs;
+            uint64_t inputBytes = 0;
+            for (const Job &job : jobs) {
+                std::string name = Common::joinPath(job.outputDir, fs::path(job.path).filename().string());
+                inputs.push_back(Archive::Input{job.path, name, job.senderInfo, job.receiverInfo, job.encrypt, job.key});
+                inputBytes += job.inputSize;
+            }
+            Compressor::Options options = compressOptions(args, args.archive);
+            options.streaming = false;
+            options.threads = args.jobs;
+            ok = ok && Archive::append(args.archive, inputs, options);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            std::error_code ec;
+            std::cout << (ok ? "OK    " : "FAIL  ") << args.archive << " (" << inputs.size() << " members, "
+                      << inputBytes << " bytes, archive " << fs::file_size(args.archive, ec) << " bytes, "
+                      << std::fixed << std::setprecision(3) << seconds << " s)" << std::defaultfloat << std::endl;
+            return ok ? 0 : 1;
+        }
+
+        Archive::Directory directory;
+        if (!directory.load(args.archive)) {
+            return 1;
+        }
+        if (args.operation == Operation::LIST) {
+            std::cout << std::setw(14) << "Original" << std::setw(14) << "Compressed" << "  CRC32C    Name" << std::endl;
+            uint64_t original = 0, compressed = 0;
+            for (const Archive::Entry &entry : directory.entries()) {
+                std::cout << std::setw(14) << entry.originalLength << std::setw(14) << entry.compressedSize << "  "
+                          << Common::hashToString(entry.checksum) << "  " << entry.name << std::endl;
+                original += entry.originalLength;
+                compressed += entry.compressedSize;
+            }
+            std::cout << std::setw(14) << original << std::setw(14) << compressed << "  "
+                      << directory.entries().size() << " members" << std::endl;
+            return 0;
+        }
+
+        std::vector<std::string> names = args.paths;
+        if (names.empty()) {
+            for (const Archive::Entry &entry : directory.entries()) {
+                names.push_back(entry.name);
+            }
+        }
+        // 成员依次解压，每个成员可使用全部线程
+        Decompressor::Options options;
+        options.threads = threadsPerFile(args, 1);
+        options.outputDir = args.defaults.outputDir;
+        options.dictionaryFile = args.dictionary;
+        options.verbosity = args.verbosity;
+        options.statsFile = args.statsFile;
+        options.statsFormat = args.statsFormat;
+        std::size_t failed = 0;
+        for (const std::string &name : names) {
+            const Job &job = args.defaults;
+            bool succeeded = Archive::extract(args.archive, directory, name, job.senderInfo, job.receiverInfo,
+                                              job.encrypt, job.key, options);
+            failed += succeeded ? 0 : 1;
+            std::cout << (succeeded ? "OK    " : "FAIL  ") << name;
+            if (succeeded) {
+                std::cout << " -> " << Common::joinPath(options.outputDir, name);
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "Members: " << names.size() - failed << " succeeded, " << failed << " failed" << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+
+    // 函数: runTrain
+    // 用途: 训练操作：收集各路径下的样本文件，训练共享字典并写出到 args.dictionary
+    //
+    // 返回:
+    //    0 表示成功，1 表示失败
+    int runTrain(const Arguments &args) {
+        auto startTime = std::chrono::steady_clock::now();
+        std::vector<Job> jobs;
+        bool ok = true;
+        for (const std::string &path : args.paths) {
+            ok = addPath(path, args.defaults, args.operation, jobs) && ok;
+        }
+        for (const std::string &manifest : args.manifests) {
+            ok = loadManifest(manifest, args, jobs) && ok;
+        }
+        std::vector<std::string> samples;
+        uint64_t inputBytes = 0;
+        for (const Job &job : jobs) {
+            samples.push_back(job.path);
+            inputBytes += job.inputSize;
+        }
+        Compressor::Options options = compressOptions(args, args.dictionary);
+        options.threads = args.jobs;
+        options.verbosity = std::max(args.verbosity, Verbosity::SUMMARY);
+        ok = ok && Compressor::trainDictionary(samples, options);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        std::cout << (ok ? "OK    " : "FAIL  ") << args.dictionary << " (" << samples.size() << " samples, "
+                  << inputBytes << " bytes, " << std::fixed << std::setprecision(3) << seconds << " s)"
+                  << std::defaultfloat << std::endl;
+        return ok ? 0 : 1;
+    }
+}
+
+// UI 类成员函数: runCommandLine
+// 用途: 命令行批处理入口：收集命令行与清单文件中的全部文件，提交到工作窃取线程池中
+//       并行压缩或解压（大小不一的文件由空闲线程相互窃取，不必等待最慢的线程），
+//       每完成一个文件输出一行结果，最后输出总数据量与总吞吐率
+//
+// 返回:
+//    0 表示全部成功，1 表示有文件处理失败，2 表示参数错误
+int UI::runCommandLine(int argc, char *argv[]) {
+    Arguments args;
+    if (!parseArguments(argc, argv, args)) {
+        return 2;
+    }
+    if (args.help) {
+        return 0;
+    }
+    if (args.operation == Operation::ARCHIVE || args.operation == Operation::LIST ||
+        args.operation == Operation::EXTRACT) {
+        return runArchive(args);
+    }
+    if (args.operation == Operation::TRAIN) {
+        return runTrain(args);
+    }
+
+    // 1. 收集任务：命令行中的路径使用命令行参数，清单文件中的路径使用各自的参数
+    std::vector<Job> jobs;
+    bool ok = true;
+    for (const std::string &path : args.paths) {
+        ok = addPath(path, args.defaults, args.operation, jobs) && ok;
+    }
+    for (const std::string &manifest : args.manifests) {
+        ok = loadManifest(manifest, args, jobs) && ok;
+    }
+
+    // 2. 不同输入映射到同一输出文件时（如同一目录下的 a.txt 与 a.md）只处理第一个，避免并发写同一文件
+    std::map<std::string, std::size_t> outputs;
+    std::vector<char> skipped(jobs.size(), 0);
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        auto inserted = outputs.emplace(outputFileOf(jobs[i], args.operation), i);
+        if (!inserted.second) {
+            std::cerr << "Output file conflict: " << jobs[i].path << " and "
+                      << jobs[inserted.first->second].path << " -> " << inserted.first->first << std::endl;
+            skipped[i] = 1;
+            ok = false;
+        }
+    }
+
+    // 3. 先提交大文件，尾部剩下的小文件便于空闲线程窃取，整体完成时间更均衡
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        if (!skipped[i]) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return jobs[a].inputSize > jobs[b].inputSize; });
+    args.fileThreads = threadsPerFile(args, order.size());
+
+    std::mutex outputMutex;
+    std::size_t failed = 0;
+    uint64_t inputBytes = 0, outputBytes = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(args.jobs);
+        for (std::size_t index : order) {
+            pool.submit([&, index]() {
+                const Job &job = jobs[index];
+                auto jobStart = std::chrono::steady_clock::now();
+                bool succeeded = runJob(job, args);
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - jobStart);
+                std::error_code ec;
+                uint64_t outputSize = succeeded ? fs::file_size(outputFileOf(job, args.operation), ec) : 0;
+
+                std::lock_guard<std::mutex> lock(outputMutex);
+                if (succeeded) {
+                    inputBytes += job.inputSize;
+                    outputBytes += outputSize;
+                } else {
+                    failed++;
+                }
+                std::cout << (succeeded ? "OK    " : "FAIL  ") << job.path;
+                if (succeeded) {
+                    std::cout << " -> " << outputFileOf(job, args.operation) << " (" << job.inputSize
+                              << " -> " << outputSize << " bytes, " << elapsed.count() << "ms)";
+                }
+                std::cout << std::endl;
+            });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // 4. 汇总：文件数、总数据量与吞吐率（按输入数据量计算）
+    std::size_t total = order.size();
+    std::cout << "********************************" << std::endl;
+    std::cout << "Files: " << total - failed << " succeeded, " << failed << " failed";
+    if (total < jobs.size()) {
+        std::cout << ", " << jobs.size() - total << " skipped";
+    }
+    std::cout << std::endl;
+    std::cout << "Input: " << inputBytes << " bytes, Output: " << outputBytes << " bytes";
+    if (inputBytes > 0) {
+        std::cout << std::fixed << std::setprecision(3)
+                  << ", Ratio: " << static_cast<double>(outputBytes) / inputBytes << std::defaultfloat;
+    }
+    std::cout << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "Elapsed: " << seconds << " s, Throughput: "
+              << (seconds > 0 ? inputBytes / seconds / (1 << 20) : 0.0) << " MB/s" << std::defaultfloat << std::endl;
+    std::cout << "********************************" << std::endl;
+    return ok && failed == 0 ? 0 : 1;
+}
@@ -1,6 +1,183 @@
 #include "common.h"
+#include "crc32c.h"
+#include "thread_pool.h"
+#include <array>
+#include <cstring>
+#include <numeric>
 #include <sstream>
 
+namespace {
+    // 子直方图个数：每次读取的 8 个字节分别计入不同的子直方图
+    constexpr int SUB_HISTOGRAMS = 8;
+
+    // 子直方图使用 32 位计数器（共 8 KB，可常驻 L1 缓存），
+    // 每处理 COUNT_CHUNK 个字节归并一次到 64 位计数，保证不会溢出
+    constexpr std::size_t COUNT_CHUNK = std::size_t(1) << 30;
+
+    // 每个线程至少分得的字节数，数据较小时线程调度的开销大于收益
+    constexpr std::size_t MIN_BYTES_PER_THREAD = std::size_t(4) << 20;
+
+    // 融合处理时每段的字节数：加密、统计与校验和依次处理同一段时，该段仍在 L1 缓存中
+    constexpr std::size_t FUSED_TILE = std::size_t(16) << 10;
+
+    // 异或密钥流的最短周期（字节），密钥很短时每次按整个周期处理，减少外层循环的次数
+    constexpr std::size_t MIN_KEY_PERIOD = 256;
+
+    // 类: SubHistograms
+    // 用途: 字节频率的子直方图，可分多次追加数据，最后归并到 64 位计数。每次读取 8 个字节，
+    //       各字节按位置计入各自的子直方图，连续相同的字节不会反复读写同一计数器
+    class SubHistograms {
+    public:
+        // 追加数据（任意长度）
+        void add(const unsigned char *data, std::size_t size) {
+            while (size > 0) {
+                if (pending == COUNT_CHUNK) {
+                    flush();
+                }
+                std::size_t step = std::min(size, COUNT_CHUNK - pending);
+                addChunk(data, step);
+                pending += step;
+                data += step;
+                size -= step;
+            }
+        }
+
+        // 将计数累加到 freq（256 项）
+        void mergeInto(uint64_t *freq) {
+            for (int value = 0; value < 256; value++) {
+                freq[value] += total[value];
+                for (int table = 0; table < SUB_HISTOGRAMS; table++) {
+                    freq[value] += sub[table][value];
+                }
+            }
+        }
+
+    private:
+        std::array<std::array<uint32_t, 256>, SUB_HISTOGRAMS> sub{};
+        std::array<uint64_t, 256> total{};
+        std::size_t pending = 0; // 子直方图中尚未归并的字节数
+
+        // 归并子直方图到 64 位计数，保证 32 位计数器不会溢出
+        void flush() {
+            for (int value = 0; value < 256; value++) {
+                for (int table = 0; table < SUB_HISTOGRAMS; table++) {
+                    total[value] += sub[table][value];
+                    sub[table][value] = 0;
+                }
+            }
+            pending = 0;
+        }
+
+        void addChunk(const unsigned char *data, std::size_t size) {
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                uint64_t word = 0;
+                for (int k = 7; k >= 0; k--) {
+                    word = (word << 8) | data[i + k];
+                }
+                sub[0][word & 0xFF]++;
+                sub[1][(word >> 8) & 0xFF]++;
+                sub[2][(word >> 16) & 0xFF]++;
+                sub[3][(word >> 24) & 0xFF]++;
+                sub[4][(word >> 32) & 0xFF]++;
+                sub[5][(word >> 40) & 0xFF]++;
+                sub[6][(word >> 48) & 0xFF]++;
+                sub[7][word >> 56]++;
+            }
+            for (; i < size; i++) {
+                sub[0][data[i]]++;
+            }
+        }
+    };
+
+    // 函数: countSerial
+    // 用途: 单线程统计任意长度数据的字节频率
+    void countSerial(const unsigned char *data, std::size_t size, uint64_t *freq) {
+        SubHistograms histogram;
+        histogram.add(data, size);
+        histogram.mergeInto(freq);
+    }
+
+    // 函数: encryptCountSerial
+    // 用途: 单线程的融合处理：逐段计算校验和、加密并统计字节频率
+    void encryptCountSerial(unsigned char *data, std::size_t size, uint64_t offset, const Common::Cipher *cipher,
+                            uint32_t *checksum, uint64_t *freq) {
+        SubHistograms histogram;
+        for (std::size_t done = 0; done < size; done += FUSED_TILE) {
+            std::size_t step = std::min(size - done, FUSED_TILE);
+            unsigned char *tile = data + done;
+            if (checksum) {
+                *checksum = CRC32C::update(*checksum, tile, step);
+            }
+            if (cipher) {
+                cipher->encrypt(tile, step, offset + done);
+            }
+            histogram.add(tile, step);
+        }
+        histogram.mergeInto(freq);
+    }
+
+    // 函数: countPairsSerial
+    // 用途: 单线程统计一阶频率，previous 为 data[0] 的上下文；
+    //       位于 resetInterval 整数倍处的字节以 0 为上下文（resetInterval 为 0 时不重置）
+    void countPairsSerial(const unsigned char *data, std::size_t size, unsigned previous, uint64_t offset,
+                          uint64_t resetInterval, uint64_t *freq) {
+        std::size_t done = 0;
+        while (done < size) {
+            std::size_t step = size - done;
+            if (resetInterval > 0) {
+                uint64_t phase = (offset + done) % resetInterval;
+                if (phase == 0) {
+                    previous = 0;
+                }
+                step = static_cast<std::size_t>(std::min<uint64_t>(step, resetInterval - phase));
+            }
+            const unsigned char *p = data + done;
+            for (std::size_t i = 0; i < step; i++) {
+                freq[(previous << 8) | p[i]]++;
+                previous = p[i];
+            }
+            done += step;
+        }
+    }
+
+    // 函数: encryptCountPairsSerial
+    // 用途: 单线程的融合处理：逐段计算校验和、加密并统计一阶频率，previous 返回最后一个字节
+    void encryptCountPairsSerial(unsigned char *data, std::size_t size, uint64_t offset, const Common::Cipher *cipher,
+                                 uint32_t *checksum, unsigned char &previous, uint64_t resetInterval, uint64_t *freq) {
+        for (std::size_t done = 0; done < size; done += FUSED_TILE) {
+            std::size_t step = std::min(size - done, FUSED_TILE);
+            unsigned char *tile = data + done;
+            if (checksum) {
+                *checksum = CRC32C::update(*checksum, tile, step);
+            }
+            if (cipher) {
+                cipher->encrypt(tile, step, offset + done);
+            }
+            countPairsSerial(tile, step, previous, offset + done, resetInterval, freq);
+            previous = tile[step - 1];
+        }
+    }
+
+    // 函数: partCount
+    // 用途: 按线程数与数据大小确定并行统计的段数
+    std::size_t partCount(std::size_t size, unsigned threads) {
+        return std::min<std::size_t>(ThreadPool::resolveThreads(threads), size / MIN_BYTES_PER_THREAD);
+    }
+
+    // 函数: combineParts
+    // 用途: 将并行处理时各段（自 0 起计算）的校验和按顺序合并到 checksum
+    void combineParts(uint32_t *checksum, const std::vector<uint32_t> &partial, std::size_t size, std::size_t partSize) {
+        if (!checksum) {
+            return;
+        }
+        for (std::size_t part = 0; part < partial.size(); part++) {
+            std::size_t begin = part * partSize;
+            *checksum = CRC32C::combine(*checksum, partial[part], std::min(size, begin + partSize) - begin);
+        }
+    }
+}
+
 namespace Common {
     // 函数: encrypt
     // 用途: 对数据进行加密，可采用两种方式：
@@ -11,19 +188,7 @@ namespace Common {
 //    data - 待加密数据的字节数组
 //    key  - 加密密钥（如果为空则使用偏移加密）
     void encrypt(std::vector<unsigned char> &data, const std::string &key) {
-        if (key.empty()) {
-            // 用偏移量加密
-            for (unsigned char &b : data) {
-                b += 0x55;
-            }
-        } else {
-            // 用异或法加密
-            int index = 0;
-            for (unsigned char &b : data) {
-                b ^= key[index];
-                index = (index + 1) % key.size();
-            }
-        }
+        encrypt(data.data(), data.size(), key, 0);
     }
     
     // 函数: decrypt
@@ -33,21 +198,319 @@ namespace Common {
 //    data - 待解密数据的字节数组
 //    key  - 解密密钥（如果为空则使用偏移解密）
     void decrypt(std::vector<unsigned char> &data, const std::string &key) {
-        if (key.empty()) {
-            // 用偏移量解密
-            for (unsigned char &b : data) {
-                b -= 0x55;
+        decrypt(data.data(), data.size(), key, 0);
+    }
+
+    // 函数: encrypt（分块版本）
+    // 用途: 对数据流中的一块进行加密，结果与对整个数据流一次性加密相同
+    //
+    // 参数:
+//    data   - 待加密数据块起始地址
+//    size   - 数据块字节数
+//    key    - 加密密钥（如果为空则使用偏移加密）
+//    offset - 数据块在整个数据流中的起始位置
+    void encrypt(unsigned char *data, std::size_t size, const std::string &key, uint64_t offset) {
+        Cipher(key).encrypt(data, size, offset);
+    }
+
+    // 函数: decrypt（分块版本）
+    // 用途: 对数据流中的一块进行解密，参数含义与分块加密相同
+    void decrypt(unsigned char *data, std::size_t size, const std::string &key, uint64_t offset) {
+        Cipher(key).decrypt(data, size, offset);
+    }
+
+    // 函数: Cipher::Cipher
+    // 用途: 异或加密时展开密钥流：周期取密钥长度与 8 的最小公倍数（不足 MIN_KEY_PERIOD 时取其整数倍），
+    //       从任一密钥下标起连续读出一个周期的字节即为该位置起的密钥，且周期的整数倍处密钥下标不变
+    Cipher::Cipher(const std::string &key) : keySize(key.size()), period(0) {
+        if (keySize == 0) {
+            return;
+        }
+        std::size_t base = keySize / std::gcd(keySize, std::size_t(8)) * 8;
+        period = (MIN_KEY_PERIOD + base - 1) / base * base;
+        stream.resize(period + keySize - 1);
+        for (std::size_t i = 0; i < stream.size(); i++) {
+            stream[i] = static_cast<unsigned char>(key[i % keySize]);
+        }
+    }
+
+    // 函数: Cipher::Cipher
+    // 用途: ChaCha20 加密时不展开异或密钥流，加密与解密都交给 ChaCha20::Stream
+    Cipher::Cipher(const std::string &passphrase, const uint8_t *salt, std::size_t saltSize, uint32_t iterations,
+                   uint64_t nonce)
+        : keySize(0), period(0),
+          chacha(ChaCha20::Stream(ChaCha20::cachedKey(passphrase, salt, saltSize, iterations), nonce)) {}
+
+    void Cipher::encrypt(unsigned char *data, std::size_t size, uint64_t offset, unsigned threads) const {
+        cryptParallel(data, size, offset, false, threads);
+    }
+
+    void Cipher::decrypt(unsigned char *data, std::size_t size, uint64_t offset, unsigned threads) const {
+        cryptParallel(data, size, offset, true, threads);
+    }
+
+    // 函数: Cipher::crypt
+    // 用途: 偏移量加密时每个字节加上 0x55（解密时减去）；异或加密见 applyKey，
+    //       ChaCha20 加密时与数据流该位置起的密钥流异或（异或本身可逆，解密与加密相同）
+    void Cipher::crypt(unsigned char *data, std::size_t size, uint64_t offset, bool inverse) const {
+        if (chacha) {
+            chacha->apply(data, size, offset);
+        } else if (keySize == 0) {
+            unsigned char delta = inverse ? static_cast<unsigned char>(0x100 - 0x55) : 0x55;
+            for (std::size_t i = 0; i < size; i++) {
+                data[i] += delta;
             }
         } else {
-            // 用异或法解密（异或本身可逆）
-            int index = 0;
-            for (unsigned char &b : data) {
-                b ^= key[index];
-                index = (index + 1) % key.size();
+            applyKey(data, size, offset);
+        }
+    }
+
+    // 函数: Cipher::cryptParallel
+    // 用途: 数据足够大时切分为多段并行处理，各段的密钥位置由其在数据流中的位置确定，与顺序处理结果相同
+    void Cipher::cryptParallel(unsigned char *data, std::size_t size, uint64_t offset, bool inverse,
+                               unsigned threads) const {
+        std::size_t parts = partCount(size, threads);
+        if (parts <= 1) {
+            crypt(data, size, offset, inverse);
+            return;
+        }
+        std::size_t partSize = (size + parts - 1) / parts;
+        ThreadPool pool(static_cast<unsigned>(parts));
+        pool.parallelFor(parts, [&](std::size_t part) {
+            std::size_t begin = part * partSize;
+            std::size_t end = std::min(size, begin + partSize);
+            crypt(data + begin, end - begin, offset + begin, inverse);
+        });
+    }
+
+    // 函数: Cipher::applyKey
+    // 用途: 与密钥流按 64 位字异或：每次处理一个周期，各周期的密钥都从同一下标开始
+    void Cipher::applyKey(unsigned char *data, std::size_t size, uint64_t offset) const {
+        const unsigned char *keys = stream.data() + offset % keySize;
+        for (std::size_t done = 0; done < size; done += period) {
+            std::size_t step = std::min(size - done, period);
+            unsigned char *p = data + done;
+            std::size_t i = 0;
+            for (; i + 8 <= step; i += 8) {
+                uint64_t word, mask;
+                std::memcpy(&word, p + i, 8);
+                std::memcpy(&mask, keys + i, 8);
+                word ^= mask;
+                std::memcpy(p + i, &word, 8);
+            }
+            for (; i < step; i++) {
+                p[i] ^= keys[i];
+            }
+        }
+    }
+
+    // 函数: encryptAndCount
+    // 用途: 融合的校验和、加密与字节频率统计。数据足够大时切分为多段并行处理，
+    //       各段的密钥下标由其在数据流中的位置确定，各段的校验和按顺序合并，与顺序处理结果相同
+    //
+    // 参数:
+//    data     - 数据起始地址（加密时原地修改）
+//    size     - 数据字节数
+//    offset   - data 在整个数据流中的起始位置
+//    cipher   - 加密器，为空表示不加密
+//    checksum - 输入输出：加密前数据的校验和（CRC32C），为空表示不计算
+//    freq     - 输出：各字节值的出现次数（累加）
+//    threads  - 线程数（1 表示单线程，0 表示硬件并发线程数）
+    void encryptAndCount(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                         uint32_t *checksum, std::vector<uint64_t> &freq, unsigned threads) {
+        if (freq.size() < 256) {
+            freq.resize(256, 0);
+        }
+        std::size_t parts = partCount(size, threads);
+        if (parts <= 1) {
+            encryptCountSerial(data, size, offset, cipher, checksum, freq.data());
+            return;
+        }
+        std::vector<std::array<uint64_t, 256>> partial(parts);
+        std::vector<uint32_t> partialChecksums(parts, 0);
+        std::size_t partSize = (size + parts - 1) / parts;
+        ThreadPool pool(static_cast<unsigned>(parts));
+        pool.parallelFor(parts, [&](std::size_t part) {
+            partial[part].fill(0);
+            std::size_t begin = part * partSize;
+            std::size_t end = std::min(size, begin + partSize);
+            encryptCountSerial(data + begin, end - begin, offset + begin, cipher,
+                               checksum ? &partialChecksums[part] : nullptr, partial[part].data());
+        });
+        combineParts(checksum, partialChecksums, size, partSize);
+        for (const std::array<uint64_t, 256> &counts : partial) {
+            for (int value = 0; value < 256; value++) {
+                freq[value] += counts[value];
             }
         }
     }
+
+    // 函数: encryptAndCountPairs
+    // 用途: 融合的校验和、加密与一阶频率统计，参数含义与 encryptAndCount、countPairs 相同。
+    //       并行处理时各段的上下文（前一段的最后一个字节）在开始前先单独加密得到，避免读到另一线程正在加密的数据
+    void encryptAndCountPairs(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                              uint32_t *checksum, unsigned char &previous, uint64_t resetInterval,
+                              std::vector<uint64_t> &freq, unsigned threads) {
+        if (freq.size() < 65536) {
+            freq.resize(65536, 0);
+        }
+        if (size == 0) {
+            return;
+        }
+        std::size_t parts = partCount(size, threads);
+        if (parts <= 1) {
+            encryptCountPairsSerial(data, size, offset, cipher, checksum, previous, resetInterval, freq.data());
+            return;
+        }
+        std::size_t partSize = (size + parts - 1) / parts;
+        std::vector<unsigned char> contexts(parts, previous);
+        for (std::size_t part = 1; part < parts; part++) {
+            std::size_t last = part * partSize - 1;
+            contexts[part] = data[last];
+            if (cipher) {
+                cipher->encrypt(&contexts[part], 1, offset + last);
+            }
+        }
+        std::vector<std::vector<uint64_t>> partial(parts);
+        std::vector<uint32_t> partialChecksums(parts, 0);
+        ThreadPool pool(static_cast<unsigned>(parts));
+        pool.parallelFor(parts, [&](std::size_t part) {
+            partial[part].assign(65536, 0);
+            std::size_t begin = part * partSize;
+            std::size_t end = std::min(size, begin + partSize);
+            encryptCountPairsSerial(data + begin, end - begin, offset + begin, cipher,
+                                    checksum ? &partialChecksums[part] : nullptr, contexts[part],
+                                    resetInterval, partial[part].data());
+        });
+        combineParts(checksum, partialChecksums, size, partSize);
+        for (const std::vector<uint64_t> &counts : partial) {
+            for (std::size_t i = 0; i < 65536; i++) {
+                freq[i] += counts[i];
+            }
+        }
+        previous = data[size - 1];
+    }
+
+    // 函数: checksumAndEncrypt
+    // 用途: 融合的校验和与加密，每段先计算校验和再加密，数据只读写一遍
+    void checksumAndEncrypt(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                            uint32_t *checksum) {
+        for (std::size_t done = 0; done < size; done += FUSED_TILE) {
+            std::size_t step = std::min(size - done, FUSED_TILE);
+            if (checksum) {
+                *checksum = CRC32C::update(*checksum, data + done, step);
+            }
+            if (cipher) {
+                cipher->encrypt(data + done, step, offset + done);
+            }
+        }
+    }
+
+    // 函数: decryptAndChecksum
+    // 用途: 融合的解密与校验和：逐段解密后立即计算该段的校验和
+    //
+    // 参数:
+//    data     - 数据起始地址（解密时原地修改）
+//    size     - 数据字节数
+//    offset   - data 在整个数据流中的起始位置
+//    cipher   - 解密器，为空表示不解密
+//    checksum - 输入输出：解密后数据的校验和（CRC32C），为空表示不计算
+    void decryptAndChecksum(unsigned char *data, std::size_t size, uint64_t offset, const Cipher *cipher,
+                            uint32_t *checksum) {
+        if (!checksum) {
+            if (cipher) {
+                cipher->decrypt(data, size, offset);
+            }
+            return;
+        }
+        for (std::size_t done = 0; done < size; done += FUSED_TILE) {
+            std::size_t step = std::min(size - done, FUSED_TILE);
+            if (cipher) {
+                cipher->decrypt(data + done, step, offset + done);
+            }
+            *checksum = CRC32C::update(*checksum, data + done, step);
+        }
+    }
     
+    // 函数: countBytes
+    // 用途: 统计字节频率，结果累加到 freq（不足 256 项时先扩展）
+    //
+    // 参数:
+//    data    - 数据起始地址
+//    size    - 数据字节数
+//    freq    - 输出：各字节值的出现次数
+//    threads - 线程数（1 表示单线程，0 表示硬件并发线程数）
+    void countBytes(const unsigned char *data, std::size_t size, std::vector<uint64_t> &freq, unsigned threads) {
+        if (freq.size() < 256) {
+            freq.resize(256, 0);
+        }
+        std::size_t parts = partCount(size, threads);
+        if (parts <= 1) {
+            countSerial(data, size, freq.data());
+            return;
+        }
+        // 各线程统计各自的一段，再归并各段的直方图
+        std::vector<std::array<uint64_t, 256>> partial(parts);
+        std::size_t partSize = (size + parts - 1) / parts;
+        ThreadPool pool(static_cast<unsigned>(parts));
+        pool.parallelFor(parts, [&](std::size_t part) {
+            partial[part].fill(0);
+            std::size_t begin = part * partSize;
+            std::size_t end = std::min(size, begin + partSize);
+            countSerial(data + begin, end - begin, partial[part].data());
+        });
+        for (const std::array<uint64_t, 256> &counts : partial) {
+            for (int value = 0; value < 256; value++) {
+                freq[value] += counts[value];
+            }
+        }
+    }
+
+    // 函数: countPairs
+    // 用途: 统计一阶（以前一字节为上下文）频率，结果累加到 freq（不足 65536 项时先扩展），
+    //       下标为 上下文 * 256 + 字节值
+    //
+    // 参数:
+//    data          - 数据起始地址
+//    size          - 数据字节数
+//    previous      - 输入：data[0] 的上下文（即数据流中的前一字节）；输出：data 的最后一个字节
+//    offset        - data 在整个数据流中的起始位置
+//    resetInterval - 位于其整数倍处的字节以 0 为上下文（与同步点一致），0 表示不重置
+//    freq          - 输出：各（上下文, 字节值）的出现次数
+//    threads       - 线程数（1 表示单线程，0 表示硬件并发线程数）
+    void countPairs(const unsigned char *data, std::size_t size, unsigned char &previous, uint64_t offset,
+                    uint64_t resetInterval, std::vector<uint64_t> &freq, unsigned threads) {
+        if (freq.size() < 65536) {
+            freq.resize(65536, 0);
+        }
+        if (size == 0) {
+            return;
+        }
+        std::size_t parts = partCount(size, threads);
+        if (parts <= 1) {
+            countPairsSerial(data, size, previous, offset, resetInterval, freq.data());
+        } else {
+            // 数据已全部在内存中，各段的上下文即该段之前的一个字节，可独立统计后归并
+            std::vector<std::vector<uint64_t>> partial(parts);
+            std::size_t partSize = (size + parts - 1) / parts;
+            ThreadPool pool(static_cast<unsigned>(parts));
+            pool.parallelFor(parts, [&](std::size_t part) {
+                partial[part].assign(65536, 0);
+                std::size_t begin = part * partSize;
+                std::size_t end = std::min(size, begin + partSize);
+                unsigned context = begin == 0 ? previous : data[begin - 1];
+                countPairsSerial(data + begin, end - begin, context, offset + begin, resetInterval,
+                                 partial[part].data());
+            });
+            for (const std::vector<uint64_t> &counts : partial) {
+                for (std::size_t i = 0; i < 65536; i++) {
+                    freq[i] += counts[i];
+                }
+            }
+        }
+        previous = data[size - 1];
+    }
+
     // 函数: extractFileName
     // 用途: 从完整的文件路径中提取文件的基本名称（不包含路径和扩展名）
     //
@@ -61,6 +524,22 @@ namespace Common {
         int dot_pos = filename.find_last_of('.');
         return filename.substr(slash_pos + 1, dot_pos - slash_pos - 1);
     }
+
+    // 函数: joinPath
+    // 用途: 将目录与文件名拼接为路径，目录为空时返回文件名本身
+    //
+    // 参数:
+//    directory - 目录（可以以 '/' 结尾）
+//    fileName  - 文件名
+    std::string joinPath(const std::string &directory, const std::string &fileName) {
+        if (directory.empty()) {
+            return fileName;
+        }
+        if (directory.back() == '/') {
+            return directory + fileName;
+        }
+        return directory + "/" + fileName;
+    }
     
     // 函数: hexToBinary
     // 用途: 将十六进制字符串转换为对应的二进制字符串（每个十六进制字符转换为4位二进制）
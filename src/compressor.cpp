@@ -1,6 +1,20 @@
 #include "compressor.h"
+#include "bwt.h"
+#include "chacha20.h"
 #include "common.h"
+#include "crc32c.h"
+#include "dictionary.h"
+#include "format.h"
+#include "huffman.h"
+#include "lz77.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
+#include <memory>
+#include <random>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -11,292 +25,1601 @@
 
 // 使用匿名命名空间封装内部辅助函数，这样避免外部直接调用
 namespace {
-    // 函数: getHuffmanCode
-    // 作用: 遍历哈夫曼树并生成各字节对应的哈夫曼编码
+    // 函数: getCodeLength
+    // 作用: 遍历哈夫曼树，记录各字节对应叶子节点的深度，即其哈夫曼编码长度
     //
     // 参数:
-//    root      - 当前节点指针
-//    code      - 当前路径编码（由 "0" 和 "1" 组成）
-//    codeTable - 编码表数组，索引为字节值，值为该字节的编码字符串
-    void getHuffmanCode(Compressor::Node *root, const std::string &code, std::vector<std::string> &codeTable) {
-        if (!root) {
+//    tree        - 哈夫曼树节点池
+//    root        - 当前节点下标
+//    depth       - 当前节点的深度
+//    codeLengths - 编码长度数组，索引为字节值
+    void getCodeLength(const Compressor::NodePool &tree, uint16_t root, int depth, std::vector<uint8_t> &codeLengths) {
+        const Compressor::Node &node = tree[root];
+        // 如果为叶子节点，则保存该字节的编码长度
+        // 只有一种字节时树根即为叶子，为其分配 1 位编码
+        if (node.isLeaf()) {
+            codeLengths[node.symbol] = static_cast<uint8_t>(std::max(depth, 1));
             return;
         }
-        // 如果为叶子节点，则保存该字节的编码
-        if (!root->left && !root->right) {
-            codeTable[root->byteVal] = code;
-            return;
+        getCodeLength(tree, node.left, depth + 1, codeLengths);
+        getCodeLength(tree, node.right, depth + 1, codeLengths);
+    }
+
+    // 函数: maxDepth
+    // 作用: 计算哈夫曼树的最大深度，即最长编码的位数
+    int maxDepth(const Compressor::NodePool &tree, uint16_t root) {
+        const Compressor::Node &node = tree[root];
+        if (node.isLeaf()) {
+            return 0;
         }
-        // 递归遍历左子树（编码末尾加 "0"）
-        getHuffmanCode(root->left, code + "0", codeTable);
-        // 递归遍历右子树（编码末尾加 "1"）
-        getHuffmanCode(root->right, code + "1", codeTable);
+        return 1 + std::max(maxDepth(tree, node.left), maxDepth(tree, node.right));
     }
     
     // 函数: computeWPL
     // 作用: 计算哈夫曼树的带权路径长度（WPL），即各叶子节点频率与其深度乘积的和
     //
     // 参数:
-//    root  - 当前节点指针
+//    tree  - 哈夫曼树节点池
+//    root  - 当前节点下标
 //    depth - 当前节点的深度
 //    wpl   - 累积的带权路径长度
-    void computeWPL(Compressor::Node *root, int depth, int &wpl) {
-        if (!root) {
-            return;
-        }
+    void computeWPL(const Compressor::NodePool &tree, uint16_t root, int depth, uint64_t &wpl) {
+        const Compressor::Node &node = tree[root];
         // 如果为叶子节点，累加贡献值
-        if (!root->left && !root->right) {
-            wpl += root->freq * depth;
+        if (node.isLeaf()) {
+            wpl += node.freq * depth;
             return;
         }
         // 递归统计左右子树
-        computeWPL(root->left, depth + 1, wpl);
-        computeWPL(root->right, depth + 1, wpl);
+        computeWPL(tree, node.left, depth + 1, wpl);
+        computeWPL(tree, node.right, depth + 1, wpl);
     }
-    
-    // 函数: deleteTree
-    // 作用: 递归释放整个哈夫曼树中分配的内存
-    void deleteTree(Compressor::Node *root) {
-        if (!root) {
-            return;
-        }
-        deleteTree(root->left);
-        deleteTree(root->right);
-        delete root;
-    }
-}
 
-namespace Compressor {
-    // 辅助结构体: EncodedData
-    // 用于存储每个字节的编码结果，包括原始字节、本编码长度及按8位分组的编码字节数组
-    struct EncodedData {
-        unsigned char byteCode;              // 对应字节
-        int length;                          // 编码位数
-        std::vector<unsigned char> bitCoded; // 存放编码得到的字节数组（每8位为1字节）
-    };
-    
-    // 函数: compressFile
-    // 用途: 对指定文件进行压缩，执行以下主要步骤：
-    //       1. 读取原文件内容
-    //       2. 插入发送者和接收者信息到文件内容中
-    //       3. 若需要，对数据进行加密处理
-    //       4. 统计各字节出现频率
-    //       5. 构建哈夫曼树，并生成对应的编码表
-    //       6. 计算原始数据的 HASH 值
-    //       7. 输出编码表到 code.txt 文件
-    //       8. 根据哈夫曼编码生成压缩数据（按位打包）
-    //       9. 计算压缩数据的 HASH 值，并写入压缩文件
-    //       10. 显示压缩数据的最后16个字节（调试信息）
-    //       11. 释放哈夫曼树所占内存
+    // 函数: buildCodeLengths
+    // 作用: 由字节频率构建哈夫曼树并得到各字节的编码长度，主要步骤：
+    //       1. 构造出现的字节节点数组，并用堆排序按频率排序后显示
+    //       2. 使用小根堆不断合并节点，构建哈夫曼树
+    //       3. 计算并显示哈夫曼树的带权路径长度（WPL）
+    //       4. 遍历哈夫曼树得到各字节的编码长度；
+    //          若哈夫曼树深度超过长度限制，改用包合并算法构造限长的最优编码长度，并显示 WPL 的增加量
     //
     // 参数:
-//    inputFile    - 输入文件路径
-//    senderInfo   - 发送者信息
-//    receiverInfo - 接收者信息
-//    encrypt      - 是否启用加密（默认为 false）
-//    key          - 加密密钥（默认为空字符串）
-    void compressFile(const std::string &inputFile,
-                      const std::string &senderInfo,
-                      const std::string &receiverInfo,
-                      bool encrypt,
-                      const std::string &key) {
-        // 1. 读取文件内容到 vector 中
-        std::ifstream inFile(inputFile, std::ios::binary);
-        if (!inFile) {
-            std::cerr << "Error opening input file: " << inputFile << std::endl;
-            return;
-        }
-        std::vector<unsigned char> content((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
-        inFile.close();
-        
-        // 2. 插入扩展信息：发送者信息和接收者信息，并以换行符分隔
-        std::vector<unsigned char> tempContent;
-        if (!senderInfo.empty()) {
-            tempContent.insert(tempContent.end(), senderInfo.begin(), senderInfo.end());
-            tempContent.push_back('\n');
-        }
-        if (!receiverInfo.empty()) {
-            tempContent.insert(tempContent.end(), receiverInfo.begin(), receiverInfo.end());
-            tempContent.push_back('\n');
-        }
-        // 插入原始文件内容
-        tempContent.insert(tempContent.end(), content.begin(), content.end());
-
-        // 3. 将插入扩展信息后的数据写回原文件（覆盖原数据）
-        std::ofstream newinputFile(inputFile, std::ios::binary);
-        if (!newinputFile) {
-            std::cerr << "Error opening output file: " << inputFile << std::endl;
-            return;
-        }
-        newinputFile.write(reinterpret_cast<const char*>(tempContent.data()), tempContent.size());
-        newinputFile.close();
-
-        std::vector<unsigned char> processedContent = tempContent;
-        // 4. 如果启用了加密，则对数据进行加密处理
-        if (encrypt) {
-            Common::encrypt(processedContent, key);
-        }
-
-        // 5. 统计各字节出现频率
-        std::vector<int> freq(256, 0);
-        for (unsigned char c : processedContent) {
-            freq[c]++;
-        }
-        
-        // 6. 构造出现的字节节点数组，用于构建哈夫曼树
+//    freq        - 各字节出现频率（LZ77 模式下为字面量/长度符号或距离符号的出现次数，下标为符号值）
+//    codeLengths - 输出：各字节的编码长度（未出现的字节为 0），项数与 freq 相同
+//    maxLength   - 最长编码长度，0 表示不限制（仍不超过 Huffman::MAX_CODE_LENGTH）
+//    verbose     - 是否显示词频统计表与 WPL（分块模式下各块不显示）
+//    stats       - 统计信息收集器（可为空）：记录排序、建树、生成编码长度的耗时以及 WPL
+    //
+    // 返回:
+    //    成功返回 true；出现的字节种数超过 2^maxLength 时返回 false
+    bool buildCodeLengths(const std::vector<uint64_t> &freq, std::vector<uint8_t> &codeLengths,
+                          unsigned maxLength, bool verbose = true, Stats *stats = nullptr) {
+        using Compressor::Node;
+        // 1. 构造出现的字节节点数组，用于构建哈夫曼树（全部节点位于栈上的节点池中，函数返回时一并释放）
+        Compressor::NodePool tree;
         std::vector<Node *> nodes;
-        for (int i = 0; i < 256; i++) {
+        for (std::size_t i = 0; i < freq.size(); i++) {
             if (freq[i] == 0) {
                 continue;
             }
-            nodes.push_back(new Node(static_cast<unsigned char>(i), freq[i]));
+            nodes.push_back(&tree[tree.leaf(static_cast<uint16_t>(i), freq[i])]);
         }
 
-        // 7. 使用公共模块的堆排序对节点数组排序（主要根据频率，频率相同则根据字节大小）
+        // 使用公共模块的堆排序对节点数组排序（主要根据频率，频率相同则根据字节大小）
         auto comp = [](const Node *a, const Node *b) -> bool {
             if (a->freq != b->freq) {
                 return a->freq < b->freq;
             }
-            return a->byteVal < b->byteVal;
+            return a->symbol < b->symbol;
         };
+        Stats::Timer sortTimer(stats, "heapSort");
         Common::heapSort(nodes, comp);
-        // 显示排序后的词频统计表（用于调试）
-        std::cout << "*****Sorted Frequency List*****" << std::endl;
-        std::cout << "Byte  Freq" << std::endl;
-        for (auto n : nodes) {
-            std::cout << "0x" << std::hex << std::uppercase << std::setw(2) 
-                      << std::setfill('0') << static_cast<int>(n->byteVal);
-            std::cout << '\t' << std::dec << n->freq << std::endl;
+        sortTimer.stop();
+        // 显示排序后的词频统计表（用于调试，逐行不刷新输出缓冲区，最后统一刷新）
+        if (verbose) {
+            std::cout << "*****Sorted Frequency List*****\n";
+            std::cout << "Byte  Freq\n";
+            for (auto n : nodes) {
+                std::cout << "0x" << std::hex << std::uppercase << std::setw(2) 
+                          << std::setfill('0') << static_cast<int>(n->symbol);
+                std::cout << '\t' << std::dec << n->freq << '\n';
+            }
+            std::cout << std::flush;
         }
 
-        // 8. 使用小根堆构建哈夫曼树：不断合并节点，直至堆中只剩一个节点（即树根）
-        Common::MinHeap<Node *, decltype(comp)> heap(comp);
+        // 2. 使用小根堆构建哈夫曼树：不断合并节点，直至堆中只剩一个节点（即树根）。
+        //    堆中存放节点下标
+        Stats::Timer treeTimer(stats, "tree build");
+        auto indexComp = [&](uint16_t a, uint16_t b) { return comp(&tree[a], &tree[b]); };
+        Common::MinHeap<uint16_t, decltype(indexComp)> heap(indexComp);
         for (auto node : nodes) {
-            heap.push(node);
+            heap.push(static_cast<uint16_t>(node - &tree[0]));
         }
         while (heap.size() > 1) {
-            Node *left = heap.top();
+            uint16_t left = heap.top();
             heap.pop();
-            Node *right = heap.top();
+            uint16_t right = heap.top();
             heap.pop();
-            Node *merged = new Node(left, right);
-            heap.push(merged);
-        }
-        Node *huffmanTreeRoot = nodes.empty() ? nullptr : heap.top();
-
-        // 9. 计算并显示哈夫曼树的总带权路径长度（WPL）
-        int wpl = 0;
-        computeWPL(huffmanTreeRoot, 0, wpl);
-        std::cout << "********************************" << std::endl;
-        std::cout << "Huffman Tree WPL: " << wpl << std::endl;
-
-        // 10. 遍历哈夫曼树，生成每个字节的哈夫曼编码
-        std::vector<std::string> huffmanCodes(256);
-        getHuffmanCode(huffmanTreeRoot, "", huffmanCodes);
-
-        // 11. 计算并显示原始数据（未压缩）的 HASH 值
-        std::cout << "********************************" << std::endl;
-        std::string OriginalDataHash = Common::calculateHash(content);
-        std::cout << "Original Data Hash: 0x" << OriginalDataHash << std::endl;
-        std::cout << "Original Data Size: " << processedContent.size() << " bytes" << std::endl;
-
-        // 12. 构造编码表并输出到 code.txt 文件
-        // 每行记录：字节码、编码长度以及编码字节（按8位分组）
-        std::vector<EncodedData> EncodedTable(256);
+            heap.push(tree.merge(left, right));
+        }
+        treeTimer.stop();
+
+        // 3. 计算并显示哈夫曼树的总带权路径长度（WPL）
+        uint64_t wpl = 0;
+        if (!nodes.empty()) {
+            computeWPL(tree, heap.top(), 0, wpl);
+        }
+        if (verbose) {
+            std::cout << "********************************" << std::endl;
+            std::cout << "Huffman Tree WPL: " << wpl << std::endl;
+        }
+
+        if (stats) {
+            stats->set("wpl", static_cast<double>(wpl));
+            stats->set("symbols", static_cast<double>(nodes.size()));
+        }
+
+        // 4. 遍历哈夫曼树得到各字节的编码长度
+        Stats::Timer codeTimer(stats, "code generation");
+        unsigned limit = maxLength == 0 ? Huffman::MAX_CODE_LENGTH : std::min(maxLength, Huffman::MAX_CODE_LENGTH);
+        codeLengths.assign(freq.size(), 0);
+        if (nodes.empty()) {
+            return true;
+        }
+        if (maxDepth(tree, heap.top()) <= static_cast<int>(limit)) {
+            getCodeLength(tree, heap.top(), 0, codeLengths);
+        } else {
+            // 哈夫曼树过深：构造限长编码，并显示相对于无限制哈夫曼编码的 WPL 增加量
+            codeLengths = Huffman::limitedCodeLengths(freq, limit);
+            if (codeLengths.empty()) {
+                std::cerr << "Cannot limit " << nodes.size() << " symbols to " << limit << "-bit codes" << std::endl;
+                return false;
+            }
+            uint64_t limitedWpl = 0;
+            for (std::size_t i = 0; i < freq.size(); i++) {
+                limitedWpl += freq[i] * codeLengths[i];
+            }
+            if (stats) {
+                stats->set("limited_wpl", static_cast<double>(limitedWpl));
+            }
+            if (verbose) {
+                std::ostringstream penalty;
+                penalty << std::fixed << std::setprecision(3) << (wpl ? 100.0 * (limitedWpl - wpl) / wpl : 0.0);
+                std::cout << "Length-limited WPL (max " << limit << " bits): " << limitedWpl
+                          << " (+" << limitedWpl - wpl << ", +" << penalty.str() << "%)" << std::endl;
+            }
+        }
+        return true;
+    }
+
+    // 函数: encodedBytes
+    // 作用: 由字节频率与编码计算编码后比特流的字节数，用于预先分配输出数组
+    std::size_t encodedBytes(const std::vector<uint64_t> &freq, const std::vector<Huffman::Code> &codes) {
+        uint64_t bits = 0;
+        for (const Huffman::Code &code : codes) {
+            bits += freq[code.symbol] * code.length;
+        }
+        return static_cast<std::size_t>((bits + 7) / 8);
+    }
+
+    // 原样存储的阈值：编码后（含码表）节省的字节数不足原始字节数的 1/MIN_SAVING_RATIO 时原样存储
+    constexpr uint64_t MIN_SAVING_RATIO = 64;
+
+    // 函数: storeRaw
+    // 作用: 由预计的编码后字节数（含码表）判断是否应原样存储。已压缩或已加密的数据字节分布接近均匀，
+    //       哈夫曼编码几乎不能节省空间，原样存储可省去编码与解码的开销
+    bool storeRaw(uint64_t rawSize, uint64_t codedSize) {
+        return codedSize + rawSize / MIN_SAVING_RATIO >= rawSize;
+    }
+
+    // 函数: recordSizes
+    // 作用: 记录原始数据与压缩文件的字节数及压缩率（压缩文件大小 / 原始数据大小）
+    void recordSizes(Stats *stats, uint64_t originalLength, uint64_t outputLength) {
+        if (!stats) {
+            return;
+        }
+        stats->set("original_bytes", static_cast<double>(originalLength));
+        stats->set("compressed_bytes", static_cast<double>(outputLength));
+        stats->set("ratio", originalLength ? static_cast<double>(outputLength) / originalLength : 0.0);
+    }
+
+    // 函数: recordEntropy
+    // 作用: 记录数据的信息熵与实际平均编码长度（位/字节），两者之差即哈夫曼编码的冗余
+    void recordEntropy(Stats *stats, const std::vector<uint64_t> &freq, const std::vector<uint8_t> &codeLengths) {
+        if (!stats) {
+            return;
+        }
+        uint64_t total = 0, bits = 0;
         for (int i = 0; i < 256; i++) {
-            if (freq[i] == 0) {
+            total += freq[i];
+            bits += freq[i] * codeLengths[i];
+        }
+        stats->set("entropy_bits_per_byte", Stats::entropy(freq));
+        stats->set("avg_code_bits", total ? static_cast<double>(bits) / total : 0.0);
+    }
+
+    // 函数: buildContextTables
+    // 作用: 由一阶频率构建上下文模式的码表，主要步骤：
+    //       1. 由全部数据的字节频率构建单一码表，作为各上下文合并时编码位数的估计
+    //       2. 对每个出现过的上下文构建其自己的码表：按自己的码表编码的位数加上存储该码表的字节数
+    //          少于按单一码表编码的位数时，该上下文使用自己的码表
+    //       3. 其余（稀疏的）上下文合并，由其频率之和构建共用的后备表
+    //
+    // 参数:
+//    pairFreq  - 一阶频率（下标为 上下文 * 256 + 字节值）
+//    maxLength - 最长编码长度，0 表示不限制
+//    verbose   - 是否显示全部数据的词频统计表与 WPL 以及所选的上下文个数
+//    tables    - 输出：上下文码表
+//    codedBits - 输出：按所选码表编码的总位数
+//    stats     - 统计信息收集器（可为空）
+    //
+    // 返回:
+    //    成功返回 true
+    bool buildContextTables(const std::vector<uint64_t> &pairFreq, unsigned maxLength, bool verbose,
+                            Format::ContextTables &tables, uint64_t &codedBits, Stats *stats) {
+        // 1. 全部数据的字节频率与单一码表
+        std::vector<uint64_t> freq(256, 0);
+        for (std::size_t i = 0; i < 65536; i++) {
+            freq[i & 0xFF] += pairFreq[i];
+        }
+        std::vector<uint8_t> order0;
+        if (!buildCodeLengths(freq, order0, maxLength, verbose, stats)) {
+            return false;
+        }
+
+        // 2. 逐个上下文比较自己的码表与单一码表的代价（码表开销为符号位图 32 字节加每个符号 1 字节）
+        Stats::Timer timer(stats, "context tables");
+        tables.lengths.assign(1, std::array<uint8_t, 256>{});
+        tables.tableOf.fill(0);
+        std::vector<uint64_t> fallback(256, 0), contextFreq(256);
+        std::vector<uint8_t> lengths;
+        codedBits = 0;
+        double conditionalBits = 0;
+        for (unsigned context = 0; context < 256; context++) {
+            contextFreq.assign(pairFreq.begin() + context * 256, pairFreq.begin() + context * 256 + 256);
+            uint64_t total = 0;
+            for (uint64_t f : contextFreq) {
+                total += f;
+            }
+            if (total == 0) {
                 continue;
             }
-            EncodedTable[i].byteCode = static_cast<unsigned char>(i);
-            EncodedTable[i].length = huffmanCodes[i].size();
-            for (int j = 0; j < huffmanCodes[i].size(); j += 8) {
-                std::string subStr = huffmanCodes[i].substr(j, 8);
-                // 不足8位则补零
-                while (subStr.size() < 8) {
-                    subStr += "0";
-                }
-                unsigned char byte = 0;
-                for (char bit : subStr) {
-                    byte = byte << 1;
-                    byte |= (bit == '1' ? 1 : 0);
+            conditionalBits += Stats::entropy(contextFreq) * static_cast<double>(total);
+            if (!buildCodeLengths(contextFreq, lengths, maxLength, false)) {
+                return false;
+            }
+            uint64_t ownBits = 0, sharedBits = 0, tableBits = 32 * 8;
+            for (unsigned symbol = 0; symbol < 256; symbol++) {
+                ownBits += contextFreq[symbol] * lengths[symbol];
+                sharedBits += contextFreq[symbol] * order0[symbol];
+                tableBits += lengths[symbol] ? 8 : 0;
+            }
+            if (ownBits + tableBits < sharedBits) {
+                tables.tableOf[context] = static_cast<uint16_t>(tables.lengths.size());
+                tables.lengths.emplace_back();
+                std::copy(lengths.begin(), lengths.end(), tables.lengths.back().begin());
+                codedBits += ownBits;
+            } else {
+                for (unsigned symbol = 0; symbol < 256; symbol++) {
+                    fallback[symbol] += contextFreq[symbol];
                 }
-                EncodedTable[i].bitCoded.push_back(byte);
             }
         }
-        std::string outputEncodingTable = "test/code.txt";
-        std::ofstream tableFile(outputEncodingTable);
-        if (!tableFile) {
-            std::cerr << "Error opening output file: " << outputEncodingTable << std::endl;
+
+        // 3. 由稀疏上下文的频率之和构建后备表
+        if (!buildCodeLengths(fallback, lengths, maxLength, false)) {
+            return false;
+        }
+        std::copy(lengths.begin(), lengths.end(), tables.lengths[0].begin());
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            codedBits += fallback[symbol] * lengths[symbol];
+        }
+        timer.stop();
+
+        uint64_t total = 0;
+        for (uint64_t f : freq) {
+            total += f;
+        }
+        if (stats) {
+            stats->set("entropy_bits_per_byte", Stats::entropy(freq));
+            stats->set("avg_code_bits", total ? static_cast<double>(codedBits) / total : 0.0);
+            stats->set("context_tables", static_cast<double>(tables.lengths.size() - 1));
+            stats->set("context_entropy_bits_per_byte", total ? conditionalBits / total : 0.0);
+            stats->set("context_wpl", static_cast<double>(codedBits));
+        }
+        if (verbose) {
+            std::cout << "Context tables: " << tables.lengths.size() - 1 << " contexts + fallback, WPL "
+                      << codedBits << std::endl;
+        }
+        return true;
+    }
+
+    // 类: SymbolEncoder
+    // 作用: 按码表编码字节：单一码表，或一阶上下文模式下以前一字节为上下文选择码表。
+    //       上下文在各次调用之间延续，数据流开头（及同步点处）重置为 0
+    class SymbolEncoder {
+    public:
+        // 单一码表
+        explicit SymbolEncoder(const std::vector<uint8_t> &codeLengths)
+            : codes(Huffman::canonicalCodes(codeLengths)) {}
+
+        // 上下文码表
+        explicit SymbolEncoder(const Format::ContextTables &tables) {
+            std::vector<std::vector<Huffman::Code>> tableCodes;
+            for (const std::array<uint8_t, 256> &lengths : tables.lengths) {
+                tableCodes.push_back(Huffman::canonicalCodes(std::vector<uint8_t>(lengths.begin(), lengths.end())));
+            }
+            contexts.reset(new Huffman::ContextCodes(tableCodes, tables.tableOf));
+        }
+
+        void encode(const unsigned char *data, std::size_t size, Huffman::BitWriter &writer) {
+            if (!contexts) {
+                writer.putSymbols(data, size, codes.data());
+                return;
+            }
+            if (size > 0) {
+                writer.putContextSymbols(data, size, previous, *contexts);
+                previous = data[size - 1];
+            }
+        }
+
+        void resetContext() { previous = 0; }
+
+    private:
+        std::vector<Huffman::Code> codes;
+        std::unique_ptr<Huffman::ContextCodes> contexts;
+        unsigned char previous = 0; // 下一个字节的上下文
+    };
+
+    // 函数: prepareCodes
+    // 作用: 由第一遍统计的频率构建码表并记入文件头：单一码表模式记入 256 个编码长度，
+    //       上下文模式记入上下文码表并设置 FLAG_CONTEXT
+    //
+    // 参数:
+//    freq        - 字节频率（256 项），上下文模式下为一阶频率（65536 项）
+//    options     - 压缩选项（最长编码长度、是否上下文模式、输出详细程度）
+//    header      - 输出：文件头
+//    encodedSize - 输出：编码后比特流的字节数（用于预先分配输出数组）
+//    stats       - 统计信息收集器（可为空）
+    //
+    // 返回:
+    //    编码器；构建码表失败时返回空
+    std::unique_ptr<SymbolEncoder> prepareCodes(const std::vector<uint64_t> &freq, const Compressor::Options &options,
+                                                Format::Header &header, std::size_t &encodedSize, Stats *stats) {
+        bool debug = options.verbosity >= Verbosity::DEBUG;
+        if (options.contextModel) {
+            uint64_t codedBits = 0;
+            if (!buildContextTables(freq, options.maxCodeLength, debug, header.contexts, codedBits, stats)) {
+                return nullptr;
+            }
+            header.flags |= Format::FLAG_CONTEXT;
+            encodedSize = static_cast<std::size_t>((codedBits + 7) / 8);
+            Stats::Timer codeTimer(stats, "code generation");
+            return std::unique_ptr<SymbolEncoder>(new SymbolEncoder(header.contexts));
+        }
+        std::vector<uint8_t> codeLengths;
+        if (!buildCodeLengths(freq, codeLengths, options.maxCodeLength, debug, stats)) {
+            return nullptr;
+        }
+        std::copy(codeLengths.begin(), codeLengths.end(), header.codeLengths.begin());
+        Stats::Timer codeTimer(stats, "code generation");
+        encodedSize = encodedBytes(freq, Huffman::canonicalCodes(codeLengths));
+        std::unique_ptr<SymbolEncoder> encoder(new SymbolEncoder(codeLengths));
+        codeTimer.stop();
+        recordEntropy(stats, freq, codeLengths);
+        return encoder;
+    }
+
+    // 函数: dictionaryCodes
+    // 作用: 使用共享字典的码表：记入文件头（文件头中只记录字典 ID）并构建编码器，不统计频率也不构建哈夫曼树
+    std::unique_ptr<SymbolEncoder> dictionaryCodes(const Dictionary::Tables &dictionary, Format::Header &header,
+                                                   Stats *stats) {
+        Stats::Timer codeTimer(stats, "code generation");
+        Dictionary::fillHeader(dictionary, header);
+        if (stats) {
+            stats->set("dictionary", Common::hashToString(dictionary.id));
+        }
+        if (dictionary.contextual) {
+            return std::unique_ptr<SymbolEncoder>(new SymbolEncoder(header.contexts));
+        }
+        return std::unique_ptr<SymbolEncoder>(
+            new SymbolEncoder(std::vector<uint8_t>(header.codeLengths.begin(), header.codeLengths.end())));
+    }
+
+    // 函数: smoothedLengths
+    // 作用: 由各字节频率加 1 构建编码长度，使训练样本中未出现的字节值也有编码（共享字典须能编码任意数据）
+    bool smoothedLengths(std::vector<uint64_t> freq, unsigned maxLength, bool verbose,
+                         std::array<uint8_t, 256> &lengths) {
+        for (uint64_t &f : freq) {
+            f++;
+        }
+        std::vector<uint8_t> codeLengths;
+        if (!buildCodeLengths(freq, codeLengths, maxLength, verbose)) {
+            return false;
+        }
+        std::copy(codeLengths.begin(), codeLengths.end(), lengths.begin());
+        return true;
+    }
+
+    // 函数: outputPath
+    // 作用: 压缩文件路径：设置了 outputFile 时为该路径，否则文件名格式为 "输出目录/原文件名.hfm"
+    std::string outputPath(const std::string &inputFile, const Compressor::Options &options) {
+        if (!options.outputFile.empty()) {
+            return options.outputFile;
+        }
+        return Common::joinPath(options.outputDir, Common::extractFileName(inputFile) + ".hfm");
+    }
+
+    // 函数: commitOutput
+    // 作用: 关闭写完的临时输出文件（正式文件名加 ".part"）并替换为正式文件名，失败时删除临时文件
+    bool commitOutput(std::ofstream &outFile, const std::string &partFile, const std::string &outputFile) {
+        outFile.close();
+        if (!outFile || std::rename(partFile.c_str(), outputFile.c_str()) != 0) {
+            std::cerr << "Error writing output file: " << outputFile << std::endl;
+            std::remove(partFile.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // 函数: batchSalt
+    // 作用: ChaCha20 派生密钥用的随机盐，进程内生成一次，同一批压缩的各文件共用（密钥只派生一次）
+    const std::array<uint8_t, Format::SALT_SIZE> &batchSalt() {
+        static const std::array<uint8_t, Format::SALT_SIZE> salt = [] {
+            std::array<uint8_t, Format::SALT_SIZE> bytes;
+            std::random_device random;
+            for (uint8_t &byte : bytes) {
+                byte = static_cast<uint8_t>(random());
+            }
+            return bytes;
+        }();
+        return salt;
+    }
+
+    // 函数: makeHeader
+    // 作用: 构造文件头：记录原始数据长度与加密方式（码表由 prepareCodes 填入，校验和由各压缩方式填入）；
+    //       ChaCha20 加密时使用本批共用的随机盐，并为每个文件生成不同的随机数
+    Format::Header makeHeader(uint64_t originalLength, bool encrypt, const std::string &key,
+                              const Compressor::Options &options) {
+        Format::Header header;
+        header.originalLength = originalLength;
+        header.flags |= Format::FLAG_CHECKSUM;
+        if (encrypt) {
+            header.flags |= Format::FLAG_ENCRYPTED;
+            if (options.chacha20) {
+                header.flags |= Format::FLAG_CHACHA20;
+                std::random_device random;
+                header.salt = batchSalt();
+                header.nonce = (static_cast<uint64_t>(random()) << 32) | random();
+                header.kdfIterations = ChaCha20::KDF_ITERATIONS;
+            } else if (!key.empty()) {
+                header.flags |= Format::FLAG_XOR_KEY;
+            }
+        }
+        return header;
+    }
+
+    // 函数: makeCipher
+    // 作用: 按文件头中的加密方式创建加密器（未加密时创建的加密器不会被使用）
+    Common::Cipher makeCipher(const Format::Header &header, const std::string &key) {
+        if (header.flags & Format::FLAG_CHACHA20) {
+            return Common::Cipher(key, header.salt.data(), header.salt.size(), header.kdfIterations, header.nonce);
+        }
+        return Common::Cipher(key);
+    }
+
+    // 函数: recordParties
+    // 作用: 将收发人信息记录在文件头中（不属于数据流，解压时在解码前校验）；
+    //       加密时以 Format::PARTIES_STREAM_OFFSET 起的密钥流加密，不与数据流共用密钥流
+    void recordParties(Format::Header &header, const std::string &senderInfo, const std::string &receiverInfo,
+                       const Common::Cipher &cipher) {
+        header.flags |= Format::FLAG_PARTIES;
+        header.senderInfo = senderInfo;
+        header.receiverInfo = receiverInfo;
+        if (header.flags & Format::FLAG_ENCRYPTED) {
+            cipher.encrypt(reinterpret_cast<unsigned char *>(&header.senderInfo[0]), header.senderInfo.size(),
+                           Format::PARTIES_STREAM_OFFSET);
+            cipher.encrypt(reinterpret_cast<unsigned char *>(&header.receiverInfo[0]), header.receiverInfo.size(),
+                           Format::PARTIES_STREAM_OFFSET + senderInfo.size());
+        }
+    }
+
+    // 函数: chooseStored
+    // 作用: 由码表预计的编码后字节数（码表加比特流）判断是否原样存储，是则将文件头改为原样存储
+    //       （去掉码表，保留加密方式、校验和与收发人信息）
+    //
+    // 返回:
+    //    原样存储时返回 true
+    bool chooseStored(Format::Header &header, std::size_t encodedSize, Stats *stats) {
+        Format::Header stored = header;
+        stored.flags = static_cast<uint16_t>(
+            (header.flags & (Format::CIPHER_FLAGS | Format::FLAG_CHECKSUM | Format::FLAG_PARTIES)) | Format::FLAG_STORED);
+        stored.contexts = Format::ContextTables();
+        std::size_t tableSize = Format::serializeHeader(header).size() - Format::serializeHeader(stored).size();
+        if (!storeRaw(header.originalLength, tableSize + encodedSize)) {
+            return false;
+        }
+        header = stored;
+        if (stats) {
+            stats->set("stored", "raw");
+        }
+        return true;
+    }
+
+    // 函数: encodeWithSync
+    // 作用: 将一段数据编码追加写入比特流，每当数据流偏移到达 syncInterval 的整数倍时，
+    //       在编码该位置的字节之前记录一个同步点（比特流位偏移, 数据流偏移），
+    //       上下文模式下同时将上下文重置为 0，使各段可独立解码
+    //
+    // 参数:
+//    data         - 待编码数据
+//    size         - 数据字节数
+//    offset       - 数据在整个数据流中的起始位置
+//    encoder      - 码表
+//    writer       - 比特流写入器
+//    flushedBits  - writer 之前已写出的位数（流式压缩时为已刷出的字节数 * 8）
+//    syncInterval - 同步点间隔，0 表示不记录
+//    syncPoints   - 输出：追加记录的同步点
+    void encodeWithSync(const unsigned char *data, std::size_t size, uint64_t offset,
+                        SymbolEncoder &encoder, Huffman::BitWriter &writer,
+                        uint64_t flushedBits, uint64_t syncInterval, std::vector<Format::SyncPoint> &syncPoints) {
+        if (syncInterval == 0) {
+            encoder.encode(data, size, writer);
             return;
         }
-        // 第一行为原始文本字节长度
-        tableFile << processedContent.size() << std::endl;
-        for (auto &entry : EncodedTable) {
-            if (entry.length == 0) {
-                continue;
+        std::size_t done = 0;
+        while (done < size) {
+            uint64_t position = offset + done;
+            uint64_t phase = position % syncInterval;
+            if (phase == 0) {
+                encoder.resetContext();
+                if (position > 0) {
+                    syncPoints.push_back(Format::SyncPoint{flushedBits + writer.bitPosition(), position});
+                }
+            }
+            std::size_t step = static_cast<std::size_t>(std::min<uint64_t>(size - done, syncInterval - phase));
+            encoder.encode(data + done, step, writer);
+            done += step;
+        }
+    }
+
+    // 函数: syncPointCount
+    // 作用: 返回长度为 totalLength 的数据流按 syncInterval 记录的同步点个数（偏移 0 处不记录）
+    std::size_t syncPointCount(uint64_t totalLength, uint64_t syncInterval) {
+        return syncInterval == 0 || totalLength == 0 ? 0 : static_cast<std::size_t>((totalLength - 1) / syncInterval);
+    }
+
+    // 函数: forEachChunk
+    // 作用: 按固定大小的缓冲区依次读取文件内容（即数据流），
+    //       对每块数据调用 handler，整个过程只占用一个缓冲区的内存
+    //
+    // 参数:
+//    inFile     - 已打开的输入文件
+//    bufferSize - 缓冲区字节数
+//    handler    - 处理函数，参数为（数据块地址, 字节数, 数据块在数据流中的偏移）
+//    stats      - 统计信息收集器（可为空），读取文件的耗时计入 "read" 阶段
+    bool forEachChunk(std::ifstream &inFile, std::size_t bufferSize,
+                      const std::function<void(unsigned char *, std::size_t, uint64_t)> &handler,
+                      Stats *stats = nullptr) {
+        inFile.clear();
+        inFile.seekg(0, std::ios::beg);
+        std::vector<unsigned char> buffer(bufferSize);
+        uint64_t offset = 0;
+        while (inFile) {
+            Stats::Timer readTimer(stats, "read");
+            inFile.read(reinterpret_cast<char *>(buffer.data()), bufferSize);
+            readTimer.stop();
+            std::size_t got = static_cast<std::size_t>(inFile.gcount());
+            if (got == 0) {
+                break;
             }
-            tableFile << "0x" << std::hex << std::uppercase << std::setw(2) 
-                      << std::setfill('0') << static_cast<int>(entry.byteCode);
-            tableFile << " 0x" << std::hex << std::uppercase << std::setw(2) 
-                      << std::setfill('0') << entry.length;
-            for (unsigned char byte : entry.bitCoded) {
-                tableFile << " 0x" << std::hex << std::uppercase << std::setw(2) 
-                          << std::setfill('0') << static_cast<int>(byte);
+            handler(buffer.data(), got, offset);
+            offset += got;
+        }
+        return !inFile.bad();
+    }
+
+    // 类: InputStream
+    // 作用: 依次读取文件内容（即数据流），每次尽量读满请求的字节数
+    class InputStream {
+    public:
+        explicit InputStream(std::ifstream &file) : file(file) {}
+
+        // 读取至多 n 个字节，返回实际读取的字节数（为 0 表示数据流结束）
+        std::size_t read(unsigned char *dst, std::size_t n) {
+            std::size_t done = 0;
+            while (done < n && file) {
+                file.read(reinterpret_cast<char *>(dst + done), n - done);
+                done += static_cast<std::size_t>(file.gcount());
             }
-            tableFile << std::dec << std::endl;
+            return done;
         }
-        tableFile.close();
 
-        // 13. 生成压缩数据：将每个字节的哈夫曼编码按位打包
-        std::vector<unsigned char> compressedData;
-        unsigned char byte = 0;
-        int bitcount = 0;
-        for (unsigned char c : processedContent) {
-            const std::string &code = huffmanCodes[c];
-            for (char bit : code) {
-                byte = (byte << 1) | (bit == '1' ? 1 : 0);
-                bitcount++;
-                if (bitcount == 8) {
-                    compressedData.push_back(byte);
-                    byte = 0;
-                    bitcount = 0;
+        bool bad() const { return file.bad(); }
+
+    private:
+        std::ifstream &file;
+    };
+
+    // 函数: compressMatches
+    // 作用: LZ77 模式下压缩一个数据块：解析为字面量与匹配，分别统计字面量/长度符号与距离符号的出现次数，
+    //       各自构建哈夫曼码表后编码。输出为两张码表的编码长度（286 + 30 个）加上该块的比特流
+    //
+    // 参数:
+//    data      - 块数据（已按需加密）
+//    size      - 块字节数
+//    level     - 匹配查找策略
+//    maxLength - 最长编码长度，0 表示不限制
+//    out       - 输出：块数据
+    //
+    // 返回:
+    //    成功返回 true
+    bool compressMatches(const unsigned char *data, std::size_t size, LZ77::Level level, unsigned maxLength,
+                         std::vector<unsigned char> &out) {
+        std::vector<LZ77::Token> tokens;
+        LZ77::parse(data, size, level, tokens);
+        std::vector<uint64_t> litLenFreq, distanceFreq;
+        LZ77::countSymbols(tokens, litLenFreq, distanceFreq);
+        std::vector<uint8_t> litLenLengths, distanceLengths;
+        if (!buildCodeLengths(litLenFreq, litLenLengths, maxLength, false) ||
+            !buildCodeLengths(distanceFreq, distanceLengths, maxLength, false)) {
+            return false;
+        }
+        std::vector<Huffman::Code> litLenCodes = Huffman::canonicalCodes(litLenLengths);
+        std::vector<Huffman::Code> distanceCodes = Huffman::canonicalCodes(distanceLengths);
+        out.assign(litLenLengths.begin(), litLenLengths.end());
+        out.insert(out.end(), distanceLengths.begin(), distanceLengths.end());
+        Huffman::BitWriter writer(out);
+        writer.reserve(encodedBytes(litLenFreq, litLenCodes) + encodedBytes(distanceFreq, distanceCodes));
+        LZ77::encode(tokens, litLenCodes, distanceCodes, writer);
+        writer.finish();
+        return true;
+    }
+
+    // 函数: compressTransformed
+    // 作用: BWT 模式下压缩一个数据块：BWT 变换后做前移变换与零游程编码，由符号流的频率构建码表并编码。
+    //       输出为主行号（4 字节，小端序）、257 个编码长度，再加上该块的比特流
+    //
+    // 参数:
+//    data      - 块数据（已按需加密）
+//    size      - 块字节数（1 ~ BWT::MAX_BLOCK_SIZE）
+//    maxLength - 最长编码长度，0 表示不限制
+//    out       - 输出：块数据
+    //
+    // 返回:
+    //    成功返回 true
+    bool compressTransformed(const unsigned char *data, std::size_t size, unsigned maxLength,
+                             std::vector<unsigned char> &out) {
+        if (size == 0 || size > BWT::MAX_BLOCK_SIZE) {
+            return false;
+        }
+        std::vector<unsigned char> transformed(size);
+        uint32_t primary = BWT::transform(data, size, transformed.data());
+        std::vector<uint16_t> symbols;
+        BWT::encodeSymbols(transformed.data(), size, symbols);
+        std::vector<uint64_t> freq(BWT::SYMBOLS, 0);
+        for (uint16_t symbol : symbols) {
+            freq[symbol]++;
+        }
+        std::vector<uint8_t> codeLengths;
+        if (!buildCodeLengths(freq, codeLengths, maxLength, false)) {
+            return false;
+        }
+        std::vector<Huffman::Code> codes = Huffman::canonicalCodes(codeLengths);
+        out.clear();
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<unsigned char>(primary >> (8 * i)));
+        }
+        out.insert(out.end(), codeLengths.begin(), codeLengths.end());
+        Huffman::BitWriter writer(out);
+        writer.reserve(encodedBytes(freq, codes));
+        for (uint16_t symbol : symbols) {
+            writer.put(codes[symbol].bits, codes[symbol].length);
+        }
+        writer.finish();
+        return true;
+    }
+
+    // 函数: compressBlock
+    // 作用: 独立压缩一个数据块：计算校验和、按需加密、统计频率（三者融合为一遍）、构建该块自己的码表并编码。
+    //       输出为该块 256 个编码长度加上该块的比特流（上下文模式下为该块的上下文码表，
+    //       LZ77 模式下见 compressMatches，BWT 模式下见 compressTransformed）；
+    //       由码表预计的编码后字节数节省不明显时跳过编码，输出即（加密后的）原始数据，见 storeRaw
+    //
+    // 参数:
+//    data     - 块原始数据（加密时原地修改）
+//    size     - 块字节数
+//    offset   - 块在整个数据流中的起始位置（用于确定密钥下标）
+//    cipher   - 加密器，为空表示不加密
+//    options  - 压缩选项（最长编码长度、是否上下文模式、LZ77 匹配查找策略、是否 BWT 变换）
+//    out      - 输出：块数据
+//    checksum - 输出：块原始数据（加密前）的校验和
+    //
+    // 返回:
+    //    成功返回 true
+    bool compressBlock(unsigned char *data, std::size_t size, uint64_t offset, const Common::Cipher *cipher,
+                       const Compressor::Options &options, std::vector<unsigned char> &out, uint32_t &checksum) {
+        // 原样存储：块数据字节数等于块原始字节数
+        auto store = [&]() {
+            out.assign(data, data + size);
+            return true;
+        };
+        unsigned maxLength = options.maxCodeLength;
+        checksum = 0;
+        // LZ77 与 BWT 模式的编码后字节数无法由字节频率预计，编码后再比较
+        if (options.lzLevel != LZ77::Level::NONE || options.bwt) {
+            checksum = CRC32C::update(0, data, size);
+            if (cipher) {
+                cipher->encrypt(data, size, offset);
+            }
+            bool ok = options.bwt ? compressTransformed(data, size, maxLength, out)
+                                  : compressMatches(data, size, options.lzLevel, maxLength, out);
+            return ok && (!storeRaw(size, out.size()) || store());
+        }
+        if (options.contextModel) {
+            std::vector<uint64_t> pairFreq(65536, 0);
+            unsigned char previous = 0;
+            Common::encryptAndCountPairs(data, size, offset, cipher, &checksum, previous, 0, pairFreq);
+            Format::ContextTables tables;
+            uint64_t codedBits = 0;
+            if (!buildContextTables(pairFreq, maxLength, false, tables, codedBits, nullptr)) {
+                return false;
+            }
+            out.clear();
+            Format::serializeContextTables(tables, out);
+            if (storeRaw(size, out.size() + (codedBits + 7) / 8)) {
+                return store();
+            }
+            SymbolEncoder encoder(tables);
+            Huffman::BitWriter writer(out);
+            writer.reserve(static_cast<std::size_t>((codedBits + 7) / 8));
+            encoder.encode(data, size, writer);
+            writer.finish();
+            return true;
+        }
+        std::vector<uint64_t> freq(256, 0);
+        Common::encryptAndCount(data, size, offset, cipher, &checksum, freq);
+        std::vector<uint8_t> codeLengths;
+        if (!buildCodeLengths(freq, codeLengths, maxLength, false)) {
+            return false;
+        }
+        std::size_t encodedSize = encodedBytes(freq, Huffman::canonicalCodes(codeLengths));
+        if (storeRaw(size, Format::BLOCK_TABLE_SIZE + encodedSize)) {
+            return store();
+        }
+        SymbolEncoder encoder(codeLengths);
+        out.assign(codeLengths.begin(), codeLengths.end());
+        Huffman::BitWriter writer(out);
+        writer.reserve(encodedSize);
+        encoder.encode(data, size, writer);
+        writer.finish();
+        return true;
+    }
+
+    // 自适应分块：统计字节分布的最小单位（段）的字节数，块边界只位于段边界上
+    constexpr std::size_t SPLIT_SEGMENT = std::size_t(16) << 10;
+
+    // 自适应分块或 LZ77 模式未指定块大小时，每块的（最大）字节数
+    constexpr std::size_t DEFAULT_BLOCK_SIZE = std::size_t(4) << 20;
+
+    // 函数: estimateBits
+    // 作用: 估计按由频率 freq 构建的码表编码这些字节所需的位数：
+    //       字节值 s 约需 log2(总数 / freq[s]) 位，且哈夫曼编码每个字节至少 1 位
+    double estimateBits(const uint64_t *freq) {
+        uint64_t total = 0;
+        for (int i = 0; i < 256; i++) {
+            total += freq[i];
+        }
+        double bits = 0;
+        for (int i = 0; i < 256; i++) {
+            if (freq[i] > 0) {
+                bits += static_cast<double>(freq[i]) *
+                        std::max(1.0, std::log2(static_cast<double>(total) / static_cast<double>(freq[i])));
+            }
+        }
+        return bits;
+    }
+
+    // 类: BlockPlanner
+    // 作用: 自适应分块的块划分。按顺序接收（加密后的）数据流并逐段统计字节频率，
+    //       每满一个窗口（maxBlock 字节）对窗口内各段自底向上合并：每次合并估计位数增加最少的相邻两块，
+    //       合并省去一张码表，直到任何合并增加的位数都超过一张码表的开销为止。
+    //       各块因此由字节分布相近的连续段组成，分布变化处即为块边界；块不跨窗口，因此不超过 maxBlock 字节
+    class BlockPlanner {
+    public:
+        explicit BlockPlanner(std::size_t maxBlock) : maxBlock(std::max(maxBlock, SPLIT_SEGMENT)) {}
+
+        // 追加一段数据流
+        void add(const unsigned char *data, std::size_t size) {
+            while (size > 0) {
+                if (segments.empty() || segmentSizes.back() == SPLIT_SEGMENT) {
+                    if (windowSize >= maxBlock) {
+                        plan();
+                    }
+                    segments.emplace_back(256, 0);
+                    segmentSizes.push_back(0);
+                }
+                std::size_t step = static_cast<std::size_t>(std::min<uint64_t>(size, SPLIT_SEGMENT - segmentSizes.back()));
+                Common::countBytes(data, step, segments.back());
+                segmentSizes.back() += step;
+                windowSize += step;
+                data += step;
+                size -= step;
+            }
+        }
+
+        // 数据流结束，返回各块的字节数
+        std::vector<uint64_t> finish() {
+            plan();
+            return blocks;
+        }
+
+    private:
+        std::size_t maxBlock;
+        std::vector<std::vector<uint64_t>> segments; // 当前窗口内各段的字节频率
+        std::vector<uint64_t> segmentSizes;          // 当前窗口内各段的字节数
+        std::size_t windowSize = 0;                  // 当前窗口的字节数
+        std::vector<uint64_t> blocks;                // 已规划的各块字节数
+
+        // 合并候选：相邻两块 left、right 合并后增加的位数（已扣除省去的码表），
+        // 记录两块当时的版本号，任一块此后又发生合并则该候选失效
+        struct Candidate {
+            double delta;
+            std::size_t left, right;
+            unsigned leftVersion, rightVersion;
+        };
+
+        // 函数: plan
+        // 作用: 对当前窗口内的各段做自底向上的合并，并将得到的各块追加到 blocks
+        void plan() {
+            std::size_t n = segments.size();
+            if (n == 0) {
+                return;
+            }
+            const double tableBits = Format::BLOCK_TABLE_SIZE * 8.0;
+            std::vector<double> bits(n);
+            std::vector<std::size_t> next(n), prev(n);
+            std::vector<unsigned> version(n, 0);
+            std::vector<char> alive(n, 1);
+            for (std::size_t i = 0; i < n; i++) {
+                bits[i] = estimateBits(segments[i].data());
+                next[i] = i + 1;
+                prev[i] = i - 1; // 第一段的 prev 不会被使用
+            }
+            auto comp = [](const Candidate &a, const Candidate &b) {
+                return a.delta != b.delta ? a.delta < b.delta : a.left < b.left;
+            };
+            Common::MinHeap<Candidate, decltype(comp)> heap(comp);
+            std::array<uint64_t, 256> merged;
+            auto propose = [&](std::size_t left, std::size_t right) {
+                for (int s = 0; s < 256; s++) {
+                    merged[s] = segments[left][s] + segments[right][s];
+                }
+                double delta = estimateBits(merged.data()) - bits[left] - bits[right] - tableBits;
+                if (delta < 0) {
+                    heap.push(Candidate{delta, left, right, version[left], version[right]});
+                }
+            };
+            for (std::size_t i = 0; i + 1 < n; i++) {
+                propose(i, i + 1);
+            }
+            while (!heap.empty()) {
+                Candidate candidate = heap.top();
+                heap.pop();
+                std::size_t left = candidate.left, right = candidate.right;
+                if (!alive[left] || !alive[right] || version[left] != candidate.leftVersion ||
+                    version[right] != candidate.rightVersion) {
+                    continue;
+                }
+                // 右块并入左块
+                for (int s = 0; s < 256; s++) {
+                    segments[left][s] += segments[right][s];
+                }
+                segmentSizes[left] += segmentSizes[right];
+                bits[left] = estimateBits(segments[left].data());
+                alive[right] = 0;
+                version[left]++;
+                next[left] = next[right];
+                if (next[left] < n) {
+                    prev[next[left]] = left;
+                    propose(left, next[left]);
+                }
+                if (left > 0) {
+                    propose(prev[left], left);
+                }
+            }
+            for (std::size_t i = 0; i < n; i = next[i]) {
+                blocks.push_back(segmentSizes[i]);
+            }
+            segments.clear();
+            segmentSizes.clear();
+            windowSize = 0;
+        }
+    };
+
+    // 函数: compressBlocks
+    // 作用: 分块并行压缩。将数据流切分为独立的块，每批读取若干块交给线程池并行压缩
+    //       （每块使用独立的频率统计与码表），再按顺序写出并记录块索引；
+    //       文件头中的块索引先占位，全部写出后回填。块大小固定为 blockSize，
+    //       自适应分块时先读一遍数据流，由 BlockPlanner 在字节分布变化处确定块边界
+    bool compressBlocks(const std::string &inputFile,
+                        const std::string &senderInfo,
+                        const std::string &receiverInfo,
+                        bool encrypt,
+                        const std::string &key,
+                        const Compressor::Options &options,
+                        Stats *stats) {
+        std::ifstream inFile(inputFile, std::ios::binary);
+        if (!inFile) {
+            std::cerr << "Error opening input file: " << inputFile << std::endl;
+            return false;
+        }
+        bool lz = options.lzLevel != LZ77::Level::NONE;
+        std::size_t blockSize = options.blockSize > 0 ? options.blockSize : DEFAULT_BLOCK_SIZE;
+        if (options.bwt) {
+            blockSize = std::min(blockSize, BWT::MAX_BLOCK_SIZE);
+        }
+        blockSize = std::max(blockSize, std::size_t(4096));
+        inFile.seekg(0, std::ios::end);
+        uint64_t totalLength = static_cast<uint64_t>(inFile.tellg());
+        inFile.seekg(0, std::ios::beg);
+
+        // 1. 确定各块的原始字节数：自适应分块时先读一遍数据流（按需加密后）规划块边界
+        //    偏移量、异或加密在编码前加密各块原始数据，ChaCha20 加密在编码后加密各块数据
+        Format::Header header = makeHeader(totalLength, encrypt, key, options);
+        Common::Cipher cipher = makeCipher(header, key);
+        recordParties(header, senderInfo, receiverInfo, cipher);
+        bool chacha = (header.flags & Format::FLAG_CHACHA20) != 0;
+        const Common::Cipher *blockCipher = encrypt && !chacha ? &cipher : nullptr;
+        const Common::Cipher *payloadCipher = chacha ? &cipher : nullptr;
+        header.flags |= Format::FLAG_BLOCKS;
+        if (lz) {
+            header.flags |= Format::FLAG_LZ77;
+        } else if (options.bwt) {
+            header.flags |= Format::FLAG_BWT;
+        } else if (options.contextModel) {
+            header.flags |= Format::FLAG_CONTEXT;
+        }
+        if (options.adaptiveBlocks) {
+            BlockPlanner planner(blockSize);
+            bool ok = forEachChunk(inFile, std::max<std::size_t>(options.bufferSize, 4096),
+                [&](unsigned char *data, std::size_t size, uint64_t offset) {
+                    // 逐段加密后立即统计（该段仍在缓存中）
+                    Stats::Timer timer(stats, "block split");
+                    for (std::size_t done = 0; done < size; done += SPLIT_SEGMENT) {
+                        std::size_t step = std::min(size - done, SPLIT_SEGMENT);
+                        if (blockCipher) {
+                            blockCipher->encrypt(data + done, step, offset + done);
+                        }
+                        planner.add(data + done, step);
+                    }
+                }, stats);
+            if (!ok) {
+                std::cerr << "Error reading input file: " << inputFile << std::endl;
+                return false;
+            }
+            for (uint64_t rawSize : planner.finish()) {
+                header.blocks.push_back(Format::BlockEntry{0, 0, rawSize});
+            }
+            inFile.clear();
+            inFile.seekg(0, std::ios::beg);
+        } else {
+            for (uint64_t done = 0; done < totalLength; done += blockSize) {
+                header.blocks.push_back(Format::BlockEntry{0, 0, std::min<uint64_t>(blockSize, totalLength - done)});
+            }
+        }
+
+        // 2. 写出占位的文件头（块数已知，块索引稍后回填）；全部写完前使用临时文件名，出错时删除
+        std::string outputCompressedFile = outputPath(inputFile, options);
+        std::string partFile = outputCompressedFile + ".part";
+        std::ofstream outFile(partFile, std::ios::binary);
+        if (!outFile) {
+            std::cerr << "Error opening output file: " << outputCompressedFile << std::endl;
+            return false;
+        }
+        auto discard = [&]() {
+            outFile.close();
+            std::remove(partFile.c_str());
+        };
+        std::vector<unsigned char> headerBytes = Format::serializeHeader(header);
+        outFile.write(reinterpret_cast<const char *>(headerBytes.data()), headerBytes.size());
+
+        // 3. 每批读取 2 倍线程数的块并行压缩，按顺序写出
+        ThreadPool pool(options.threads);
+        std::size_t batchSize = pool.size() * 2;
+        std::vector<std::vector<unsigned char>> raw(batchSize), packed(batchSize);
+        std::vector<uint64_t> blockOffsets(batchSize);
+        std::vector<uint32_t> checksums(batchSize);
+        std::vector<char> succeeded(batchSize);
+        InputStream input(inFile);
+        uint64_t offset = 0;
+        uint64_t compressedSize = 0;
+        std::size_t storedBlocks = 0;
+        for (std::size_t first = 0; first < header.blocks.size(); first += batchSize) {
+            std::size_t count = std::min(batchSize, header.blocks.size() - first);
+            Stats::Timer readTimer(stats, "read");
+            uint64_t readOffset = offset;
+            for (std::size_t i = 0; i < count; i++) {
+                blockOffsets[i] = readOffset;
+                raw[i].resize(static_cast<std::size_t>(header.blocks[first + i].rawSize));
+                raw[i].resize(input.read(raw[i].data(), raw[i].size()));
+                readOffset += raw[i].size();
+            }
+            readTimer.stop();
+            Stats::Timer compressTimer(stats, "compress blocks");
+            pool.parallelFor(count, [&](std::size_t i) {
+                succeeded[i] = compressBlock(raw[i].data(), raw[i].size(), blockOffsets[i], blockCipher, options,
+                                             packed[i], checksums[i]);
+                // 块数据不超过块原始字节数，以块原始数据的起始偏移为密钥流位置，各块的密钥流互不重叠
+                if (succeeded[i] && payloadCipher) {
+                    payloadCipher->encrypt(packed[i].data(), packed[i].size(), blockOffsets[i]);
                 }
+            });
+            compressTimer.stop();
+            Stats::Timer writeTimer(stats, "write");
+            for (std::size_t i = 0; i < count; i++) {
+                Format::BlockEntry &entry = header.blocks[first + i];
+                if (!succeeded[i] || raw[i].empty() || raw[i].size() != entry.rawSize) {
+                    std::cerr << "Error compressing block " << first + i << " of " << inputFile << std::endl;
+                    discard();
+                    return false;
+                }
+                entry.offset = compressedSize;
+                entry.compressedSize = packed[i].size();
+                entry.checksum = checksums[i];
+                if (entry.compressedSize == entry.rawSize) {
+                    storedBlocks++;
+                }
+                outFile.write(reinterpret_cast<const char *>(packed[i].data()), packed[i].size());
+                compressedSize += packed[i].size();
+                offset += raw[i].size();
+            }
+        }
+        if (input.bad() || offset != totalLength) {
+            std::cerr << "Error reading input file: " << inputFile << std::endl;
+            discard();
+            return false;
+        }
+
+        // 4. 回填块索引，替换为正式文件名
+        headerBytes = Format::serializeHeader(header);
+        outFile.seekp(0, std::ios::beg);
+        outFile.write(reinterpret_cast<const char *>(headerBytes.data()), headerBytes.size());
+        if (!commitOutput(outFile, partFile, outputCompressedFile)) {
+            return false;
+        }
+
+        recordSizes(stats, totalLength, headerBytes.size() + compressedSize);
+        if (stats) {
+            stats->set("blocks", static_cast<double>(header.blocks.size()));
+            stats->set("stored_blocks", static_cast<double>(storedBlocks));
+        }
+        if (options.verbosity >= Verbosity::SUMMARY) {
+            std::cout << "********************************" << std::endl;
+            std::cout << "Original Data Size: " << totalLength << " bytes" << std::endl;
+            if (options.adaptiveBlocks) {
+                std::cout << "Blocks: " << header.blocks.size() << " adaptive, average "
+                          << (header.blocks.empty() ? 0 : totalLength / header.blocks.size()) << " bytes, ";
+            } else {
+                std::cout << "Blocks: " << header.blocks.size() << " x " << blockSize << " bytes, ";
+            }
+            std::cout << pool.size() << " threads";
+            if (lz) {
+                std::cout << ", LZ77 " << LZ77::levelName(options.lzLevel);
+            } else if (options.bwt) {
+                std::cout << ", BWT";
+            }
+            if (storedBlocks > 0) {
+                std::cout << ", " << storedBlocks << " stored raw";
             }
+            std::cout << std::endl;
+            std::cout << "Compressed Data Size: " << compressedSize << " bytes" << std::endl;
+            std::cout << "********************************" << std::endl;
+        }
+        return true;
+    }
+
+    // 函数: compressStreaming
+    // 作用: 流式压缩。第一遍按固定缓冲区统计字节频率，构建编码后第二遍逐块编码并写出，
+    //       内存占用只与缓冲区大小有关，与文件大小无关
+    bool compressStreaming(const std::string &inputFile,
+                           const std::string &senderInfo,
+                           const std::string &receiverInfo,
+                           bool encrypt,
+                           const std::string &key,
+                           const Compressor::Options &options,
+                           const Dictionary::Tables *dictionary,
+                           Stats *stats) {
+        std::size_t bufferSize = std::max<std::size_t>(options.bufferSize, 4096);
+        std::size_t syncInterval = options.syncInterval;
+        std::ifstream inFile(inputFile, std::ios::binary);
+        if (!inFile) {
+            std::cerr << "Error opening input file: " << inputFile << std::endl;
+            return false;
+        }
+
+        // 1. 第一遍：计算原始数据流的校验和，按需加密后统计各字节出现频率（使用共享字典时只计算校验和）
+        bool summary = options.verbosity >= Verbosity::SUMMARY;
+        std::vector<uint64_t> freq(options.contextModel ? 65536 : 256, 0);
+        unsigned char previous = 0;
+        uint64_t totalLength = 0;
+        uint32_t checksum = 0;
+        Format::Header header = makeHeader(0, encrypt, key, options);
+        Common::Cipher cipher = makeCipher(header, key);
+        recordParties(header, senderInfo, receiverInfo, cipher);
+        const Common::Cipher *streamCipher = encrypt && !(header.flags & Format::FLAG_CHACHA20) ? &cipher : nullptr;
+        bool ok = forEachChunk(inFile, bufferSize,
+            [&](unsigned char *data, std::size_t size, uint64_t offset) {
+                // 校验和、加密与频率统计融合为一遍
+                Stats::Timer timer(stats, dictionary ? "hash" : "histogram");
+                if (dictionary) {
+                    checksum = CRC32C::update(checksum, data, size);
+                } else if (options.contextModel) {
+                    Common::encryptAndCountPairs(data, size, offset, streamCipher, &checksum, previous, syncInterval,
+                                                 freq);
+                } else {
+                    Common::encryptAndCount(data, size, offset, streamCipher, &checksum, freq);
+                }
+                totalLength += size;
+            }, stats);
+        if (!ok) {
+            std::cerr << "Error reading input file: " << inputFile << std::endl;
+            return false;
+        }
+
+        // 2. 构建哈夫曼树，得到编码长度与范式编码
+        header.originalLength = totalLength;
+        header.checksum = checksum;
+        std::size_t encodedSize = 0;
+        std::unique_ptr<SymbolEncoder> encoder = dictionary ? dictionaryCodes(*dictionary, header, stats)
+                                                            : prepareCodes(freq, options, header, encodedSize, stats);
+        if (!encoder) {
+            return false;
         }
+        // 预计节省不明显时原样存储：第二遍只加密并写出（使用共享字典时无法预计编码后的大小，总是编码）
+        bool stored = !dictionary && chooseStored(header, encodedSize, stats);
+        if (stored) {
+            syncInterval = 0;
+        }
+        bool payloadEncrypted = Format::encryptsPayload(header);
+
+        if (summary) {
+            std::cout << "********************************" << std::endl;
+            std::cout << "Original Data Hash: 0x" << Common::hashToString(checksum) << std::endl;
+            std::cout << "Original Data Size: " << totalLength << " bytes" << std::endl;
+        }
+
+        // 3. 写出文件头（同步点个数已知，同步点索引先占位，编码完成后回填）；全部写完前使用临时文件名
+        std::string outputCompressedFile = outputPath(inputFile, options);
+        std::string partFile = outputCompressedFile + ".part";
+        std::ofstream outFile(partFile, std::ios::binary);
+        if (!outFile) {
+            std::cerr << "Error opening output file: " << outputCompressedFile << std::endl;
+            return false;
+        }
+        std::size_t syncCount = syncPointCount(totalLength, syncInterval);
+        if (syncInterval > 0) {
+            header.flags |= Format::FLAG_SYNC_POINTS;
+            header.syncInterval = syncInterval;
+            header.syncPoints.resize(syncCount);
+        }
+        std::vector<unsigned char> headerBytes = Format::serializeHeader(header);
+        outFile.write(reinterpret_cast<const char *>(headerBytes.data()), headerBytes.size());
+        std::vector<Format::SyncPoint> syncPoints;
+        syncPoints.reserve(syncCount);
+
+        // 4. 第二遍：逐块加密、编码，输出缓冲区写满后立即写出（原样存储时直接写出加密后的数据）
+        // 每段至多 bufferSize / 8 个字节，编码后不超过 bufferSize 字节，因此输出缓冲区预留 2 倍即可
+        std::vector<unsigned char> outBuffer;
+        Huffman::BitWriter writer(outBuffer);
+        writer.reserve(bufferSize * 2);
+        uint64_t compressedSize = 0;
+        uint32_t compressedHash = 0;
+        auto flush = [&]() {
+            if (payloadEncrypted) {
+                Stats::Timer timer(stats, "encrypt");
+                cipher.encrypt(outBuffer.data(), writer.size(), compressedSize);
+            }
+            Stats::Timer writeTimer(stats, "write");
+            outFile.write(reinterpret_cast<const char *>(outBuffer.data()), writer.size());
+            writeTimer.stop();
+            if (summary) {
+                Stats::Timer hashTimer(stats, "hash");
+                compressedHash = CRC32C::update(compressedHash, outBuffer.data(), writer.size());
+            }
+            compressedSize += writer.size();
+            writer.clear();
+        };
+        ok = forEachChunk(inFile, bufferSize,
+            [&](unsigned char *data, std::size_t size, uint64_t offset) {
+                if (stored) {
+                    if (encrypt) {
+                        Stats::Timer timer(stats, "encrypt");
+                        cipher.encrypt(data, size, offset);
+                    }
+                    Stats::Timer writeTimer(stats, "write");
+                    outFile.write(reinterpret_cast<const char *>(data), size);
+                    writeTimer.stop();
+                    if (summary) {
+                        Stats::Timer hashTimer(stats, "hash");
+                        compressedHash = CRC32C::update(compressedHash, data, size);
+                    }
+                    compressedSize += size;
+                    return;
+                }
+                // 分段加密并编码（每段加密后仍在缓存中），每段编码后检查输出缓冲区，保证其不明显超过 bufferSize
+                std::size_t done = 0;
+                while (done < size) {
+                    std::size_t step = std::min<std::size_t>(size - done, bufferSize / 8);
+                    if (streamCipher) {
+                        Stats::Timer timer(stats, "encrypt");
+                        streamCipher->encrypt(data + done, step, offset + done);
+                    }
+                    Stats::Timer timer(stats, "encode");
+                    encodeWithSync(data + done, step, offset + done, *encoder, writer,
+                                   compressedSize * 8, syncInterval, syncPoints);
+                    timer.stop();
+                    done += step;
+                    if (writer.size() >= bufferSize) {
+                        flush();
+                    }
+                }
+            }, stats);
         // 补齐最后不足8位的数据（低位补0）
-        if (bitcount > 0) {
-            byte <<= (8 - bitcount);
-            compressedData.push_back(byte);
+        writer.finish();
+        flush();
+        if (syncInterval > 0 && ok) {
+            ok = syncPoints.size() == syncCount;
+            header.syncPoints = syncPoints;
+            headerBytes = Format::serializeHeader(header);
+            outFile.seekp(0, std::ios::beg);
+            outFile.write(reinterpret_cast<const char *>(headerBytes.data()), headerBytes.size());
+        }
+        if (!ok) {
+            outFile.close();
+            std::remove(partFile.c_str());
+            std::cerr << "Error writing output file: " << outputCompressedFile << std::endl;
+            return false;
+        }
+        if (!commitOutput(outFile, partFile, outputCompressedFile)) {
+            return false;
+        }
+
+        recordSizes(stats, totalLength, headerBytes.size() + compressedSize);
+        if (summary) {
+            std::cout << "********************************" << std::endl;
+            std::cout << "Compressed Data Hash: 0x" << Common::hashToString(compressedHash) << std::endl;
+            std::cout << "Compressed Data Size: " << compressedSize << " bytes"
+                      << (stored ? " (stored raw)" : "") << std::endl;
+            std::cout << "********************************" << std::endl;
+        }
+        return true;
+    }
+
+    // 函数: compressInMemory
+    // 作用: 以内存映射方式读取整个文件并压缩，主要步骤：
+    //       1. 以内存映射方式读取原文件内容（原文件不会被修改）
+    //       2. 计算原始数据的校验和（记入文件头）、按需加密并统计各字节出现频率（上下文模式下为一阶频率），三者融合为一遍；
+    //          发送者和接收者信息记入文件头，不属于数据流
+    //       3. 构建哈夫曼树，得到各字节的编码长度（上下文模式下为各上下文的码表），并生成范式哈夫曼编码；
+    //          使用共享字典时跳过频率统计与建树，直接使用字典的码表，文件头中只记录字典 ID
+    //       4. 根据哈夫曼编码生成压缩数据（按位打包）；预计节省不明显时跳过编码，原样存储；
+    //          ChaCha20 加密不在第 2 步进行，而是在此并行加密压缩数据
+    //       5. 计算压缩数据的校验和（只用于显示），将文件头（含编码长度表）与压缩数据写入压缩文件
+    //       6. 显示压缩数据的最后16个字节（调试信息）
+    //       各步骤的耗时记录到 stats（可为空）
+    bool compressInMemory(const std::string &inputFile,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool encrypt,
+                          const std::string &key,
+                          const Compressor::Options &options,
+                          const Dictionary::Tables *dictionary,
+                          Stats *stats) {
+        // 1. 以写时复制方式映射输入文件：直接读取文件内容，加密时原地修改映射而不影响文件
+        Stats::Timer readTimer(stats, "read");
+        MappedFile input;
+        if (!input.open(inputFile, MappedFile::COPY_ON_WRITE)) {
+            std::cerr << "Error opening input file: " << inputFile << std::endl;
+            return false;
         }
+        input.adviseSequential();
+        readTimer.stop();
+        unsigned char *content = input.data();
+        std::size_t contentSize = input.size();
+        uint64_t totalLength = static_cast<uint64_t>(contentSize);
+
+        // 2. 计算原始数据（未压缩、未加密）的校验和（记入文件头，解压时校验）、按需加密
+        //    并统计各字节出现频率（上下文模式下为一阶频率），
+        //    三者按小段融合为一遍，数据只读写一次（多线程时各段的校验和按顺序合并）；
+        //    发送者和接收者信息记入文件头，解压时在解码前校验
+        bool summary = options.verbosity >= Verbosity::SUMMARY;
+        Format::Header header = makeHeader(totalLength, encrypt, key, options);
+        Common::Cipher cipher = makeCipher(header, key);
+        recordParties(header, senderInfo, receiverInfo, cipher);
+        bool chacha = (header.flags & Format::FLAG_CHACHA20) != 0;
+        const Common::Cipher *contentCipher = encrypt && !chacha ? &cipher : nullptr;
+        Stats::Timer histogramTimer(stats, dictionary ? "hash" : "histogram");
+        std::vector<uint64_t> freq;
+        if (dictionary) {
+            Common::checksumAndEncrypt(content, contentSize, 0, contentCipher, &header.checksum);
+        } else if (options.contextModel) {
+            unsigned char previous = 0;
+            Common::encryptAndCountPairs(content, contentSize, 0, contentCipher, &header.checksum, previous,
+                                         options.syncInterval, freq, options.threads);
+        } else {
+            Common::encryptAndCount(content, contentSize, 0, contentCipher, &header.checksum, freq, options.threads);
+        }
+        histogramTimer.stop();
+
+        // 3. 构建哈夫曼树，得到各字节的编码长度，再由编码长度生成范式哈夫曼编码，记入文件头
+        std::size_t encodedSize = contentSize;
+        std::unique_ptr<SymbolEncoder> encoder = dictionary ? dictionaryCodes(*dictionary, header, stats)
+                                                            : prepareCodes(freq, options, header, encodedSize, stats);
+        if (!encoder) {
+            return false;
+        }
+        // 预计节省不明显时原样存储，跳过编码，直接写出（加密后的）数据流；使用共享字典时在编码后按实际大小判断
+        bool stored = !dictionary && chooseStored(header, encodedSize, stats);
+
+        // 4. 显示原始数据的校验和
+        if (summary) {
+            std::cout << "********************************" << std::endl;
+            std::cout << "Original Data Hash: 0x" << Common::hashToString(header.checksum) << std::endl;
+            std::cout << "Original Data Size: " << totalLength << " bytes" << std::endl;
+        }
+
+        // 5. 生成压缩数据：将每个字节的哈夫曼编码按位打包（输出数组按编码总长度预先分配），并按需记录同步点；
+        //    使用共享字典时若编码后节省不明显（数据与字典的字节分布不符），改为原样存储
+        std::vector<unsigned char> compressedData;
+        if (!stored) {
+            Stats::Timer encodeTimer(stats, "encode");
+            Huffman::BitWriter writer(compressedData);
+            writer.reserve(encodedSize);
+            encodeWithSync(content, contentSize, 0, *encoder, writer, 0, options.syncInterval, header.syncPoints);
+            // 补齐最后不足8位的数据（低位补0）
+            writer.finish();
+            encodeTimer.stop();
+            stored = dictionary && chooseStored(header, compressedData.size(), stats);
+            if (stored) {
+                std::vector<unsigned char>().swap(compressedData);
+            } else {
+                input.close();
+                if (options.syncInterval > 0) {
+                    header.flags |= Format::FLAG_SYNC_POINTS;
+                    header.syncInterval = options.syncInterval;
+                }
+            }
+        }
+        // ChaCha20 加密编码后的数据（原样存储时为原始数据流）
+        if (chacha) {
+            Stats::Timer encryptTimer(stats, "encrypt");
+            if (stored) {
+                cipher.encrypt(content, contentSize, 0, options.threads);
+            } else {
+                cipher.encrypt(compressedData.data(), compressedData.size(), 0, options.threads);
+            }
+        }
+        uint64_t payloadSize = stored ? totalLength : compressedData.size();
         
-        // 14. 显示压缩数据的 HASH 值及文件大小（调试用）
-        std::cout << "********************************" << std::endl;
-        std::string CompressedDataHash = Common::calculateHash(compressedData);
-        std::cout << "Compressed Data Hash: 0x" << CompressedDataHash << std::endl;
-        std::cout << "Compressed Data Size: " << compressedData.size() << " bytes" << std::endl;
-
-        // 15. 将压缩数据写入输出文件，文件名格式：原文件名.hfm
-        std::string outputCompressedFile = "test/" + Common::extractFileName(inputFile) + ".hfm";
-        std::ofstream outFile(outputCompressedFile, std::ios::binary);
+        // 6. 显示压缩数据的校验和及文件大小（调试用）
+        if (summary) {
+            Stats::Timer timer(stats, "hash");
+            std::cout << "********************************" << std::endl;
+            std::string CompressedDataHash = stored
+                ? Common::hashToString(CRC32C::update(0, content, contentSize))
+                : Common::calculateHash(compressedData);
+            std::cout << "Compressed Data Hash: 0x" << CompressedDataHash << std::endl;
+            std::cout << "Compressed Data Size: " << payloadSize << " bytes"
+                      << (stored ? " (stored raw)" : "") << std::endl;
+        }
+
+        // 7. 将文件头与压缩数据写入输出文件，文件名格式：原文件名.hfm
+        Stats::Timer writeTimer(stats, "write");
+        std::string outputCompressedFile = outputPath(inputFile, options);
+        std::string partFile = outputCompressedFile + ".part";
+        std::ofstream outFile(partFile, std::ios::binary);
         if (!outFile) {
             std::cerr << "Error opening output file: " << outputCompressedFile << std::endl;
-            return;
+            return false;
         }
-        outFile.write(reinterpret_cast<const char *>(compressedData.data()), compressedData.size());
-        outFile.close();
+        std::vector<unsigned char> headerBytes = Format::serializeHeader(header);
+        outFile.write(reinterpret_cast<const char *>(headerBytes.data()), headerBytes.size());
+        if (stored) {
+            outFile.write(reinterpret_cast<const char *>(content), contentSize);
+            input.close();
+        } else {
+            outFile.write(reinterpret_cast<const char *>(compressedData.data()), compressedData.size());
+        }
+        if (!commitOutput(outFile, partFile, outputCompressedFile)) {
+            return false;
+        }
+        writeTimer.stop();
+        recordSizes(stats, totalLength, headerBytes.size() + payloadSize);
 
-        // 16. 显示压缩数据的最后 16 个字节（便于调试查看数据尾部）
-        std::cout << "********************************" << std::endl;
-        std::cout << "Last 16 Bytes of Compressed Data:" << std::endl;
-        int startPos = std::max(0, static_cast<int>(compressedData.size()) - 16);
-        for (int i = startPos; i < compressedData.size(); i++) {
-            std::cout << "0x" << std::hex << std::uppercase << std::setw(2) 
-                      << std::setfill('0') << static_cast<int>(compressedData[i]) << " ";
+        // 8. 显示压缩数据的最后 16 个字节（便于调试查看数据尾部）
+        if (options.verbosity >= Verbosity::DEBUG) {
+            std::cout << "********************************" << std::endl;
+            std::cout << "Last 16 Bytes of Compressed Data:" << std::endl;
+            std::size_t startPos = compressedData.size() > 16 ? compressedData.size() - 16 : 0;
+            for (std::size_t i = startPos; i < compressedData.size(); i++) {
+                std::cout << "0x" << std::hex << std::uppercase << std::setw(2) 
+                          << std::setfill('0') << static_cast<int>(compressedData[i]) << " ";
+            }
+            std::cout << std::dec << std::endl;
+            std::cout << "********************************" << std::endl;
         }
-        std::cout << std::dec << std::endl;
-        std::cout << "********************************" << std::endl;
+        return true;
+    }
+}
 
-        // 17. 释放为构造哈夫曼树而申请的所有内存
-        deleteTree(huffmanTreeRoot);
+namespace Compressor {
+    // 函数: compressFile
+    // 用途: 对指定文件进行压缩：默认以内存映射方式整体压缩，见 compressInMemory；
+    //       启用流式模式时改为分块读取与编码，见 compressStreaming；
+    //       启用分块模式时各块独立建表并行压缩，见 compressBlocks；
+    //       启用自适应分块时在字节分布变化处切分块，见 BlockPlanner；
+    //       设置同步点间隔时在文件头中记录同步点索引，供解压时多线程并行解码；
+    //       启用上下文模式时以前一字节为上下文选择码表（各模式均适用），见 buildContextTables；
+    //       指定共享字典时使用字典的码表（单一码表模式，上下文模式由字典决定），见 trainDictionary；
+    //       启用 LZ77 前端时总是分块压缩，各块先转换为字面量与匹配再编码，见 compressMatches；
+    //       启用 BWT 变换时总是分块压缩，各块经 BWT、前移变换与零游程编码后再编码，见 compressTransformed；
+    //       各模式下由码表预计的编码后字节数节省不明显时（已压缩或已加密的数据）原样存储，见 storeRaw；
+    //       设置统计信息输出目标时记录各阶段耗时与字节数、WPL、压缩率、熵等指标并输出
+    //
+    // 参数:
+//    inputFile    - 输入文件路径
+//    senderInfo   - 发送者信息
+//    receiverInfo - 接收者信息
+//    encrypt      - 是否启用加密（默认为 false）
+//    key          - 加密密钥（默认为空字符串）
+//    options      - 压缩选项
+    //
+    // 返回:
+    //    压缩成功返回 true，出错时（错误信息已输出到标准错误）返回 false
+    bool compressFile(const std::string &inputFile,
+                      const std::string &senderInfo,
+                      const std::string &receiverInfo,
+                      bool encrypt,
+                      const std::string &key,
+                      const Options &options) {
+        Stats stats;
+        Stats *collector = options.statsFile.empty() ? nullptr : &stats;
+        bool lz = options.lzLevel != LZ77::Level::NONE;
+        bool blocks = options.blockSize > 0 || options.adaptiveBlocks || lz || options.bwt;
+        const char *mode = options.adaptiveBlocks ? "adaptive blocks"
+                           : blocks ? "blocks" : options.streaming ? "streaming" : "memory";
+        if (collector) {
+            stats.set("file", inputFile);
+            stats.set("operation", "compress");
+            stats.set("mode", mode);
+            if (lz) {
+                stats.set("lz77", LZ77::levelName(options.lzLevel));
+            }
+            if (options.bwt) {
+                stats.set("transform", "bwt");
+            }
+            if (encrypt && options.chacha20) {
+                stats.set("cipher", "chacha20");
+                stats.set("chacha20_impl", ChaCha20::implementationName(ChaCha20::detect()));
+            } else if (encrypt) {
+                stats.set("cipher", key.empty() ? "offset" : "xor");
+            }
+        }
+        if (static_cast<int>(lz) + static_cast<int>(options.bwt) + static_cast<int>(options.contextModel) > 1) {
+            std::cerr << "The LZ77 front end, the BWT transform and the context model cannot be combined" << std::endl;
+            return false;
+        }
+        if (encrypt && options.chacha20 && key.empty()) {
+            std::cerr << "ChaCha20 encryption requires a key" << std::endl;
+            return false;
+        }
+        std::shared_ptr<const Dictionary::Tables> dictionary;
+        if (!options.dictionaryFile.empty()) {
+            if (blocks) {
+                std::cerr << "A shared dictionary cannot be combined with blocks, the LZ77 front end or the BWT transform"
+                          << std::endl;
+                return false;
+            }
+            dictionary = Dictionary::open(options.dictionaryFile);
+            if (!dictionary) {
+                return false;
+            }
+        }
+        auto startTime = std::chrono::steady_clock::now();
+        bool ok;
+        if (blocks) {
+            ok = compressBlocks(inputFile, senderInfo, receiverInfo, encrypt, key, options, collector);
+        } else if (options.streaming) {
+            ok = compressStreaming(inputFile, senderInfo, receiverInfo, encrypt, key, options, dictionary.get(),
+                                   collector);
+        } else {
+            ok = compressInMemory(inputFile, senderInfo, receiverInfo, encrypt, key, options, dictionary.get(),
+                                  collector);
+        }
+        if (collector) {
+            auto endTime = std::chrono::steady_clock::now();
+            stats.set("status", ok ? "ok" : "failed");
+            stats.set("total_ms", std::chrono::duration<double, std::milli>(endTime - startTime).count());
+            stats.write(options.statsFile, options.statsFormat);
+        }
+        return ok;
     }
-}
\ No newline at end of file
+
+    // 函数: trainDictionary
+    // 用途: 由样本文件训练共享字典，主要步骤：
+    //       1. 统计全部样本的字节频率（上下文模式下为一阶频率，各样本开头以 0 为上下文，与压缩时相同）
+    //       2. 构建码表：单一码表由各字节频率加 1 构建，使样本中未出现的字节值也有编码；
+    //          上下文模式下先由 buildContextTables 选出使用自己码表的上下文，
+    //          再由各码表所含上下文的频率之和加 1 重新构建各码表
+    //       3. 写出字典文件并显示字典 ID
+    //
+    // 参数:
+//    sampleFiles - 样本文件
+//    options     - 训练选项（dictionaryFile、contextModel、maxCodeLength、threads、verbosity）
+    //
+    // 返回:
+    //    训练成功返回 true，出错时（错误信息已输出到标准错误）返回 false
+    bool trainDictionary(const std::vector<std::string> &sampleFiles, const Options &options) {
+        if (options.dictionaryFile.empty()) {
+            std::cerr << "No dictionary file" << std::endl;
+            return false;
+        }
+        // 1. 统计样本的字节频率
+        bool debug = options.verbosity >= Verbosity::DEBUG;
+        std::vector<uint64_t> freq(options.contextModel ? 65536 : 256, 0);
+        uint64_t totalLength = 0;
+        for (const std::string &sample : sampleFiles) {
+            MappedFile input;
+            if (!input.open(sample, MappedFile::READ_ONLY)) {
+                std::cerr << "Error opening input file: " << sample << std::endl;
+                return false;
+            }
+            if (options.contextModel) {
+                unsigned char previous = 0;
+                Common::countPairs(input.data(), input.size(), previous, 0, options.syncInterval, freq,
+                                   options.threads);
+            } else {
+                Common::countBytes(input.data(), input.size(), freq, options.threads);
+            }
+            totalLength += input.size();
+        }
+
+        // 2. 构建码表，每张码表都为全部 256 个字节值分配编码
+        Dictionary::Tables tables;
+        tables.contextual = options.contextModel;
+        bool ok;
+        if (options.contextModel) {
+            uint64_t codedBits = 0;
+            ok = buildContextTables(freq, options.maxCodeLength, debug, tables.contexts, codedBits, nullptr);
+            std::vector<std::vector<uint64_t>> tableFreq(tables.contexts.lengths.size(), std::vector<uint64_t>(256, 0));
+            for (unsigned context = 0; context < 256; context++) {
+                std::vector<uint64_t> &target = tableFreq[tables.contexts.tableOf[context]];
+                for (unsigned symbol = 0; symbol < 256; symbol++) {
+                    target[symbol] += freq[context * 256 + symbol];
+                }
+            }
+            for (std::size_t t = 0; ok && t < tableFreq.size(); t++) {
+                ok = smoothedLengths(tableFreq[t], options.maxCodeLength, false, tables.contexts.lengths[t]);
+            }
+        } else {
+            ok = smoothedLengths(freq, options.maxCodeLength, debug, tables.codeLengths);
+        }
+        if (!ok) {
+            std::cerr << "Error building dictionary tables" << std::endl;
+            return false;
+        }
+
+        // 3. 写出字典文件
+        tables.id = Dictionary::computeId(tables);
+        if (!Dictionary::save(options.dictionaryFile, tables)) {
+            return false;
+        }
+        if (options.verbosity >= Verbosity::SUMMARY) {
+            std::cout << "Dictionary ID: 0x" << Common::hashToString(tables.id) << " ("
+                      << (tables.contextual ? tables.contexts.lengths.size() : 1) << " tables, "
+                      << sampleFiles.size() << " samples, " << totalLength << " bytes)" << std::endl;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,199 @@
+#include "crc32c.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_X86 1
+#include <nmmintrin.h>
+#endif
+
+namespace {
+    // Castagnoli 多项式的反射形式（低位在前）
+    constexpr uint32_t POLY = 0x82F63B78u;
+
+    // 类: Tables
+    // 用途: slicing-by-8 的查表：table[k][b] 为字节 b 之后再经过 k 个零字节的 CRC，
+    //       每次读取 8 个字节，各字节分别查表后异或即得到处理这 8 个字节后的 CRC
+    struct Tables {
+        uint32_t table[8][256];
+
+        Tables() {
+            for (uint32_t b = 0; b < 256; b++) {
+                uint32_t crc = b;
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = (crc & 1) ? (crc >> 1) ^ POLY : crc >> 1;
+                }
+                table[0][b] = crc;
+            }
+            for (uint32_t b = 0; b < 256; b++) {
+                for (int k = 1; k < 8; k++) {
+                    table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+                }
+            }
+        }
+    };
+
+    const Tables &tables() {
+        static const Tables instance;
+        return instance;
+    }
+
+    // 函数: updateSlicing
+    // 用途: slicing-by-8 实现（crc 为未取反的内部状态）
+    uint32_t updateSlicing(uint32_t crc, const unsigned char *data, std::size_t size) {
+        const uint32_t (*t)[256] = tables().table;
+        while (size >= 8) {
+            // 按小端序组合前 4 个字节，与平台的字节序无关
+            uint32_t low = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+            low ^= crc;
+            crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+                  t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+            data += 8;
+            size -= 8;
+        }
+        while (size-- > 0) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+        }
+        return crc;
+    }
+
+#ifdef CRC32C_X86
+    // 函数: updateSse42
+    // 用途: crc32 指令实现：先逐字节对齐到 8 字节边界，再每次处理 8 个字节（32 位平台每次 4 个字节）
+    __attribute__((target("sse4.2")))
+    uint32_t updateSse42(uint32_t crc, const unsigned char *data, std::size_t size) {
+        while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+            crc = _mm_crc32_u8(crc, *data++);
+            size--;
+        }
+#ifdef __x86_64__
+        uint64_t state = crc;
+        while (size >= 8) {
+            uint64_t word;
+            std::memcpy(&word, data, 8);
+            state = _mm_crc32_u64(state, word);
+            data += 8;
+            size -= 8;
+        }
+        crc = static_cast<uint32_t>(state);
+#else
+        while (size >= 4) {
+            uint32_t word;
+            std::memcpy(&word, data, 4);
+            crc = _mm_crc32_u32(crc, word);
+            data += 4;
+            size -= 4;
+        }
+#endif
+        while (size-- > 0) {
+            crc = _mm_crc32_u8(crc, *data++);
+        }
+        return crc;
+    }
+#endif
+
+    // 函数: multiply
+    // 用途: GF(2) 上模多项式的乘法 a * b mod P（反射表示，最高位为 x^0）
+    uint32_t multiply(uint32_t a, uint32_t b) {
+        uint32_t m = 1u << 31;
+        uint32_t product = 0;
+        while (true) {
+            if (a & m) {
+                product ^= b;
+                if ((a & (m - 1)) == 0) {
+                    break;
+                }
+            }
+            m >>= 1;
+            b = (b & 1) ? (b >> 1) ^ POLY : b >> 1;
+        }
+        return product;
+    }
+
+    // 类: Powers
+    // 用途: power[k] = x^(2^k) mod P，用于计算 x^(8n) mod P（在一段数据之后追加 n 个零字节）
+    struct Powers {
+        uint32_t power[32];
+
+        Powers() {
+            uint32_t p = 1u << 30; // x^1
+            power[0] = p;
+            for (int k = 1; k < 32; k++) {
+                power[k] = p = multiply(p, p);
+            }
+        }
+    };
+
+    // 函数: shiftBytes
+    // 用途: 计算 x^(8n) mod P
+    uint32_t shiftBytes(uint64_t n) {
+        static const Powers powers;
+        uint32_t p = 1u << 31; // x^0
+        for (unsigned k = 3; n != 0; n >>= 1, k++) {
+            if (n & 1) {
+                p = multiply(powers.power[k & 31], p);
+            }
+        }
+        return p;
+    }
+
+    // 当前 CPU 支持的最快实现（首次使用时检测）
+    CRC32C::Implementation best() {
+        static const CRC32C::Implementation implementation = CRC32C::detect();
+        return implementation;
+    }
+}
+
+namespace CRC32C {
+    // 函数: supported
+    // 用途: SSE4.2 实现须在运行时确认 CPU 支持
+    bool supported(Implementation implementation) {
+        switch (implementation) {
+        case Implementation::SLICING_BY_8:
+            return true;
+        case Implementation::SSE42:
+#ifdef CRC32C_X86
+            return __builtin_cpu_supports("sse4.2");
+#endif
+            return false;
+        }
+        return false;
+    }
+
+    Implementation detect() {
+        return supported(Implementation::SSE42) ? Implementation::SSE42 : Implementation::SLICING_BY_8;
+    }
+
+    const char *implementationName(Implementation implementation) {
+        switch (implementation) {
+        case Implementation::SLICING_BY_8:
+            return "slicing-by-8";
+        case Implementation::SSE42:
+            return "sse4.2";
+        }
+        return "unknown";
+    }
+
+    uint32_t update(uint32_t crc, const unsigned char *data, std::size_t size) {
+        return update(crc, data, size, best());
+    }
+
+    // 函数: update
+    // 用途: 校验和在计算前后取反（初值与结果异或 0xFFFFFFFF），因此首段传入 0 即可
+    uint32_t update(uint32_t crc, const unsigned char *data, std::size_t size, Implementation implementation) {
+        crc = ~crc;
+#ifdef CRC32C_X86
+        if (implementation == Implementation::SSE42) {
+            return ~updateSse42(crc, data, size);
+        }
+#endif
+        return ~updateSlicing(crc, data, size);
+    }
+
+    // 函数: combine
+    // 用途: CRC 是线性的：前一段之后追加 secondSize 个字节的 CRC，等于前一段的 CRC 乘以 x^(8 * secondSize)
+    //       再与后一段自身的 CRC 异或（取反的初值与结果在异或时相互抵消）
+    uint32_t combine(uint32_t first, uint32_t second, uint64_t secondSize) {
+        return multiply(shiftBytes(secondSize), first) ^ second;
+    }
+}
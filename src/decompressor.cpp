@@ -1,8 +1,23 @@
 #include "decompressor.h"
+#include "bwt.h"
 #include "common.h"
+#include "crc32c.h"
+#include "dictionary.h"
+#include "format.h"
+#include "huffman.h"
+#include "lz77.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -10,340 +25,1631 @@
 
 // 定义命名空间 Trie，用于构建字典树（Trie）解码时使用
 namespace Trie {
-    // 字典树节点结构体，用于存储每个节点的信息
+    // 子节点引用：0 表示无子节点；设置 LEAF 位时低 15 位为叶子的符号值（字节值或 LZ77 符号）；否则为内部节点的下标
+    constexpr uint16_t LEAF = 0x8000;
+
+    // 字典树节点结构体：只保存两个 16 位子节点引用（4 字节），叶子不单独占用节点
     struct Node {
-        unsigned char value;  // 叶子节点存储的字节值
-        bool isLeaf;          // 标记是否为叶子节点
-        Node* left;           // 指向左子节点（代表编码中的 '0'）
-        Node* right;          // 指向右子节点（代表编码中的 '1'）
+        uint16_t child[2]; // child[0] 代表编码中的 '0'，child[1] 代表编码中的 '1'
+    };
+
+    // 类: Tree
+    // 用途: 字典树。全部内部节点连续存放在一个数组中（n 个符号的完整前缀码有 n - 1 个内部节点：
+    //       字节码表至多 255 个、约 1 KB，LZ77 字面量/长度码表至多 285 个），
+    //       随 Tree 一次释放，不再逐个节点申请与释放内存；根节点下标为 0
+    class Tree {
+    public:
+        Tree() : nodes(1, Node{{0, 0}}) {}
+
+        // 按符号个数预留内部节点的空间
+        void reserve(std::size_t symbols) {
+            nodes.reserve(std::max<std::size_t>(symbols, 2) - 1);
+        }
+
+        // 函数: insert
+        // 作用: 将指定的哈夫曼编码（字符串形式）和对应的字节值插入到字典树中
+        //
+        // 参数:
+        //    code   - 哈夫曼编码字符串（由 '0' 和 '1'组成，至少 1 位）
+        //    symbol - 编码对应的符号值（小于 LEAF）
+        //
+        // 返回:
+        //    编码与已有编码冲突（不满足前缀性质）或节点个数超出下标范围时返回 false
+        bool insert(const std::string &code, uint16_t symbol) {
+            uint16_t current = 0;
+            for (std::size_t i = 0; i < code.size(); i++) {
+                uint16_t &child = nodes[current].child[code[i] == '0' ? 0 : 1];
+                if (i + 1 == code.size()) {
+                    if (child != 0) {
+                        return false;
+                    }
+                    child = LEAF | symbol;
+                    return true;
+                }
+                if (child & LEAF) {
+                    return false;
+                }
+                if (child == 0) {
+                    if (nodes.size() >= LEAF) {
+                        return false;
+                    }
+                    child = static_cast<uint16_t>(nodes.size());
+                    nodes.push_back(Node{{0, 0}}); // 此后 child 引用失效，下面不再使用
+                }
+                current = nodes[current].child[code[i] == '0' ? 0 : 1];
+            }
+            return false;
+        }
+
+        const Node *data() const { return nodes.data(); }
 
-        // 构造函数，初始化成员变量
-        Node() : value(0), isLeaf(false), left(nullptr), right(nullptr) {}
+    private:
+        std::vector<Node> nodes;
     };
+}
 
-    // 函数: insert
-    // 作用: 将指定的哈夫曼编码（字符串形式）和对应的字节值插入到字典树中
-    //
-    // 参数:
-    //    root      - 字典树根节点
-    //    code      - 哈夫曼编码字符串（由 '0' 和 '1'组成）
-    //    byteValue - 编码对应的字节值
-    void insert(Node* root, const std::string &code, unsigned char byteValue) {
-        Node* current = root;
-        for (char c : code) {
-            if (c == '0') {
-                if (!current->left) {
-                    current->left = new Node();
+// 匿名命名空间：三种解码方式（解码引擎）及其共用的读取、校验与输出步骤
+namespace {
+    constexpr uint32_t INVALID_SYMBOL = Huffman::DecodeTable::INVALID_SYMBOL;
+
+    // 函数: codeToString
+    // 用途: 将整数形式的哈夫曼编码转换为由 '0' 和 '1' 组成的字符串
+    std::string codeToString(const Huffman::Code &code) {
+        std::string result;
+        for (int bit = static_cast<int>(code.length) - 1; bit >= 0; bit--) {
+            result += ((code.bits >> bit) & 1) ? '1' : '0';
+        }
+        return result;
+    }
+
+    // 类: TrieEngine
+    // 用途: 字典树解码，逐位沿字典树向下走，到达叶子节点即得到一个符号
+    class TrieEngine {
+    public:
+        bool build(const std::vector<Huffman::Code> &codes) {
+            trie.reserve(static_cast<std::size_t>(std::count_if(codes.begin(), codes.end(),
+                [](const Huffman::Code &code) { return code.length > 0; })));
+            for (const Huffman::Code &code : codes) {
+                if (code.length > 0 && !trie.insert(codeToString(code), static_cast<uint16_t>(code.symbol))) {
+                    return false;
                 }
-                current = current->left;
-            } else {
-                if (!current->right) {
-                    current->right = new Node();
+            }
+            return true;
+        }
+
+        inline uint32_t decode(Huffman::BitReader &reader) const {
+            const Trie::Node *nodes = trie.data();
+            uint16_t current = 0;
+            do {
+                current = nodes[current].child[reader.readBit()];
+                if (current == 0) {
+                    return INVALID_SYMBOL;
+                }
+            } while (!(current & Trie::LEAF));
+            return current & ~Trie::LEAF;
+        }
+
+    private:
+        Trie::Tree trie;
+    };
+
+    // 类: HashEngine
+    // 用途: 哈希映射解码，逐位构建编码串并在哈希表中查找对应符号
+    class HashEngine {
+    public:
+        bool build(const std::vector<Huffman::Code> &codes) {
+            for (const Huffman::Code &code : codes) {
+                if (code.length > 0) {
+                    codeMap[codeToString(code)] = code.symbol;
+                    maxLength = std::max(maxLength, code.length);
+                }
+            }
+            return true;
+        }
+
+        inline uint32_t decode(Huffman::BitReader &reader) const {
+            std::string buffer;
+            while (buffer.size() < maxLength) {
+                buffer += reader.readBit() ? '1' : '0';
+                auto it = codeMap.find(buffer);
+                if (it != codeMap.end()) {
+                    return it->second;
                 }
-                current = current->right;
             }
+            return INVALID_SYMBOL;
         }
-        current->isLeaf = true;
-        current->value = byteValue;
+
+    private:
+        std::unordered_map<std::string, uint32_t> codeMap;
+        unsigned maxLength = 0;
+    };
+
+    // 类: TableEngine
+    // 用途: 多位查表解码，见 Huffman::DecodeTable
+    class TableEngine {
+    public:
+        bool build(const std::vector<Huffman::Code> &codes) {
+            return table.build(codes);
+        }
+
+        inline uint32_t decode(Huffman::BitReader &reader) const {
+            return table.decode(reader);
+        }
+
+    private:
+        Huffman::DecodeTable table;
+    };
+
+    // 函数: decodeSymbols
+    // 用途: 使用指定解码引擎从比特流中连续解码 count 个字节
+    //
+    // 返回:
+    //    遇到无效编码时返回 false
+    template<typename Engine>
+    bool decodeSymbols(const Engine &engine, Huffman::BitReader &reader, unsigned char *out, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            uint32_t symbol = engine.decode(reader);
+            if (symbol == INVALID_SYMBOL) {
+                return false;
+            }
+            out[i] = static_cast<unsigned char>(symbol);
+        }
+        return true;
     }
 
-    // 函数: free
-    // 作用: 递归释放整个字典树中分配的内存空间
-    void free(Node* root) {
-        if (!root) {
-            return;
+    // 一次解压请求的全部参数
+    struct Request {
+        std::string engineName;     // 解码方式名称（用于输出耗时信息）
+        std::string compressedFile; // 压缩文件路径
+        std::string senderInfo;     // 发送者信息（用于校验）
+        std::string receiverInfo;   // 接收者信息（用于校验）
+        bool decrypt;               // 是否需要解密
+        std::string key;            // 解密密钥
+        Decompressor::Options options;
+        std::chrono::high_resolution_clock::time_point startTime;
+        Stats *stats;               // 统计信息收集器（未设置输出目标时为空）
+        uint64_t memberOffset = 0;  // 压缩数据在文件中的起始偏移（归档中的成员），否则为 0
+        uint64_t memberSize = 0;    // 压缩数据的字节数，0 表示直到文件末尾
+
+        // 是否需要显示或统计解压数据的校验和（文件头记录了校验和时总是计算并校验）
+        bool wantHash() const { return options.verbosity >= Verbosity::SUMMARY || stats; }
+    };
+
+    // 内存映射解压时顺序解码的每段字节数：每段解码后随即解密并计算校验和，该段仍在缓存中
+    constexpr std::size_t DECODE_TILE = std::size_t(64) << 10;
+
+    // 函数: checkEncryption
+    // 用途: 校验解密选项与文件头中的加密标志是否一致（ChaCha20 加密的文件须提供密钥）
+    bool checkEncryption(const Format::Header &header, const Request &request) {
+        bool encrypted = (header.flags & Format::FLAG_ENCRYPTED) != 0;
+        if (encrypted != request.decrypt) {
+            std::cerr << "Encryption option mismatch: file is " << (encrypted ? "" : "not ") << "encrypted" << std::endl;
+            return false;
+        }
+        if ((header.flags & Format::FLAG_CHACHA20) && request.key.empty()) {
+            std::cerr << "File is encrypted with ChaCha20 and requires a key" << std::endl;
+            return false;
         }
-        free(root->left);
-        free(root->right);
-        delete root;
+        return true;
     }
-}
 
-namespace TrieDecompressor {
-    // 函数: decompressFile
-    // 用途: 使用字典树方式（Trie）解压压缩文件，主要步骤：
-    //       1. 记录解压开始时间
-    //       2. 读取编码表（test/code.txt）并构建字典树
-    //       3. 读取压缩文件内容
-    //       4. 逐位遍历压缩数据，通过字典树进行解码
-    //       5. 若设置了解密，则进行解密处理
-    //       6. 校验收发人信息（与文件中存储信息比较）
-    //       7. 将解压后的数据写入输出文件
-    //       8. 显示解压过程的 HASH 值、数据大小及解压所耗时间
+    // 函数: makeCipher
+    // 用途: 按文件头中的加密方式创建解密器（ChaCha20 加密时由密钥与文件头中的随机盐派生密钥）
+    Common::Cipher makeCipher(const Format::Header &header, const std::string &key) {
+        if (header.flags & Format::FLAG_CHACHA20) {
+            return Common::Cipher(key, header.salt.data(), header.salt.size(), header.kdfIterations, header.nonce);
+        }
+        return Common::Cipher(key);
+    }
+
+    // 函数: buildEngine
+    // 用途: 由编码长度重建范式哈夫曼编码并构建解码引擎
     //
     // 参数:
-//    compressedFile - 压缩文件路径
-//    senderInfo     - 发送者信息（用于校验）
-//    receiverInfo   - 接收者信息（用于校验）
-//    decrypt        - 是否需要解密
-//    key            - 解密密钥
-    void decompressFile(const std::string &compressedFile,
-                        const std::string &senderInfo,
-                        const std::string &receiverInfo,
-                        bool decrypt,
-                        const std::string &key) {
-        // 1. 记录解压缩开始时间
-        auto startTime = std::chrono::high_resolution_clock::now();
-
-        // 2. 读取编码表，构建字典树用于解码
-        std::string encodedPath = "test/code.txt";
-        std::ifstream encodedTable(encodedPath);
-        if (!encodedTable) {
-            std::cerr << "Error opening encoded table file: " << encodedPath << std::endl;
-            return;
+    //    lengths   - 各符号的编码长度
+    //    engine    - 待构建的解码引擎
+    //    maxLength - 输出：最长编码的位数（至少为 1）
+    //    symbols   - 符号个数（默认为 256 个字节值）
+    template<typename Engine>
+    bool buildEngine(const uint8_t *lengths, Engine &engine, unsigned &maxLength, std::size_t symbols = 256) {
+        std::vector<Huffman::Code> codes = Huffman::canonicalCodes(std::vector<uint8_t>(lengths, lengths + symbols));
+        if (codes.empty() || !engine.build(codes)) {
+            std::cerr << "Invalid Huffman code lengths" << std::endl;
+            return false;
         }
-        std::string line;
-        std::getline(encodedTable, line);
-        // 第一行为原始文本字节长度
-        int TextLength = std::stoi(line);
-        
-        // 创建字典树的根节点
-        Trie::Node *root = new Trie::Node();
-        // 逐行读取编码表并插入到字典树中
-        while (std::getline(encodedTable, line)) {
-            if (line.empty()) continue;
-
-            std::stringstream ss(line);
-            std::string byteCodeStr; // 含 "0x" 前缀的字节码
-            std::string lengthStr;   // 含 "0x" 前缀的编码长度
-            ss >> byteCodeStr >> lengthStr;
-            byteCodeStr = byteCodeStr.substr(2);
-            lengthStr = lengthStr.substr(2);
-            unsigned char byteCode = static_cast<unsigned char>(std::stoi(byteCodeStr, nullptr, 16));
-            int length = std::stoi(lengthStr, nullptr, 16);
-            // 读取编码字节，将其转换为二进制字符串形式
-            std::string bitCodedStr;
-            std::string bitStream;
-            while (ss >> bitCodedStr) {
-                bitCodedStr = bitCodedStr.substr(2);
-                std::string byteStr = Common::hexToBinary(bitCodedStr);
-                bitStream += byteStr;
-            }
-            // 截取前 length 位作为真正的哈夫曼编码
-            std::string huffmanCode = bitStream.substr(0, length);
-            Trie::insert(root, huffmanCode, byteCode);
-        }
-        encodedTable.close();
-
-        // 3. 读取压缩文件数据
-        std::ifstream compressedData(compressedFile, std::ios::binary);
-        if (!compressedData) {
-            std::cerr << "Error opening compressed file: " << compressedFile << std::endl;
-            return;
+        maxLength = 1;
+        for (const Huffman::Code &code : codes) {
+            maxLength = std::max(maxLength, code.length);
         }
-        std::vector<unsigned char> compressedContent;
-        compressedContent.assign(std::istreambuf_iterator<char>(compressedData), std::istreambuf_iterator<char>());
-        compressedData.close();
-
-        // 4. 解码压缩数据：逐位判断，利用字典树确定对应的原始字节
-        std::vector<unsigned char> decodedBytes;
-        Trie::Node *current = root;
-        for (unsigned char byte : compressedContent) {
-            for (int pos = 7; pos >= 0 && decodedBytes.size() < TextLength; --pos) {
-                int bit = (byte >> pos) & 1;
-                if (bit == 0) {
-                    current = current->left;
-                } else {
-                    current = current->right;
+        return true;
+    }
+
+    // 类: SymbolDecoder
+    // 用途: 按码表解码字节：单一码表时构建一个解码引擎；一阶上下文模式下每张码表构建一个解码引擎，
+    //       解码每个字节时以前一字节（上下文）选择引擎，查表解码不受影响
+    template<typename Engine>
+    class SymbolDecoder {
+    public:
+        // 由单一码表模式的文件头构建（上下文模式下位于同步点处的字节以 0 为上下文）
+        bool build(const Format::Header &header) {
+            if (header.flags & Format::FLAG_CONTEXT) {
+                return buildContexts(header.contexts, header.syncInterval);
+            }
+            return buildSingle(header.codeLengths.data());
+        }
+
+        // 由分块模式的块数据开头的码表构建，used 返回码表的字节数
+        bool build(const unsigned char *data, std::size_t size, bool contextual, std::size_t &used) {
+            if (contextual) {
+                Format::ContextTables tables;
+                return Format::parseContextTables(data, size, tables, used) && buildContexts(tables, 0);
+            }
+            used = Format::BLOCK_TABLE_SIZE;
+            return size >= Format::BLOCK_TABLE_SIZE && buildSingle(data);
+        }
+
+        // 各码表中最长编码的位数（至少为 1）
+        unsigned maxLength() const { return longest; }
+
+        // 函数: decode
+        // 用途: 从比特流中连续解码 count 个字节
+        //
+        // 参数:
+        //    reader   - 比特流读取器
+        //    out      - 输出缓冲区
+        //    count    - 字节数
+        //    offset   - out[0] 在数据流中的位置（上下文模式下用于确定上下文重置的位置）
+        //    previous - 输入：out[0] 的上下文；输出：最后一个解码的字节
+        //
+        // 返回:
+        //    遇到无效编码时返回 false
+        bool decode(Huffman::BitReader &reader, unsigned char *out, std::size_t count, uint64_t offset,
+                    unsigned char &previous) const {
+            if (!contextual) {
+                return decodeSymbols(engines[0], reader, out, count);
+            }
+            std::size_t done = 0;
+            while (done < count) {
+                std::size_t step = count - done;
+                if (resetInterval > 0) {
+                    uint64_t phase = (offset + done) % resetInterval;
+                    if (phase == 0) {
+                        previous = 0;
+                    }
+                    step = static_cast<std::size_t>(std::min<uint64_t>(step, resetInterval - phase));
                 }
-                // 达到叶子节点则得到一个完整的字节
-                if (current->isLeaf) {
-                    decodedBytes.push_back(current->value);
-                    current = root;
+                unsigned char *p = out + done;
+                for (std::size_t i = 0; i < step; i++) {
+                    uint32_t symbol = byContext[previous]->decode(reader);
+                    if (symbol == INVALID_SYMBOL) {
+                        return false;
+                    }
+                    p[i] = previous = static_cast<unsigned char>(symbol);
                 }
+                done += step;
             }
-            if (decodedBytes.size() == TextLength) {
-                break;
+            return true;
+        }
+
+    private:
+        std::vector<Engine> engines;                // 各码表的解码引擎
+        std::array<const Engine *, 256> byContext{}; // 各上下文使用的解码引擎
+        bool contextual = false;
+        uint64_t resetInterval = 0;                 // 上下文重置间隔（同步点间隔），0 表示不重置
+        unsigned longest = 1;
+
+        bool buildSingle(const uint8_t *lengths) {
+            engines.resize(1);
+            contextual = false;
+            return buildEngine(lengths, engines[0], longest);
+        }
+
+        bool buildContexts(const Format::ContextTables &tables, uint64_t interval) {
+            engines.clear();
+            engines.resize(tables.lengths.size());
+            longest = 1;
+            for (std::size_t i = 0; i < engines.size(); i++) {
+                unsigned length = 0;
+                if (!buildEngine(tables.lengths[i].data(), engines[i], length)) {
+                    return false;
+                }
+                longest = std::max(longest, length);
+            }
+            for (unsigned context = 0; context < 256; context++) {
+                if (tables.tableOf[context] >= engines.size()) {
+                    return false;
+                }
+                byContext[context] = &engines[tables.tableOf[context]];
+            }
+            contextual = true;
+            resetInterval = interval;
+            return true;
+        }
+    };
+
+    // 函数: headerDecoder
+    // 用途: 由单一码表模式的文件头构建解码器。引用共享字典的文件（FLAG_DICTIONARY）使用进程内缓存的解码器：
+    //       每次都经 Dictionary::open 取得 -D 给出的字典（文件未修改时不重新读取）并核对 ID，
+    //       解码器按（字典 ID, 上下文重置间隔）缓存，只有由同一次读取的字典构建时才复用，
+    //       因此字典文件被替换后重新构建；缓存按最近使用排序，超过 DECODER_CACHE_SIZE 项时丢弃最久未使用的一项
+    //
+    // 返回:
+    //    解码器；码表无效、未提供字典或字典与文件头中的 ID 不符时返回空
+    template<typename Engine>
+    std::shared_ptr<const SymbolDecoder<Engine>> headerDecoder(const Format::Header &header, const Request &request) {
+        if (!(header.flags & Format::FLAG_DICTIONARY)) {
+            std::shared_ptr<SymbolDecoder<Engine>> decoder = std::make_shared<SymbolDecoder<Engine>>();
+            return decoder->build(header) ? decoder : nullptr;
+        }
+        const std::string &dictionaryFile = request.options.dictionaryFile;
+        if (dictionaryFile.empty()) {
+            std::cerr << "Dictionary 0x" << Common::hashToString(header.dictionaryId)
+                      << " is required to decompress " << request.compressedFile << std::endl;
+            return nullptr;
+        }
+        std::shared_ptr<const Dictionary::Tables> dictionary = Dictionary::open(dictionaryFile);
+        if (!dictionary) {
+            return nullptr;
+        }
+        bool contextual = (header.flags & Format::FLAG_CONTEXT) != 0;
+        if (dictionary->id != header.dictionaryId || dictionary->contextual != contextual) {
+            std::cerr << "Dictionary mismatch: " << request.compressedFile << " requires dictionary 0x"
+                      << Common::hashToString(header.dictionaryId) << ", " << dictionaryFile << " is 0x"
+                      << Common::hashToString(dictionary->id) << std::endl;
+            return nullptr;
+        }
+
+        struct Entry {
+            std::pair<uint32_t, uint64_t> key;
+            std::shared_ptr<const Dictionary::Tables> dictionary; // 构建解码器所用的字典
+            std::shared_ptr<const SymbolDecoder<Engine>> decoder;
+        };
+        constexpr std::size_t DECODER_CACHE_SIZE = 16;
+        static std::mutex mutex;
+        static std::list<Entry> cache;
+        std::pair<uint32_t, uint64_t> key(header.dictionaryId, contextual ? header.syncInterval : 0);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(cache.begin(), cache.end(), [&](const Entry &entry) { return entry.key == key; });
+        bool hit = it != cache.end() && it->dictionary == dictionary;
+        if (request.stats) {
+            request.stats->set("dictionary", Common::hashToString(header.dictionaryId));
+            request.stats->set("dictionary_cache", hit ? "hit" : "miss");
+        }
+        if (hit) {
+            cache.splice(cache.begin(), cache, it);
+            return it->decoder;
+        }
+        if (it != cache.end()) {
+            cache.erase(it);
+        }
+        Format::Header tables = header;
+        Dictionary::fillHeader(*dictionary, tables);
+        std::shared_ptr<SymbolDecoder<Engine>> decoder = std::make_shared<SymbolDecoder<Engine>>();
+        if (!decoder->build(tables)) {
+            return nullptr;
+        }
+        cache.push_front(Entry{key, dictionary, decoder});
+        if (cache.size() > DECODER_CACHE_SIZE) {
+            cache.pop_back();
+        }
+        return decoder;
+    }
+
+    // 函数: decodeMatches
+    // 用途: 解码 LZ77 模式下的一个块：块数据开头为字面量/长度码表与距离码表的编码长度，
+    //       其后每个字面量直接输出，每个匹配由长度、距离（各含附加位）自已输出的数据中复制
+    //
+    // 参数:
+    //    data  - 块数据
+    //    size  - 块数据字节数
+    //    out   - 输出缓冲区
+    //    count - 块原始字节数
+    //
+    // 返回:
+    //    遇到无效编码、匹配超出已输出的数据或块末尾时返回 false
+    template<typename Engine>
+    bool decodeMatches(const unsigned char *data, std::size_t size, unsigned char *out, std::size_t count) {
+        if (size < Format::LZ_TABLE_SIZE) {
+            return false;
+        }
+        Engine litLen, distance;
+        unsigned maxLength = 0;
+        if (!buildEngine(data, litLen, maxLength, LZ77::LITLEN_SYMBOLS) ||
+            !buildEngine(data + LZ77::LITLEN_SYMBOLS, distance, maxLength, LZ77::DISTANCE_SYMBOLS)) {
+            return false;
+        }
+        Huffman::BitReader reader(data + Format::LZ_TABLE_SIZE, size - Format::LZ_TABLE_SIZE);
+        std::size_t pos = 0;
+        while (pos < count) {
+            uint32_t symbol = litLen.decode(reader);
+            if (symbol < LZ77::LITERALS) {
+                out[pos++] = static_cast<unsigned char>(symbol);
+                continue;
+            }
+            if (symbol <= LZ77::LITERALS || symbol >= LZ77::LITLEN_SYMBOLS) {
+                return false;
             }
+            const LZ77::SymbolRange &lengthRange = LZ77::LENGTH_RANGES[symbol - LZ77::LITERALS - 1];
+            std::size_t length = lengthRange.base + reader.readBits(lengthRange.extra);
+            symbol = distance.decode(reader);
+            if (symbol >= LZ77::DISTANCE_SYMBOLS) {
+                return false;
+            }
+            const LZ77::SymbolRange &distanceRange = LZ77::DISTANCE_RANGES[symbol];
+            std::size_t dist = distanceRange.base + reader.readBits(distanceRange.extra);
+            if (dist > pos || length > count - pos) {
+                return false;
+            }
+            // 距离不小于长度时源与目标不重叠，可整段复制；否则须逐字节复制（重复最近的 dist 个字节）
+            const unsigned char *from = out + pos - dist;
+            if (dist >= length) {
+                std::memcpy(out + pos, from, length);
+            } else {
+                for (std::size_t i = 0; i < length; i++) {
+                    out[pos + i] = from[i];
+                }
+            }
+            pos += length;
         }
+        return reader.bitPosition() <= static_cast<uint64_t>(size - Format::LZ_TABLE_SIZE) * 8;
+    }
 
-        // 5. 根据参数进行解密处理
-        std::vector<unsigned char> processedBytes = decodedBytes;
-        if (decrypt) {
-            Common::decrypt(processedBytes, key);
+    // 函数: decodeTransformed
+    // 用途: 解码 BWT 模式下的一个块：块数据开头为主行号与 257 个编码长度，其后的符号流先还原前移变换
+    //       与零游程编码，得到 BWT 输出后再做逆变换
+    //
+    // 参数:
+    //    data  - 块数据
+    //    size  - 块数据字节数
+    //    out   - 输出缓冲区
+    //    count - 块原始字节数
+    //
+    // 返回:
+    //    遇到无效编码、还原的字节数与 count 不符或主行号无效时返回 false
+    template<typename Engine>
+    bool decodeTransformed(const unsigned char *data, std::size_t size, unsigned char *out, std::size_t count) {
+        if (size < Format::BWT_TABLE_SIZE || count == 0 || count > BWT::MAX_BLOCK_SIZE) {
+            return false;
+        }
+        uint32_t primary = 0;
+        for (int i = 0; i < 4; i++) {
+            primary |= static_cast<uint32_t>(data[i]) << (8 * i);
+        }
+        Engine engine;
+        unsigned maxLength = 0;
+        if (!buildEngine(data + 4, engine, maxLength, BWT::SYMBOLS)) {
+            return false;
+        }
+        Huffman::BitReader reader(data + Format::BWT_TABLE_SIZE, size - Format::BWT_TABLE_SIZE);
+        std::vector<unsigned char> transformed(count);
+        BWT::SymbolDecoder decoder(transformed.data(), count);
+        while (decoder.produced() < count) {
+            if (!decoder.put(engine.decode(reader))) {
+                return false;
+            }
+        }
+        return decoder.finish() && BWT::inverse(transformed.data(), count, primary, out) &&
+               reader.bitPosition() <= static_cast<uint64_t>(size - Format::BWT_TABLE_SIZE) * 8;
+    }
+
+    // 函数: decodeBlock
+    // 用途: 解码分块模式下的一个块（块数据开头为该块的 256 个编码长度，上下文模式下为该块的上下文码表，
+    //       LZ77 模式见 decodeMatches，BWT 模式见 decodeTransformed；块数据字节数等于原始字节数时为原样存储）
+    //
+    // 参数:
+    //    data  - 块数据
+    //    size  - 块数据字节数
+    //    out   - 输出缓冲区
+    //    count - 块原始字节数
+    //    flags - 文件头标志位（是否为一阶上下文模式、LZ77 模式或 BWT 模式）
+    template<typename Engine>
+    bool decodeBlock(const unsigned char *data, std::size_t size, unsigned char *out, uint64_t count,
+                     uint16_t flags) {
+        // 原样存储的块
+        if (size == count) {
+            std::memcpy(out, data, size);
+            return true;
+        }
+        if (flags & Format::FLAG_LZ77) {
+            return decodeMatches<Engine>(data, size, out, static_cast<std::size_t>(count));
+        }
+        if (flags & Format::FLAG_BWT) {
+            return decodeTransformed<Engine>(data, size, out, static_cast<std::size_t>(count));
+        }
+        bool contextual = (flags & Format::FLAG_CONTEXT) != 0;
+        SymbolDecoder<Engine> decoder;
+        std::size_t used = 0;
+        if (!decoder.build(data, size, contextual, used)) {
+            return false;
+        }
+        Huffman::BitReader reader(data + used, size - used);
+        unsigned char previous = 0;
+        return decoder.decode(reader, out, static_cast<std::size_t>(count), 0, previous) &&
+               reader.bitPosition() <= static_cast<uint64_t>(size - used) * 8;
+    }
+
+    // 函数: decodeSynced
+    // 用途: 按文件头中的同步点将单一码表的比特流切分为若干段，由线程池并行解码，
+    //       各段直接写入输出缓冲区的对应位置；每段解码结束时的位置须恰好为下一个同步点
+    //
+    // 参数:
+    //    decoder     - 已构建的解码器（各线程共享，只读；上下文模式下各段以 0 为起始上下文）
+    //    header      - 含同步点索引的文件头
+    //    payload     - 比特流
+    //    payloadSize - 比特流字节数
+    //    out         - 输出缓冲区（originalLength 字节）
+    //    threads     - 线程数
+    //    cipher      - 解密器（各段解码后随即解密），为空表示不解密
+    //    checksum    - 输出：解密后数据的校验和（各段随解密计算后按顺序合并），为空表示不计算
+    template<typename Engine>
+    bool decodeSynced(const SymbolDecoder<Engine> &decoder, const Format::Header &header,
+                      const unsigned char *payload, std::size_t payloadSize, unsigned char *out, unsigned threads,
+                      const Common::Cipher *cipher, uint32_t *checksum) {
+        // 在同步点之前补上起点 (0, 0)，之后补上终点，相邻两点之间为一段
+        std::vector<Format::SyncPoint> points;
+        points.reserve(header.syncPoints.size() + 1);
+        points.push_back(Format::SyncPoint{0, 0});
+        points.insert(points.end(), header.syncPoints.begin(), header.syncPoints.end());
+        std::size_t segments = points.size();
+        uint64_t totalBits = static_cast<uint64_t>(payloadSize) * 8;
+        std::vector<char> segmentOk(segments, 0);
+        std::vector<uint32_t> segmentChecksums(segments, 0);
+        auto decodeOne = [&](std::size_t i) {
+            const Format::SyncPoint &point = points[i];
+            uint64_t outEnd = i + 1 < segments ? points[i + 1].outputOffset : header.originalLength;
+            uint64_t bitEnd = i + 1 < segments ? points[i + 1].bitOffset : totalBits;
+            if (point.bitOffset > bitEnd || bitEnd > totalBits) {
+                return;
+            }
+            Huffman::BitReader reader(payload, payloadSize, point.bitOffset);
+            unsigned char previous = 0;
+            bool decoded = decoder.decode(reader, out + point.outputOffset,
+                                          static_cast<std::size_t>(outEnd - point.outputOffset),
+                                          point.outputOffset, previous);
+            segmentOk[i] = decoded && (i + 1 < segments ? reader.bitPosition() == bitEnd
+                                                        : reader.bitPosition() <= bitEnd);
+            if (segmentOk[i]) {
+                Common::decryptAndChecksum(out + point.outputOffset,
+                                           static_cast<std::size_t>(outEnd - point.outputOffset), point.outputOffset,
+                                           cipher, checksum ? &segmentChecksums[i] : nullptr);
+            }
+        };
+        ThreadPool pool(std::min<std::size_t>(threads, segments));
+        pool.parallelFor(segments, decodeOne);
+        if (!std::all_of(segmentOk.begin(), segmentOk.end(), [](char b) { return b != 0; })) {
+            return false;
         }
+        for (std::size_t i = 0; checksum && i < segments; i++) {
+            uint64_t outEnd = i + 1 < segments ? points[i + 1].outputOffset : header.originalLength;
+            *checksum = CRC32C::combine(*checksum, segmentChecksums[i], outEnd - points[i].outputOffset);
+        }
+        return true;
+    }
+
+    // 函数: partiesLength
+    // 用途: 返回校验旧版本文件的收发人信息所需的解码数据前缀长度
+    std::size_t partiesLength(const std::string &senderInfo, const std::string &receiverInfo) {
+        return senderInfo.size() + receiverInfo.size() + 2;
+    }
 
-        // 6. 校验文件中存储的发送者和接收者信息，确保一致
-        std::string fullDecoded(processedBytes.begin(), processedBytes.end());
-        std::istringstream iss(fullDecoded);
+    // 函数: verifyParties
+    // 用途: 校验旧版本文件（未设置 FLAG_PARTIES）解码数据开头存储的发送者和接收者信息（各占一行），确保与输入一致
+    //
+    // 参数:
+    //    data    - 解码（并解密）后的数据，至少包含 partiesLength 个字节或全部数据
+    //    size    - 数据字节数
+    //    verbose - 校验通过时是否显示收发人信息
+    bool verifyParties(const unsigned char *data, std::size_t size,
+                       const std::string &senderInfo, const std::string &receiverInfo, bool verbose) {
+        std::size_t pos = 0;
+        // 读取下一行（不含换行符）
+        auto nextLine = [&]() {
+            std::size_t end = pos;
+            while (end < size && data[end] != '\n') {
+                end++;
+            }
+            std::string line(data + pos, data + end);
+            pos = std::min(end + 1, size);
+            return line;
+        };
         if (!senderInfo.empty()) {
-            std::string sender;
-            std::getline(iss, sender);
+            std::string sender = nextLine();
             if (sender != senderInfo) {
                 std::cerr << "Sender info mismatch: " << senderInfo << std::endl;
-                return;
+                return false;
+            }
+            if (verbose) {
+                std::cout << "Sender info: " << sender << std::endl;
             }
-            std::cout << "Sender info: " << sender << std::endl;
         }
         if (!receiverInfo.empty()) {
-            std::string receiver;
-            std::getline(iss, receiver);
+            std::string receiver = nextLine();
             if (receiver != receiverInfo) {
                 std::cerr << "Receiver info mismatch: " << receiverInfo << std::endl;
-                return;
+                return false;
+            }
+            if (verbose) {
+                std::cout << "Receiver info: " << receiver << std::endl;
             }
-            std::cout << "Receiver info: " << receiver << std::endl;
         }
+        return true;
+    }
 
-        // 7. 将解压后的数据写入输出文件，文件名格式为 "原文件名_j.txt"
-        std::string outputFile = "test/" + Common::extractFileName(compressedFile) + "_j.txt";
-        std::ofstream outFile(outputFile, std::ios::binary);
-        if (!outFile) {
-            std::cerr << "Error opening output file: " << outputFile << std::endl;
-            return;
+    // 函数: verifyHeaderParties
+    // 用途: 校验文件头中记录的收发人信息（加密时先解密）与输入完全一致，在解码与创建输出文件之前进行；
+    //       旧版本的文件（未设置 FLAG_PARTIES）中收发人信息位于数据流开头，只能在解码后由 verifyParties 校验
+    //
+    // 参数:
+    //    header  - 已解析的文件头
+    //    cipher  - 按文件头中的加密方式创建的解密器（未加密时不使用）
+    //    request - 解压请求（输入的收发人信息与显示选项）
+    bool verifyHeaderParties(const Format::Header &header, const Common::Cipher &cipher, const Request &request) {
+        if (!(header.flags & Format::FLAG_PARTIES)) {
+            return true;
+        }
+        Stats::Timer verifyTimer(request.stats, "verify");
+        std::string sender = header.senderInfo;
+        std::string receiver = header.receiverInfo;
+        if (header.flags & Format::FLAG_ENCRYPTED) {
+            cipher.decrypt(reinterpret_cast<unsigned char *>(&sender[0]), sender.size(), Format::PARTIES_STREAM_OFFSET);
+            cipher.decrypt(reinterpret_cast<unsigned char *>(&receiver[0]), receiver.size(),
+                           Format::PARTIES_STREAM_OFFSET + sender.size());
+        }
+        if (sender != request.senderInfo) {
+            std::cerr << "Sender info mismatch: " << request.senderInfo << std::endl;
+            return false;
         }
-        outFile.write(reinterpret_cast<const char *>(processedBytes.data()), processedBytes.size());
-        outFile.close();
+        if (receiver != request.receiverInfo) {
+            std::cerr << "Receiver info mismatch: " << request.receiverInfo << std::endl;
+            return false;
+        }
+        if (request.options.verbosity >= Verbosity::SUMMARY) {
+            if (!sender.empty()) {
+                std::cout << "Sender info: " << sender << std::endl;
+            }
+            if (!receiver.empty()) {
+                std::cout << "Receiver info: " << receiver << std::endl;
+            }
+        }
+        return true;
+    }
 
-        // 释放字典树内存
-        Trie::free(root);
+    // 函数: memberBytes
+    // 用途: 取出映射中本次解压的压缩数据：归档中的成员为其中的一段，否则为整个文件
+    //
+    // 返回:
+    //    成员超出文件末尾时返回 false
+    bool memberBytes(const Request &request, MappedFile &input, unsigned char *&data, std::size_t &size) {
+        uint64_t fileSize = input.size();
+        uint64_t memberSize = request.memberSize > 0 ? request.memberSize : fileSize - std::min(fileSize, request.memberOffset);
+        if (request.memberOffset > fileSize || memberSize > fileSize - request.memberOffset) {
+            std::cerr << "Member is beyond the end of the file: " << request.compressedFile << std::endl;
+            return false;
+        }
+        data = input.data() + request.memberOffset;
+        size = static_cast<std::size_t>(memberSize);
+        return true;
+    }
+
+    // 函数: outputPath
+    // 用途: 解压输出文件路径：设置了 outputFile 时为该路径，否则文件名格式为 "输出目录/原文件名_j.txt"
+    std::string outputPath(const Request &request) {
+        if (!request.options.outputFile.empty()) {
+            return request.options.outputFile;
+        }
+        return Common::joinPath(request.options.outputDir, Common::extractFileName(request.compressedFile) + "_j.txt");
+    }
 
-        // 8. 显示解压后的数据 HASH、数据大小等信息
-        std::string decompressedDataHash = Common::calculateHash(processedBytes);
-        std::cout << "Decompressed data hash: 0x" << decompressedDataHash << std::endl;
-        std::cout << "Decompressed data size: " << processedBytes.size() << std::endl;
+    // 函数: reportDecompression
+    // 用途: 显示解压后数据的校验和、数据大小、耗时及压缩率，并记录到统计信息
+    void reportDecompression(const Request &request, uint32_t hashValue, uint64_t decodedSize, uint64_t compressedSize) {
+        if (request.stats) {
+            request.stats->set("original_bytes", static_cast<double>(decodedSize));
+            request.stats->set("compressed_bytes", static_cast<double>(compressedSize));
+            request.stats->set("ratio", decodedSize ? static_cast<double>(compressedSize) / decodedSize : 0.0);
+            request.stats->set("hash", Common::hashToString(hashValue));
+        }
+        if (request.options.verbosity < Verbosity::SUMMARY) {
+            return;
+        }
+        std::cout << "Decompressed data hash: 0x" << Common::hashToString(hashValue) << std::endl;
+        std::cout << "Decompressed data size: " << decodedSize << std::endl;
 
-        // 9. 记录结束时间，计算解压所用时间（毫秒）
+        // 记录结束时间，计算解压所用时间（毫秒）
         auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        std::cout << "01Trie decompression completed in " << duration.count() << "ms" << std::endl;
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - request.startTime);
+        std::cout << request.engineName << " decompression completed in " << duration.count() << "ms" << std::endl;
 
-        // 10. 计算并显示压缩率：压缩文件大小与原文件大小的比例
-        double compressionRatio = static_cast<double>(compressedContent.size()) / processedBytes.size();
+        // 计算并显示压缩率：压缩文件大小与原文件大小的比例
+        double compressionRatio = static_cast<double>(compressedSize) / decodedSize;
         std::cout << "Compression ratio: " << compressionRatio << std::endl << std::endl;
     }
-}
 
-namespace HashDecompressor {
-    // 函数: decompressFile
-    // 用途: 使用哈希映射方式解压文件，其步骤类似于字典树解码，不过构建的是从编码串到字节值的哈希映射
+    // 类: OutputSink
+    // 用途: 流式解压的输出端：按顺序接收解码数据块，解密后写出，第一块到达时才创建输出文件，
+    //       并增量计算输出数据的校验和；旧版本的文件在写出第一块之前校验数据流开头的收发人信息
+    class OutputSink {
+    public:
+        // cipher 为解码后数据的解密器，为空表示不需要解密；checksum 为是否需要校验（文件头记录了校验和）；
+        // partiesInStream 为收发人信息是否位于数据流开头（旧版本的文件）
+        OutputSink(const Request &request, const Common::Cipher *cipher, bool checksum, bool partiesInStream)
+            : request(request), outputFile(outputPath(request)), cipher(cipher),
+              computeChecksum(checksum || request.wantHash()), partiesInStream(partiesInStream) {}
+
+        // 写出一块数据（解密时原地修改，解密与校验和融合为一遍）；第一块须包含 partiesLength 个字节或全部数据
+        bool write(unsigned char *data, std::size_t size) {
+            if (cipher || computeChecksum) {
+                Stats::Timer timer(request.stats, "decrypt");
+                lastValue = 0;
+                Common::decryptAndChecksum(data, size, produced, cipher, computeChecksum ? &lastValue : nullptr);
+                hashValue = CRC32C::combine(hashValue, lastValue, size);
+            }
+            if (!opened && !open(data, size)) {
+                return false;
+            }
+            Stats::Timer writeTimer(request.stats, "write");
+            outFile.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+            writeTimer.stop();
+            produced += size;
+            return true;
+        }
+
+        // 结束输出（原始数据为空时同样需要校验并生成输出文件）
+        bool finish() {
+            if (!opened && !open(nullptr, 0)) {
+                return false;
+            }
+            outFile.close();
+            if (!outFile) {
+                std::cerr << "Error writing output file: " << outputFile << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        // 出错时删除已写出的部分输出
+        void discard() {
+            if (opened) {
+                outFile.close();
+                std::remove(outputFile.c_str());
+                opened = false;
+            }
+        }
+
+        uint64_t size() const { return produced; }
+        uint32_t hash() const { return hashValue; }          // 已写出数据的校验和
+        uint32_t lastChecksum() const { return lastValue; } // 最近一次写出的数据的校验和
+
+    private:
+        const Request &request;
+        std::string outputFile;
+        const Common::Cipher *cipher;
+        bool computeChecksum;
+        bool partiesInStream;
+        std::ofstream outFile;
+        bool opened = false;
+        uint64_t produced = 0;
+        uint32_t hashValue = 0;
+        uint32_t lastValue = 0;
+
+        bool open(const unsigned char *data, std::size_t size) {
+            Stats::Timer verifyTimer(request.stats, "verify");
+            if (partiesInStream && !verifyParties(data, size, request.senderInfo, request.receiverInfo,
+                                                  request.options.verbosity >= Verbosity::SUMMARY)) {
+                return false;
+            }
+            verifyTimer.stop();
+            outFile.open(outputFile, std::ios::binary);
+            if (!outFile) {
+                std::cerr << "Error opening output file: " << outputFile << std::endl;
+                return false;
+            }
+            opened = true;
+            return true;
+        }
+    };
+
+    // 函数: decompressInMemory
+    // 用途: 以内存映射方式读取整个压缩文件并解压，主要步骤：
+    //       1. 以写时复制方式映射压缩文件，解析文件头，校验文件头中的收发人信息（不一致时不解码、不创建输出文件）
+    //       2. 按原始数据长度预先创建并映射输出文件，解码引擎直接解码到输出文件的映射中
+    //          （分块模式下各块、单一码表模式下各同步点之间的各段由线程池并行解码到对应位置），
+    //          各块、各段解码后随即在映射中原地解密并计算校验和（并行解码时各块、各段的校验和按顺序合并），
+    //          与文件头中记录的校验和比较；
+    //          ChaCha20 加密时改为在解码前于压缩文件的映射中原地解密编码数据（分块模式下各块并行解密）
+    //       3. 旧版本的文件校验数据流开头的收发人信息
+    //       4. 校验通过后将输出文件替换为正式文件名，否则删除
+    template<typename Engine>
+    bool decompressInMemory(const Request &request) {
+        // 1. 映射压缩文件并解析文件头
+        Stats::Timer readTimer(request.stats, "read");
+        MappedFile input;
+        if (!input.open(request.compressedFile, MappedFile::COPY_ON_WRITE)) {
+            std::cerr << "Error opening compressed file: " << request.compressedFile << std::endl;
+            return false;
+        }
+        input.adviseWillNeed();
+        unsigned char *member = nullptr;
+        std::size_t memberSize = 0;
+        if (!memberBytes(request, input, member, memberSize)) {
+            return false;
+        }
+
+        Format::Header header;
+        std::size_t payloadOffset = 0;
+        if (!Format::parseHeader(member, memberSize, header, payloadOffset)) {
+            std::cerr << "Invalid or unsupported compressed file header: " << request.compressedFile << std::endl;
+            return false;
+        }
+        if (!checkEncryption(header, request)) {
+            return false;
+        }
+        readTimer.stop();
+        Common::Cipher cipher = makeCipher(header, request.key);
+        if (!verifyHeaderParties(header, cipher, request)) {
+            return false;
+        }
+        unsigned char *payload = member + payloadOffset;
+        std::size_t payloadSize = memberSize - payloadOffset;
+
+        // 2. 预先创建原始数据长度的输出文件（校验通过前使用临时文件名），解码到其映射中
+        std::string outputFile = outputPath(request);
+        std::string partFile = outputFile + ".part";
+        MappedFile output;
+        if (!output.create(partFile, header.originalLength)) {
+            std::cerr << "Error opening output file: " << outputFile << std::endl;
+            std::remove(partFile.c_str());
+            return false;
+        }
+        // 出错时删除未完成的输出文件
+        auto discard = [&]() {
+            output.close();
+            std::remove(partFile.c_str());
+        };
+        unsigned char *decoded = output.data();
+        std::size_t decodedSize = output.size();
+        // 解密与校验和在解码后随即进行（各块、各段解码后仍在缓存中）
+        const Common::Cipher *payloadCipher = Format::encryptsPayload(header) ? &cipher : nullptr;
+        const Common::Cipher *outCipher = request.decrypt && !payloadCipher ? &cipher : nullptr;
+        bool computeChecksum = (header.flags & Format::FLAG_CHECKSUM) || request.wantHash();
+        uint32_t hashValue = 0;
+        bool ok = true;
+        Stats::Timer decodeTimer(request.stats, "decode");
+        if (header.flags & Format::FLAG_BLOCKS) {
+            // 各块的输出位置为此前各块原始字节数之和
+            std::vector<uint64_t> outOffsets(header.blocks.size(), 0);
+            for (std::size_t i = 1; i < header.blocks.size(); i++) {
+                outOffsets[i] = outOffsets[i - 1] + header.blocks[i - 1].rawSize;
+            }
+            // ChaCha20 加密时各块在映射中原地解密，块数据不能相互重叠
+            bool disjoint = true;
+            for (std::size_t i = 1; payloadCipher && i < header.blocks.size(); i++) {
+                const Format::BlockEntry &previous = header.blocks[i - 1];
+                disjoint = disjoint && header.blocks[i].offset >= previous.offset + previous.compressedSize;
+            }
+            std::vector<char> blockOk(header.blocks.size(), 0);
+            std::vector<uint32_t> blockChecksums(header.blocks.size(), 0);
+            auto decodeOne = [&](std::size_t i) {
+                const Format::BlockEntry &block = header.blocks[i];
+                blockOk[i] = disjoint && block.offset <= payloadSize &&
+                             block.compressedSize <= payloadSize - block.offset;
+                if (blockOk[i] && payloadCipher) {
+                    payloadCipher->decrypt(payload + block.offset, static_cast<std::size_t>(block.compressedSize),
+                                           outOffsets[i]);
+                }
+                blockOk[i] = blockOk[i] &&
+                             decodeBlock<Engine>(payload + block.offset, static_cast<std::size_t>(block.compressedSize),
+                                                 decoded + outOffsets[i], block.rawSize, header.flags);
+                if (blockOk[i]) {
+                    Common::decryptAndChecksum(decoded + outOffsets[i], static_cast<std::size_t>(block.rawSize),
+                                               outOffsets[i], outCipher,
+                                               computeChecksum ? &blockChecksums[i] : nullptr);
+                }
+            };
+            unsigned threads = ThreadPool::resolveThreads(request.options.threads);
+            if (threads > 1 && header.blocks.size() > 1) {
+                ThreadPool pool(std::min<std::size_t>(threads, header.blocks.size()));
+                pool.parallelFor(header.blocks.size(), decodeOne);
+            } else {
+                for (std::size_t i = 0; i < header.blocks.size(); i++) {
+                    decodeOne(i);
+                }
+            }
+            ok = std::all_of(blockOk.begin(), blockOk.end(), [](char b) { return b != 0; });
+            // 各块分别校验，再按顺序合并为整个数据流的校验和
+            for (std::size_t i = 0; ok && i < header.blocks.size(); i++) {
+                if ((header.flags & Format::FLAG_CHECKSUM) && blockChecksums[i] != header.blocks[i].checksum) {
+                    std::cerr << "Checksum mismatch in block " << i << ": " << request.compressedFile << std::endl;
+                    discard();
+                    return false;
+                }
+                hashValue = CRC32C::combine(hashValue, blockChecksums[i], header.blocks[i].rawSize);
+            }
+        } else if (header.flags & Format::FLAG_STORED) {
+            ok = payloadSize == decodedSize;
+            for (std::size_t done = 0; ok && done < decodedSize; done += DECODE_TILE) {
+                std::size_t step = std::min(decodedSize - done, DECODE_TILE);
+                std::memcpy(decoded + done, payload + done, step);
+                Common::decryptAndChecksum(decoded + done, step, done, outCipher,
+                                           computeChecksum ? &hashValue : nullptr);
+            }
+        } else {
+            decodeTimer.stop();
+            Stats::Timer buildTimer(request.stats, "code generation");
+            std::shared_ptr<const SymbolDecoder<Engine>> decoder = headerDecoder<Engine>(header, request);
+            if (!decoder) {
+                discard();
+                return false;
+            }
+            buildTimer.stop();
+            unsigned threads = ThreadPool::resolveThreads(request.options.threads);
+            if (payloadCipher) {
+                // ChaCha20 加密时先并行解密整段编码数据（同步点的位偏移均相对解密后的比特流）
+                Stats::Timer decryptTimer(request.stats, "decrypt");
+                payloadCipher->decrypt(payload, payloadSize, 0, threads);
+            }
+            Stats::Timer timer(request.stats, "decode");
+            if (threads > 1 && !header.syncPoints.empty()) {
+                ok = decodeSynced(*decoder, header, payload, payloadSize, decoded, threads, outCipher,
+                                  computeChecksum ? &hashValue : nullptr);
+            } else {
+                // 逐段解码、解密并计算校验和
+                Huffman::BitReader reader(payload, payloadSize);
+                unsigned char previous = 0;
+                for (std::size_t done = 0; ok && done < decodedSize; done += DECODE_TILE) {
+                    std::size_t step = std::min(decodedSize - done, DECODE_TILE);
+                    ok = decoder->decode(reader, decoded + done, step, done, previous);
+                    Common::decryptAndChecksum(decoded + done, step, done, outCipher,
+                                               computeChecksum ? &hashValue : nullptr);
+                }
+            }
+        }
+        decodeTimer.stop();
+        if (!ok) {
+            std::cerr << "Invalid Huffman code in compressed data: " << request.compressedFile << std::endl;
+            discard();
+            return false;
+        }
+        if (Format::hasStreamChecksum(header) && hashValue != header.checksum) {
+            std::cerr << "Checksum mismatch in decompressed data: " << request.compressedFile << std::endl;
+            discard();
+            return false;
+        }
+
+        // 3. 旧版本的文件：校验数据流开头存储的发送者和接收者信息，确保一致
+        if (!(header.flags & Format::FLAG_PARTIES)) {
+            Stats::Timer verifyTimer(request.stats, "verify");
+            if (!verifyParties(decoded, decodedSize, request.senderInfo, request.receiverInfo,
+                               request.options.verbosity >= Verbosity::SUMMARY)) {
+                discard();
+                return false;
+            }
+        }
+
+        // 4. 输出文件已写好，替换为正式文件名
+        Stats::Timer writeTimer(request.stats, "write");
+        output.close();
+        if (std::rename(partFile.c_str(), outputFile.c_str()) != 0) {
+            std::cerr << "Error writing output file: " << outputFile << std::endl;
+            std::remove(partFile.c_str());
+            return false;
+        }
+        writeTimer.stop();
+
+        reportDecompression(request, hashValue, decodedSize, memberSize);
+        return true;
+    }
+
+    // 函数: streamSingle
+    // 用途: 流式解码单一码表的比特流：输入与输出各使用一个固定大小的缓冲区，
+    //       输入缓冲区中剩余位数足以解出的符号个数为 剩余位数 / 最长编码长度；
+    //       payloadCipher 不为空时（ChaCha20 加密）读入的编码数据先按其在编码数据中的偏移解密
+    template<typename Engine>
+    bool streamSingle(const Request &request, const Format::Header &header, std::ifstream &inFile,
+                      std::size_t bufferSize, const Common::Cipher *payloadCipher, OutputSink &sink) {
+        Stats::Timer buildTimer(request.stats, "code generation");
+        std::shared_ptr<const SymbolDecoder<Engine>> decoder = headerDecoder<Engine>(header, request);
+        if (!decoder) {
+            return false;
+        }
+        buildTimer.stop();
+        unsigned maxLength = decoder->maxLength();
+        unsigned char previous = 0; // 上下文模式下下一个字节的上下文
+        std::vector<unsigned char> inBuffer(bufferSize);
+        std::vector<unsigned char> outBuffer(bufferSize);
+        std::size_t inSize = 0;    // 输入缓冲区中的有效字节数
+        uint64_t bitPos = 0;       // 输入缓冲区中下一个待解码位的位置
+        uint64_t readSize = 0;     // 已读入的编码数据字节数
+        bool endOfInput = false;
+        while (sink.size() < header.originalLength) {
+            // 将未解码的字节移到缓冲区开头，并从文件补满缓冲区
+            std::size_t consumedBytes = static_cast<std::size_t>(bitPos >> 3);
+            std::copy(inBuffer.begin() + consumedBytes, inBuffer.begin() + inSize, inBuffer.begin());
+            inSize -= consumedBytes;
+            bitPos &= 7;
+            if (!endOfInput) {
+                Stats::Timer timer(request.stats, "read");
+                inFile.read(reinterpret_cast<char *>(inBuffer.data() + inSize), bufferSize - inSize);
+                std::size_t count = static_cast<std::size_t>(inFile.gcount());
+                endOfInput = !inFile;
+                timer.stop();
+                if (payloadCipher) {
+                    Stats::Timer decryptTimer(request.stats, "decrypt");
+                    payloadCipher->decrypt(inBuffer.data() + inSize, count, readSize);
+                }
+                inSize += count;
+                readSize += count;
+            }
+
+            uint64_t available = static_cast<uint64_t>(inSize) * 8 - bitPos;
+            uint64_t count = std::min<uint64_t>(header.originalLength - sink.size(), outBuffer.size());
+            if (!endOfInput) {
+                count = std::min<uint64_t>(count, available / maxLength);
+            }
+            Huffman::BitReader reader(inBuffer.data(), inSize, bitPos);
+            Stats::Timer decodeTimer(request.stats, "decode");
+            bool decoded = decoder->decode(reader, outBuffer.data(), static_cast<std::size_t>(count), sink.size(), previous);
+            decodeTimer.stop();
+            if (!decoded || reader.bitPosition() > static_cast<uint64_t>(inSize) * 8) {
+                std::cerr << "Invalid Huffman code in compressed data: " << request.compressedFile << std::endl;
+                return false;
+            }
+            bitPos = reader.bitPosition();
+            if (!sink.write(outBuffer.data(), static_cast<std::size_t>(count))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 函数: streamStored
+    // 用途: 流式读取原样存储的数据：按缓冲区大小逐段读取并写出
+    bool streamStored(const Request &request, const Format::Header &header, std::ifstream &inFile,
+                      std::size_t bufferSize, OutputSink &sink) {
+        std::vector<unsigned char> buffer(bufferSize);
+        while (sink.size() < header.originalLength) {
+            std::size_t count = static_cast<std::size_t>(
+                std::min<uint64_t>(header.originalLength - sink.size(), buffer.size()));
+            Stats::Timer readTimer(request.stats, "read");
+            bool ok = static_cast<bool>(inFile.read(reinterpret_cast<char *>(buffer.data()), count));
+            readTimer.stop();
+            if (!ok) {
+                std::cerr << "Truncated stored data: " << request.compressedFile << std::endl;
+                return false;
+            }
+            if (!sink.write(buffer.data(), count)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 函数: streamBlocks
+    // 用途: 流式解码分块模式的数据：按块索引逐块读取、解码并写出，内存占用为一个块；
+    //       payloadCipher 不为空时（ChaCha20 加密）各块数据先按该块原始数据的起始偏移解密
+    template<typename Engine>
+    bool streamBlocks(const Request &request, const Format::Header &header, std::ifstream &inFile,
+                      const Common::Cipher *payloadCipher, OutputSink &sink) {
+        std::streamoff payloadOffset = inFile.tellg();
+        std::vector<unsigned char> packed, raw;
+        for (std::size_t i = 0; i < header.blocks.size(); i++) {
+            const Format::BlockEntry &block = header.blocks[i];
+            packed.resize(static_cast<std::size_t>(block.compressedSize));
+            raw.resize(static_cast<std::size_t>(block.rawSize));
+            Stats::Timer readTimer(request.stats, "read");
+            inFile.seekg(payloadOffset + static_cast<std::streamoff>(block.offset), std::ios::beg);
+            bool ok = static_cast<bool>(inFile.read(reinterpret_cast<char *>(packed.data()), packed.size()));
+            readTimer.stop();
+            if (ok && payloadCipher) {
+                Stats::Timer decryptTimer(request.stats, "decrypt");
+                payloadCipher->decrypt(packed.data(), packed.size(), sink.size());
+            }
+            Stats::Timer decodeTimer(request.stats, "decode");
+            ok = ok && decodeBlock<Engine>(packed.data(), packed.size(), raw.data(), raw.size(), header.flags);
+            decodeTimer.stop();
+            if (!ok) {
+                std::cerr << "Invalid compressed block " << i << ": " << request.compressedFile << std::endl;
+                return false;
+            }
+            if (!sink.write(raw.data(), raw.size())) {
+                return false;
+            }
+            if ((header.flags & Format::FLAG_CHECKSUM) && sink.lastChecksum() != block.checksum) {
+                std::cerr << "Checksum mismatch in block " << i << ": " << request.compressedFile << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 函数: decompressStreaming
+    // 用途: 流式解压：逐块读取、解码、解密并写出，内存占用与文件大小无关。
+    //       收发人信息在读取文件头后、解码之前完成校验（旧版本的文件在写出第一块数据之前）；
+    //       校验和随写出计算，不一致时删除输出文件
+    template<typename Engine>
+    bool decompressStreaming(const Request &request) {
+        // 每块至少能解出 bufferSize / 8 个字节，保证第一块足以完成旧版本文件的收发人信息校验
+        std::size_t bufferSize = std::max({request.options.bufferSize,
+                                           partiesLength(request.senderInfo, request.receiverInfo) * 8 + 64,
+                                           std::size_t(4096)});
+
+        // 读取文件头（归档中的成员自其偏移处开始）
+        std::ifstream inFile(request.compressedFile, std::ios::binary);
+        if (!inFile) {
+            std::cerr << "Error opening compressed file: " << request.compressedFile << std::endl;
+            return false;
+        }
+        inFile.seekg(static_cast<std::streamoff>(request.memberOffset), std::ios::beg);
+        Stats::Timer readTimer(request.stats, "read");
+        Format::Header header;
+        bool headerOk = Format::readHeader(inFile, header);
+        readTimer.stop();
+        if (!headerOk) {
+            std::cerr << "Invalid or unsupported compressed file header: " << request.compressedFile << std::endl;
+            return false;
+        }
+        if (!checkEncryption(header, request)) {
+            return false;
+        }
+
+        Common::Cipher cipher = makeCipher(header, request.key);
+        if (!verifyHeaderParties(header, cipher, request)) {
+            return false;
+        }
+
+        // ChaCha20 加密时读入的编码数据先解密，其余加密方式在解码后解密
+        const Common::Cipher *payloadCipher = Format::encryptsPayload(header) ? &cipher : nullptr;
+        OutputSink sink(request, request.decrypt && !payloadCipher ? &cipher : nullptr,
+                        (header.flags & Format::FLAG_CHECKSUM) != 0, !(header.flags & Format::FLAG_PARTIES));
+        bool ok;
+        if (header.flags & Format::FLAG_BLOCKS) {
+            ok = streamBlocks<Engine>(request, header, inFile, payloadCipher, sink);
+        } else if (header.flags & Format::FLAG_STORED) {
+            ok = streamStored(request, header, inFile, bufferSize, sink);
+        } else {
+            ok = streamSingle<Engine>(request, header, inFile, bufferSize, payloadCipher, sink);
+        }
+        if (ok && Format::hasStreamChecksum(header) && sink.hash() != header.checksum) {
+            std::cerr << "Checksum mismatch in decompressed data: " << request.compressedFile << std::endl;
+            ok = false;
+        }
+        if (!ok || !sink.finish()) {
+            sink.discard();
+            return false;
+        }
+
+        uint64_t compressedSize = request.memberSize;
+        if (compressedSize == 0) {
+            inFile.clear();
+            inFile.seekg(0, std::ios::end);
+            compressedSize = static_cast<uint64_t>(inFile.tellg()) - request.memberOffset;
+        }
+        reportDecompression(request, sink.hash(), sink.size(), compressedSize);
+        return true;
+    }
+
+    // 函数: decodeRange
+    // 用途: 只解码原始数据流中 [offset, offset + length) 所在的部分：
+    //       分块模式下由块索引找到覆盖该范围的各块，只读取并解码这些块（各块并行，并校验各块的校验和）；
+    //       单一码表模式下由同步点索引找到该范围之前最近的同步点，从该点的位偏移开始解码；
+    //       原样存储时直接读取。解码量与请求的范围（加上一个块或一个同步点间隔）成正比，与文件大小无关；
+    //       单一码表模式下未记录同步点时只能从头解码
     //
     // 参数:
-//    compressedFile - 压缩文件路径
-//    senderInfo     - 发送者信息（用于校验）
-//    receiverInfo   - 接收者信息（用于校验）
-//    decrypt        - 是否需要解密
-//    key            - 解密密钥
-    void decompressFile(const std::string &compressedFile,
-                        const std::string &senderInfo,
-                        const std::string &receiverInfo,
-                        bool decrypt,
-                        const std::string &key) {
-        // 1. 记录解压开始时间
-        auto startTime = std::chrono::high_resolution_clock::now();
-
-        // 2. 读取编码表文件，构建哈希映射：键为哈夫曼编码字符串，值为对应的字节
-        std::string encodedPath = "test/code.txt";
-        std::ifstream encodedTable(encodedPath);
-        if (!encodedTable) {
-            std::cerr << "Error opening encoded table file: " << encodedPath << std::endl;
-            return;
+    //    request     - 解压请求
+    //    header      - 已解析的文件头
+    //    payload     - 文件头之后的数据（只读，ChaCha20 加密时解密的是复制出的部分）
+    //    payloadSize - 文件头之后的数据字节数
+    //    cipher      - 按文件头中的加密方式创建的解密器
+    //    offset      - 范围在原始数据流中的起始偏移
+    //    length      - 范围的字节数（不超过 originalLength - offset）
+    //    out         - 输出缓冲区（length 字节）
+    template<typename Engine>
+    bool decodeRange(const Request &request, const Format::Header &header, const unsigned char *payload,
+                     std::size_t payloadSize, const Common::Cipher &cipher, uint64_t offset, uint64_t length,
+                     unsigned char *out) {
+        const Common::Cipher *payloadCipher = Format::encryptsPayload(header) ? &cipher : nullptr;
+        const Common::Cipher *outCipher = request.decrypt && !payloadCipher ? &cipher : nullptr;
+        uint64_t end = offset + length;
+        if (length == 0) {
+            return true;
         }
-        std::string line;
-        std::getline(encodedTable, line);
-        int TextLength = std::stoi(line);  // 获取原始文本字节长度
-        
-        std::unordered_map<std::string, unsigned char> codeMap;
-        while (std::getline(encodedTable, line)) {
-            if (line.empty()) continue;
-            std::stringstream ss(line);
-            std::string byteCodeStr;
-            std::string lengthStr;
-            ss >> byteCodeStr >> lengthStr;
-            byteCodeStr = byteCodeStr.substr(2);
-            lengthStr = lengthStr.substr(2);
-            unsigned char byteCode = static_cast<unsigned char>(std::stoi(byteCodeStr, nullptr, 16));
-            int length = std::stoi(lengthStr, nullptr, 16);
-            std::string bitCodedStr;
-            std::string bitStream;
-            while (ss >> bitCodedStr) {
-                bitCodedStr = bitCodedStr.substr(2);
-                std::string byteStr = Common::hexToBinary(bitCodedStr);
-                bitStream += byteStr;
-            }
-            std::string huffmanCode = bitStream.substr(0, length);
-            codeMap[huffmanCode] = byteCode;
-        }
-        encodedTable.close();
-
-        // 3. 读取压缩文件内容
-        std::ifstream compressedData(compressedFile, std::ios::binary);
-        if (!compressedData) {
-            std::cerr << "Error opening compressed file: " << compressedFile << std::endl;
-            return;
+        if (header.flags & Format::FLAG_STORED) {
+            if (payloadSize < header.originalLength) {
+                std::cerr << "Truncated stored data: " << request.compressedFile << std::endl;
+                return false;
+            }
+            std::memcpy(out, payload + offset, static_cast<std::size_t>(length));
+            Common::decryptAndChecksum(out, static_cast<std::size_t>(length), offset, outCipher, nullptr);
+            return true;
         }
-        std::vector<unsigned char> compressedContent;
-        compressedContent.assign(std::istreambuf_iterator<char>(compressedData), std::istreambuf_iterator<char>());
-        compressedData.close();
-
-        // 4. 解码压缩数据：逐位构建编码串，匹配哈希映射得到对应字节
-        std::vector<unsigned char> decodedBytes;
-        std::string buffer;
-        for (unsigned char byte : compressedContent) {
-            for (int pos = 7; pos >= 0 && decodedBytes.size() < TextLength; --pos) {
-                int bit = (byte >> pos) & 1;
-                buffer += (bit == 0 ? '0' : '1');
-                auto it = codeMap.find(buffer);
-                if (it != codeMap.end()) {
-                    decodedBytes.push_back(it->second);
-                    buffer.clear();
+
+        if (header.flags & Format::FLAG_BLOCKS) {
+            // 各块的原始数据起始偏移，找到覆盖 [offset, end) 的第一块与最后一块之后的一块
+            std::vector<uint64_t> outOffsets(header.blocks.size() + 1, 0);
+            for (std::size_t i = 0; i < header.blocks.size(); i++) {
+                outOffsets[i + 1] = outOffsets[i] + header.blocks[i].rawSize;
+            }
+            std::size_t first = static_cast<std::size_t>(
+                std::upper_bound(outOffsets.begin(), outOffsets.end(), offset) - outOffsets.begin() - 1);
+            std::size_t last = static_cast<std::size_t>(
+                std::lower_bound(outOffsets.begin(), outOffsets.end(), end) - outOffsets.begin());
+            std::size_t count = last - first;
+            std::vector<char> blockOk(count, 0);
+            auto decodeOne = [&](std::size_t k) {
+                std::size_t i = first + k;
+                const Format::BlockEntry &block = header.blocks[i];
+                if (block.offset > payloadSize || block.compressedSize > payloadSize - block.offset) {
+                    return;
+                }
+                std::vector<unsigned char> packed;
+                const unsigned char *data = payload + block.offset;
+                if (payloadCipher) {
+                    packed.assign(data, data + block.compressedSize);
+                    payloadCipher->decrypt(packed.data(), packed.size(), outOffsets[i]);
+                    data = packed.data();
+                }
+                std::vector<unsigned char> raw(static_cast<std::size_t>(block.rawSize));
+                if (!decodeBlock<Engine>(data, static_cast<std::size_t>(block.compressedSize), raw.data(),
+                                         block.rawSize, header.flags)) {
+                    return;
+                }
+                uint32_t checksum = 0;
+                bool verify = (header.flags & Format::FLAG_CHECKSUM) != 0;
+                Common::decryptAndChecksum(raw.data(), raw.size(), outOffsets[i], outCipher,
+                                           verify ? &checksum : nullptr);
+                if (verify && checksum != block.checksum) {
+                    std::cerr << "Checksum mismatch in block " << i << ": " << request.compressedFile << std::endl;
+                    return;
+                }
+                uint64_t from = std::max(offset, outOffsets[i]);
+                uint64_t to = std::min(end, outOffsets[i + 1]);
+                std::memcpy(out + (from - offset), raw.data() + (from - outOffsets[i]), static_cast<std::size_t>(to - from));
+                blockOk[k] = 1;
+            };
+            unsigned threads = ThreadPool::resolveThreads(request.options.threads);
+            if (threads > 1 && count > 1) {
+                ThreadPool pool(std::min<std::size_t>(threads, count));
+                pool.parallelFor(count, decodeOne);
+            } else {
+                for (std::size_t k = 0; k < count; k++) {
+                    decodeOne(k);
                 }
             }
-            if (decodedBytes.size() == TextLength) {
-                break;
+            if (!std::all_of(blockOk.begin(), blockOk.end(), [](char b) { return b != 0; })) {
+                std::cerr << "Invalid compressed block in range: " << request.compressedFile << std::endl;
+                return false;
             }
+            return true;
         }
 
-        // 5. 根据需要进行解密处理
-        std::vector<unsigned char> processedBytes = decodedBytes;
-        if (decrypt) {
-            Common::decrypt(processedBytes, key);
+        // 单一码表：从 offset 之前最近的同步点开始解码，到 end 之后的第一个同步点（或数据末尾）为止
+        Stats::Timer buildTimer(request.stats, "code generation");
+        std::shared_ptr<const SymbolDecoder<Engine>> decoder = headerDecoder<Engine>(header, request);
+        if (!decoder) {
+            return false;
         }
-
-        // 6. 校验发送者、接收者信息是否与输入一致
-        std::string fullDecoded(processedBytes.begin(), processedBytes.end());
-        std::istringstream iss(fullDecoded);
-        if (!senderInfo.empty()) {
-            std::string sender;
-            std::getline(iss, sender);
-            if (sender != senderInfo) {
-                std::cerr << "Sender info mismatch: " << senderInfo << std::endl;
-                return;
+        buildTimer.stop();
+        Format::SyncPoint start{0, 0};
+        uint64_t bitEnd = static_cast<uint64_t>(payloadSize) * 8;
+        for (const Format::SyncPoint &point : header.syncPoints) {
+            if (point.outputOffset <= offset) {
+                start = point;
+            } else if (point.outputOffset >= end) {
+                bitEnd = std::min(bitEnd, point.bitOffset);
+                break;
             }
-            std::cout << "Sender info: " << sender << std::endl;
         }
-        if (!receiverInfo.empty()) {
-            std::string receiver;
-            std::getline(iss, receiver);
-            if (receiver != receiverInfo) {
-                std::cerr << "Receiver info mismatch: " << receiverInfo << std::endl;
-                return;
+        if (start.bitOffset > bitEnd) {
+            std::cerr << "Invalid sync point index: " << request.compressedFile << std::endl;
+            return false;
+        }
+        // 只取出（按需解密）覆盖 [start, bitEnd) 的编码数据
+        std::size_t byteBegin = static_cast<std::size_t>(start.bitOffset / 8);
+        std::size_t byteEnd = static_cast<std::size_t>(std::min<uint64_t>((bitEnd + 7) / 8, payloadSize));
+        std::vector<unsigned char> packed;
+        const unsigned char *data = payload + byteBegin;
+        if (payloadCipher) {
+            packed.assign(data, payload + byteEnd);
+            payloadCipher->decrypt(packed.data(), packed.size(), byteBegin);
+            data = packed.data();
+        }
+        Stats::Timer decodeTimer(request.stats, "decode");
+        Huffman::BitReader reader(data, byteEnd - byteBegin, start.bitOffset % 8);
+        std::vector<unsigned char> skipped(static_cast<std::size_t>(offset - start.outputOffset));
+        unsigned char previous = 0;
+        if (!decoder->decode(reader, skipped.data(), skipped.size(), start.outputOffset, previous) ||
+            !decoder->decode(reader, out, static_cast<std::size_t>(length), offset, previous)) {
+            std::cerr << "Invalid Huffman code in compressed data: " << request.compressedFile << std::endl;
+            return false;
+        }
+        decodeTimer.stop();
+        Common::decryptAndChecksum(out, static_cast<std::size_t>(length), offset, outCipher, nullptr);
+        return true;
+    }
+
+    // 函数: decompressRangeImpl
+    // 用途: 解压原始数据流中 [offset, offset + length) 的部分到 out（超出数据末尾的部分被截去）：
+    //       以只读方式映射压缩文件，在解码前校验文件头中的收发人信息，再由 decodeRange 只解码覆盖该范围的部分。
+    //       旧版本的文件（收发人信息位于数据流开头）另外解码数据流开头用于校验
+    template<typename Engine>
+    bool decompressRangeImpl(const Request &request, uint64_t offset, uint64_t length,
+                             std::vector<unsigned char> &out) {
+        Stats::Timer readTimer(request.stats, "read");
+        MappedFile input;
+        if (!input.open(request.compressedFile, MappedFile::READ_ONLY)) {
+            std::cerr << "Error opening compressed file: " << request.compressedFile << std::endl;
+            return false;
+        }
+        unsigned char *member = nullptr;
+        std::size_t memberSize = 0;
+        if (!memberBytes(request, input, member, memberSize)) {
+            return false;
+        }
+        Format::Header header;
+        std::size_t payloadOffset = 0;
+        if (!Format::parseHeader(member, memberSize, header, payloadOffset)) {
+            std::cerr << "Invalid or unsupported compressed file header: " << request.compressedFile << std::endl;
+            return false;
+        }
+        if (!checkEncryption(header, request)) {
+            return false;
+        }
+        readTimer.stop();
+        if (offset > header.originalLength) {
+            std::cerr << "Range offset " << offset << " is beyond the end of the data (" << header.originalLength
+                      << " bytes): " << request.compressedFile << std::endl;
+            return false;
+        }
+        length = std::min(length, header.originalLength - offset);
+        Common::Cipher cipher = makeCipher(header, request.key);
+        if (!verifyHeaderParties(header, cipher, request)) {
+            return false;
+        }
+        const unsigned char *payload = member + payloadOffset;
+        std::size_t payloadSize = memberSize - payloadOffset;
+        if (!(header.flags & Format::FLAG_PARTIES)) {
+            std::vector<unsigned char> parties(static_cast<std::size_t>(std::min<uint64_t>(
+                partiesLength(request.senderInfo, request.receiverInfo), header.originalLength)));
+            Stats::Timer verifyTimer(request.stats, "verify");
+            if (!decodeRange<Engine>(request, header, payload, payloadSize, cipher, 0, parties.size(),
+                                     parties.data()) ||
+                !verifyParties(parties.data(), parties.size(), request.senderInfo, request.receiverInfo,
+                               request.options.verbosity >= Verbosity::SUMMARY)) {
+                return false;
             }
-            std::cout << "Receiver info: " << receiver << std::endl;
         }
+        out.resize(static_cast<std::size_t>(length));
+        return decodeRange<Engine>(request, header, payload, payloadSize, cipher, offset, length, out.data());
+    }
 
-        // 7. 将解码后的数据写入输出文件，文件名格式为 "原文件名_j.txt"
-        std::string outputFile = "test/" + Common::extractFileName(compressedFile) + "_j.txt";
-        std::ofstream outFile(outputFile, std::ios::binary);
-        if (!outFile) {
-            std::cerr << "Error opening output file: " << outputFile << std::endl;
-            return;
+    // 函数: runRangeDecompression
+    // 用途: 范围解压的统一入口，设置了统计信息输出目标时记录各阶段耗时
+    template<typename Engine>
+    bool runRangeDecompression(const std::string &engineName,
+                               const std::string &compressedFile,
+                               uint64_t offset,
+                               uint64_t length,
+                               std::vector<unsigned char> &out,
+                               const std::string &senderInfo,
+                               const std::string &receiverInfo,
+                               bool decrypt,
+                               const std::string &key,
+                               const Decompressor::Options &options) {
+        Stats stats;
+        Stats *collector = options.statsFile.empty() ? nullptr : &stats;
+        if (collector) {
+            stats.set("file", compressedFile);
+            stats.set("operation", "decompress range");
+            stats.set("engine", engineName);
+            stats.set("range_offset", static_cast<double>(offset));
         }
-        outFile.write(reinterpret_cast<const char *>(processedBytes.data()), processedBytes.size());
-        outFile.close();
+        Request request{engineName, compressedFile, senderInfo, receiverInfo, decrypt, key, options,
+                        std::chrono::high_resolution_clock::now(), collector};
+        bool ok = decompressRangeImpl<Engine>(request, offset, length, out);
+        if (!ok) {
+            out.clear();
+        }
+        if (collector) {
+            auto endTime = std::chrono::high_resolution_clock::now();
+            stats.set("status", ok ? "ok" : "failed");
+            stats.set("range_bytes", static_cast<double>(out.size()));
+            stats.set("total_ms", std::chrono::duration<double, std::milli>(endTime - request.startTime).count());
+            stats.write(options.statsFile, options.statsFormat);
+        }
+        return ok;
+    }
 
-        // 8. 显示解码后数据的 HASH 和大小
-        std::string decompressedDataHash = Common::calculateHash(processedBytes);
-        std::cout << "Decompressed data hash: 0x" << decompressedDataHash << std::endl;
-        std::cout << "Decompressed data size: " << processedBytes.size() << std::endl;
+    // 函数: runDecompression
+    // 用途: 按解压选项选择整体读入内存解压或流式解压；memberSize 不为 0 时只解压文件中
+    //       自 memberOffset 起的 memberSize 个字节（归档中的一个成员）
+    template<typename Engine>
+    bool runDecompression(const std::string &engineName,
+                          const std::string &compressedFile,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool decrypt,
+                          const std::string &key,
+                          const Decompressor::Options &options,
+                          uint64_t memberOffset = 0,
+                          uint64_t memberSize = 0) {
+        // 记录解压开始时间；设置了统计信息输出目标时收集各阶段耗时
+        Stats stats;
+        Stats *collector = options.statsFile.empty() ? nullptr : &stats;
+        if (collector) {
+            stats.set("file", compressedFile);
+            stats.set("operation", "decompress");
+            stats.set("engine", engineName);
+            stats.set("mode", options.streaming ? "streaming" : "memory");
+        }
+        Request request{engineName, compressedFile, senderInfo, receiverInfo, decrypt, key, options,
+                        std::chrono::high_resolution_clock::now(), collector, memberOffset, memberSize};
+        bool ok = options.streaming ? decompressStreaming<Engine>(request) : decompressInMemory<Engine>(request);
+        if (collector) {
+            auto endTime = std::chrono::high_resolution_clock::now();
+            stats.set("status", ok ? "ok" : "failed");
+            stats.set("total_ms", std::chrono::duration<double, std::milli>(endTime - request.startTime).count());
+            stats.write(options.statsFile, options.statsFormat);
+        }
+        return ok;
+    }
+}
 
-        // 9. 记录结束时间，计算解压用时（毫秒）
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        std::cout << "Hash decompression completed in " << duration.count() << "ms" << std::endl;
+namespace TrieDecompressor {
+    // 函数: decompressFile
+    // 用途: 使用字典树方式（Trie）解压压缩文件，主要步骤：
+    //       1. 记录解压开始时间
+    //       2. 读取压缩文件，由文件头中的编码长度重建范式编码并构建字典树
+    //       3. 逐位遍历压缩数据，通过字典树进行解码
+    //       4. 若设置了解密，则进行解密处理
+    //       5. 校验收发人信息（与文件中存储信息比较）
+    //       6. 将解压后的数据写入输出文件
+    //       7. 显示解压过程的 HASH 值、数据大小及解压所耗时间
+    //
+    // 参数:
+//    compressedFile - 压缩文件路径
+//    senderInfo     - 发送者信息（用于校验）
+//    receiverInfo   - 接收者信息（用于校验）
+//    decrypt        - 是否需要解密
+//    key            - 解密密钥
+//    options        - 解压选项
+    bool decompressFile(const std::string &compressedFile,
+                        const std::string &senderInfo,
+                        const std::string &receiverInfo,
+                        bool decrypt,
+                        const std::string &key,
+                        const Decompressor::Options &options) {
+        return runDecompression<TrieEngine>("01Trie", compressedFile, senderInfo, receiverInfo, decrypt, key, options);
+    }
 
-        // 10. 计算并显示压缩比率
-        double compressionRatio = static_cast<double>(compressedContent.size()) / processedBytes.size();
-        std::cout << "Compression ratio: " << compressionRatio << std::endl << std::endl;
+    // 函数: decompressRange
+    // 用途: 只解压原始数据中 [offset, offset + length) 的部分，见 decodeRange
+    bool decompressRange(const std::string &compressedFile,
+                         uint64_t offset,
+                         uint64_t length,
+                         std::vector<unsigned char> &out,
+                         const std::string &senderInfo,
+                         const std::string &receiverInfo,
+                         bool decrypt,
+                         const std::string &key,
+                         const Decompressor::Options &options) {
+        return runRangeDecompression<TrieEngine>("01Trie", compressedFile, offset, length, out, senderInfo, receiverInfo,
+                                         decrypt, key, options);
+    }
+
+    // 函数: decompressMember
+    // 用途: 解压文件中自 memberOffset 起的 memberSize 个字节（归档中的一个成员，见 archive.h）
+    bool decompressMember(const std::string &compressedFile,
+                          uint64_t memberOffset,
+                          uint64_t memberSize,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool decrypt,
+                          const std::string &key,
+                          const Decompressor::Options &options) {
+        return runDecompression<TrieEngine>("01Trie", compressedFile, senderInfo, receiverInfo, decrypt, key, options,
+                                    memberOffset, memberSize);
+    }
+}
+
+namespace HashDecompressor {
+    // 函数: decompressFile
+    // 用途: 使用哈希映射方式解压文件，其步骤类似于字典树解码，不过构建的是从编码串到字节值的哈希映射
+    //
+    // 参数:
+//    compressedFile - 压缩文件路径
+//    senderInfo     - 发送者信息（用于校验）
+//    receiverInfo   - 接收者信息（用于校验）
+//    decrypt        - 是否需要解密
+//    key            - 解密密钥
+//    options        - 解压选项
+    bool decompressFile(const std::string &compressedFile,
+                        const std::string &senderInfo,
+                        const std::string &receiverInfo,
+                        bool decrypt,
+                        const std::string &key,
+                        const Decompressor::Options &options) {
+        return runDecompression<HashEngine>("Hash", compressedFile, senderInfo, receiverInfo, decrypt, key, options);
+    }
+
+    // 函数: decompressRange
+    // 用途: 只解压原始数据中 [offset, offset + length) 的部分，见 decodeRange
+    bool decompressRange(const std::string &compressedFile,
+                         uint64_t offset,
+                         uint64_t length,
+                         std::vector<unsigned char> &out,
+                         const std::string &senderInfo,
+                         const std::string &receiverInfo,
+                         bool decrypt,
+                         const std::string &key,
+                         const Decompressor::Options &options) {
+        return runRangeDecompression<HashEngine>("Hash", compressedFile, offset, length, out, senderInfo, receiverInfo,
+                                         decrypt, key, options);
+    }
+
+    // 函数: decompressMember
+    // 用途: 解压文件中自 memberOffset 起的 memberSize 个字节（归档中的一个成员，见 archive.h）
+    bool decompressMember(const std::string &compressedFile,
+                          uint64_t memberOffset,
+                          uint64_t memberSize,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool decrypt,
+                          const std::string &key,
+                          const Decompressor::Options &options) {
+        return runDecompression<HashEngine>("Hash", compressedFile, senderInfo, receiverInfo, decrypt, key, options,
+                                    memberOffset, memberSize);
+    }
+}
+
+namespace TableDecompressor {
+    // 函数: decompressFile
+    // 用途: 使用多位查表方式解压文件。由文件头中的编码长度预先构建以接下来 11 位为下标的主表
+    //       （更长的编码放入二级子表），解码时从 64 位位缓冲区中一次查出一个完整符号，
+    //       不再逐位遍历；输出与字典树、哈希映射两种方式逐字节一致
+    //
+    // 参数:
+//    compressedFile - 压缩文件路径
+//    senderInfo     - 发送者信息（用于校验）
+//    receiverInfo   - 接收者信息（用于校验）
+//    decrypt        - 是否需要解密
+//    key            - 解密密钥
+//    options        - 解压选项
+    bool decompressFile(const std::string &compressedFile,
+                        const std::string &senderInfo,
+                        const std::string &receiverInfo,
+                        bool decrypt,
+                        const std::string &key,
+                        const Decompressor::Options &options) {
+        return runDecompression<TableEngine>("Table", compressedFile, senderInfo, receiverInfo, decrypt, key, options);
+    }
+
+    // 函数: decompressRange
+    // 用途: 只解压原始数据中 [offset, offset + length) 的部分，见 decodeRange
+    bool decompressRange(const std::string &compressedFile,
+                         uint64_t offset,
+                         uint64_t length,
+                         std::vector<unsigned char> &out,
+                         const std::string &senderInfo,
+                         const std::string &receiverInfo,
+                         bool decrypt,
+                         const std::string &key,
+                         const Decompressor::Options &options) {
+        return runRangeDecompression<TableEngine>("Table", compressedFile, offset, length, out, senderInfo, receiverInfo,
+                                         decrypt, key, options);
+    }
+
+    // 函数: decompressMember
+    // 用途: 解压文件中自 memberOffset 起的 memberSize 个字节（归档中的一个成员，见 archive.h）
+    bool decompressMember(const std::string &compressedFile,
+                          uint64_t memberOffset,
+                          uint64_t memberSize,
+                          const std::string &senderInfo,
+                          const std::string &receiverInfo,
+                          bool decrypt,
+                          const std::string &key,
+                          const Decompressor::Options &options) {
+        return runDecompression<TableEngine>("Table", compressedFile, senderInfo, receiverInfo, decrypt, key, options,
+                                    memberOffset, memberSize);
     }
 }
\ No newline at end of file
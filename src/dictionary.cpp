@@ -0,0 +1,181 @@
+#include "dictionary.h"
+#include "crc32c.h"
+#include "huffman.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+// 匿名命名空间：码表部分的读写与校验
+namespace {
+    // 字典文件中码表之前的固定部分的长度（魔数、版本号、保留、标志位与 ID）
+    constexpr std::size_t PREAMBLE_SIZE = 12;
+
+    // 函数: serializeTables
+    // 用途: 将码表部分（不含固定部分）追加到 out
+    void serializeTables(const Dictionary::Tables &tables, std::vector<unsigned char> &out) {
+        if (tables.contextual) {
+            Format::serializeContextTables(tables.contexts, out);
+        } else {
+            out.insert(out.end(), tables.codeLengths.begin(), tables.codeLengths.end());
+        }
+    }
+
+    // 函数: completeTable
+    // 用途: 码表是否为全部 256 个字节值都分配了编码，且各编码长度构成合法的前缀码
+    bool completeTable(const std::array<uint8_t, 256> &lengths) {
+        for (uint8_t length : lengths) {
+            if (length == 0) {
+                return false;
+            }
+        }
+        return !Huffman::canonicalCodes(std::vector<uint8_t>(lengths.begin(), lengths.end())).empty();
+    }
+
+    // 按路径缓存的字典，文件的修改时间或大小变化时重新读取
+    struct CacheEntry {
+        std::string path;
+        std::shared_ptr<const Dictionary::Tables> tables;
+        fs::file_time_type modified;
+        std::uintmax_t size = 0;
+    };
+
+    // 缓存的最大字典数，超过时丢弃最久未使用的一项
+    constexpr std::size_t CACHE_SIZE = 16;
+}
+
+namespace Dictionary {
+    uint32_t computeId(const Tables &tables) {
+        std::vector<unsigned char> body;
+        serializeTables(tables, body);
+        return CRC32C::update(0, body.data(), body.size());
+    }
+
+    bool save(const std::string &path, const Tables &tables) {
+        std::vector<unsigned char> out(MAGIC, MAGIC + sizeof(MAGIC));
+        uint16_t flags = tables.contextual ? FLAG_CONTEXT : 0;
+        uint32_t id = computeId(tables);
+        out.push_back(VERSION);
+        out.push_back(0);
+        out.push_back(static_cast<unsigned char>(flags));
+        out.push_back(static_cast<unsigned char>(flags >> 8));
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<unsigned char>(id >> (8 * i)));
+        }
+        serializeTables(tables, out);
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size()));
+        file.close();
+        if (!file) {
+            std::cerr << "Error writing dictionary file: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 函数: load
+    // 用途: 主要步骤：
+    //       1. 读取整个文件，校验魔数与版本号
+    //       2. 按标志位解析单一码表或上下文码表，码表须恰好占满文件的其余部分
+    //       3. 校验 ID 与码表一致，且每张码表都是覆盖全部字节值的合法前缀码
+    bool load(const std::string &path, Tables &tables) {
+        // 1. 读取文件并校验固定部分
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error opening dictionary file: " << path << std::endl;
+            return false;
+        }
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.size() < PREAMBLE_SIZE || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+            data[4] != VERSION) {
+            std::cerr << "Not a dictionary file or unsupported version: " << path << std::endl;
+            return false;
+        }
+        uint16_t flags = static_cast<uint16_t>(data[6] | (data[7] << 8));
+        uint32_t id = 0;
+        for (int i = 3; i >= 0; i--) {
+            id = (id << 8) | data[8 + i];
+        }
+
+        // 2. 解析码表
+        const unsigned char *body = data.data() + PREAMBLE_SIZE;
+        std::size_t bodySize = data.size() - PREAMBLE_SIZE;
+        tables.contextual = (flags & FLAG_CONTEXT) != 0;
+        bool ok;
+        if (tables.contextual) {
+            std::size_t used = 0;
+            ok = Format::parseContextTables(body, bodySize, tables.contexts, used) && used == bodySize;
+        } else {
+            ok = bodySize == tables.codeLengths.size();
+            if (ok) {
+                std::copy(body, body + bodySize, tables.codeLengths.begin());
+            }
+        }
+
+        // 3. 校验 ID 与各码表
+        ok = ok && CRC32C::update(0, body, bodySize) == id;
+        if (ok && tables.contextual) {
+            for (const std::array<uint8_t, 256> &lengths : tables.contexts.lengths) {
+                ok = ok && completeTable(lengths);
+            }
+        } else if (ok) {
+            ok = completeTable(tables.codeLengths);
+        }
+        if (!ok) {
+            std::cerr << "Invalid dictionary file: " << path << std::endl;
+            return false;
+        }
+        tables.id = id;
+        return true;
+    }
+
+    // 函数: open
+    // 用途: 缓存为按最近使用排序的链表，命中时移到表头
+    std::shared_ptr<const Tables> open(const std::string &path) {
+        static std::mutex mutex;
+        static std::list<CacheEntry> cache;
+        std::error_code ec;
+        fs::file_time_type modified = fs::last_write_time(path, ec);
+        std::uintmax_t size = fs::file_size(path, ec);
+        if (ec) {
+            std::cerr << "Error opening dictionary file: " << path << std::endl;
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(cache.begin(), cache.end(), [&](const CacheEntry &entry) { return entry.path == path; });
+        if (it != cache.end() && it->modified == modified && it->size == size) {
+            cache.splice(cache.begin(), cache, it);
+            return it->tables;
+        }
+        if (it != cache.end()) {
+            cache.erase(it);
+        }
+        std::shared_ptr<Tables> tables = std::make_shared<Tables>();
+        if (!load(path, *tables)) {
+            return nullptr;
+        }
+        cache.push_front(CacheEntry{path, tables, modified, size});
+        if (cache.size() > CACHE_SIZE) {
+            cache.pop_back();
+        }
+        return tables;
+    }
+
+    void fillHeader(const Tables &tables, Format::Header &header) {
+        header.flags |= Format::FLAG_DICTIONARY;
+        header.dictionaryId = tables.id;
+        if (tables.contextual) {
+            header.flags |= Format::FLAG_CONTEXT;
+            header.contexts = tables.contexts;
+        } else {
+            header.codeLengths = tables.codeLengths;
+        }
+    }
+}
@@ -0,0 +1,356 @@
+#include "format.h"
+#include <cstring>
+
+// 匿名命名空间：按小端序读写定长整数
+namespace {
+    void putLE(std::vector<unsigned char> &out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    uint64_t getLE(const unsigned char *data, int bytes) {
+        uint64_t value = 0;
+        for (int i = bytes - 1; i >= 0; i--) {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+
+    // 文件头中文件头总长度字段的偏移
+    constexpr std::size_t HEADER_SIZE_OFFSET = 8;
+
+    // 类: ByteReader
+    // 用途: 带边界检查的顺序读取器，越界后 ok() 返回 false，后续读取结果均为 0
+    class ByteReader {
+    public:
+        ByteReader(const unsigned char *data, std::size_t size) : p(data), end(data + size), valid(true) {}
+
+        uint64_t get(int bytes) {
+            if (!require(bytes)) {
+                return 0;
+            }
+            uint64_t value = getLE(p, bytes);
+            p += bytes;
+            return value;
+        }
+
+        void copy(unsigned char *dst, std::size_t n) {
+            if (!require(n)) {
+                return;
+            }
+            std::memcpy(dst, p, n);
+            p += n;
+        }
+
+        bool ok() const { return valid; }
+
+        const unsigned char *position() const { return p; }
+
+        std::size_t remaining() const { return valid ? static_cast<std::size_t>(end - p) : 0; }
+
+    private:
+        const unsigned char *p;
+        const unsigned char *end;
+        bool valid;
+
+        bool require(std::size_t n) {
+            if (!valid || static_cast<std::size_t>(end - p) < n) {
+                valid = false;
+                return false;
+            }
+            return true;
+        }
+    };
+
+    // 位图（32 字节，256 位）中第 i 位是否为 1
+    inline bool testBit(const unsigned char *bitmap, unsigned i) {
+        return (bitmap[i >> 3] >> (i & 7)) & 1;
+    }
+
+    // 函数: putTable
+    // 用途: 写出一张码表：符号位图加上各有编码的字节值的编码长度
+    void putTable(const std::array<uint8_t, 256> &lengths, std::vector<unsigned char> &out) {
+        std::size_t bitmap = out.size();
+        out.resize(bitmap + 32, 0);
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            if (lengths[symbol] != 0) {
+                out[bitmap + (symbol >> 3)] |= static_cast<unsigned char>(1u << (symbol & 7));
+                out.push_back(lengths[symbol]);
+            }
+        }
+    }
+
+    // 函数: readContextTables
+    // 用途: 读取上下文位图与各码表，码表中有编码的字节值的编码长度不能为 0
+    bool readContextTables(ByteReader &reader, Format::ContextTables &tables) {
+        unsigned char contextBitmap[32];
+        reader.copy(contextBitmap, 32);
+        if (!reader.ok()) {
+            return false;
+        }
+        uint16_t tableCount = 1;
+        for (unsigned context = 0; context < 256; context++) {
+            tables.tableOf[context] = testBit(contextBitmap, context) ? tableCount++ : 0;
+        }
+        tables.lengths.assign(tableCount, std::array<uint8_t, 256>{});
+        for (std::array<uint8_t, 256> &lengths : tables.lengths) {
+            unsigned char symbolBitmap[32];
+            reader.copy(symbolBitmap, 32);
+            for (unsigned symbol = 0; symbol < 256 && reader.ok(); symbol++) {
+                if (testBit(symbolBitmap, symbol)) {
+                    lengths[symbol] = static_cast<uint8_t>(reader.get(1));
+                    if (lengths[symbol] == 0) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return reader.ok();
+    }
+}
+
+namespace Format {
+    // 函数: serializeHeader
+    // 用途: 按文件格式将文件头各字段依次写入字节数组，并回填文件头总长度
+    std::vector<unsigned char> serializeHeader(const Header &header) {
+        std::vector<unsigned char> out(MAGIC, MAGIC + 4);
+        out.push_back(header.version);
+        out.push_back(0);
+        putLE(out, header.flags, 2);
+        putLE(out, 0, 4); // 文件头总长度，稍后回填
+        putLE(out, header.originalLength, 8);
+        if (header.flags & FLAG_CHACHA20) {
+            out.insert(out.end(), header.salt.begin(), header.salt.end());
+            putLE(out, header.nonce, 8);
+            putLE(out, header.kdfIterations, 4);
+        }
+        if (header.flags & FLAG_PARTIES) {
+            for (const std::string *info : {&header.senderInfo, &header.receiverInfo}) {
+                putLE(out, info->size(), 4);
+                out.insert(out.end(), info->begin(), info->end());
+            }
+        }
+        if (hasStreamChecksum(header)) {
+            putLE(out, header.checksum, 4);
+        }
+        if (header.flags & FLAG_STORED) {
+            // 原样存储：没有码表
+        } else if (header.flags & FLAG_BLOCKS) {
+            putLE(out, header.blocks.size(), 4);
+            for (const BlockEntry &block : header.blocks) {
+                putLE(out, block.offset, 8);
+                putLE(out, block.compressedSize, 8);
+                putLE(out, block.rawSize, 8);
+                if (header.flags & FLAG_CHECKSUM) {
+                    putLE(out, block.checksum, 4);
+                }
+            }
+        } else {
+            if (header.flags & FLAG_DICTIONARY) {
+                putLE(out, header.dictionaryId, 4);
+            } else if (header.flags & FLAG_CONTEXT) {
+                serializeContextTables(header.contexts, out);
+            } else {
+                out.insert(out.end(), header.codeLengths.begin(), header.codeLengths.end());
+            }
+            if (header.flags & FLAG_SYNC_POINTS) {
+                putLE(out, header.syncInterval, 8);
+                putLE(out, header.syncPoints.size(), 4);
+                for (const SyncPoint &point : header.syncPoints) {
+                    putLE(out, point.bitOffset, 8);
+                    putLE(out, point.outputOffset, 8);
+                }
+            }
+        }
+
+        uint64_t headerSize = out.size();
+        for (int i = 0; i < 4; i++) {
+            out[HEADER_SIZE_OFFSET + i] = static_cast<unsigned char>(headerSize >> (8 * i));
+        }
+        return out;
+    }
+
+    // 函数: parseHeader
+    // 用途: 校验魔数与版本号并解析文件头
+    //
+    // 参数:
+    //    data       - 文件内容起始地址
+    //    size       - 可用字节数
+    //    header     - 输出：解析得到的文件头
+    //    headerSize - 输出：文件头总长度
+    //
+    // 返回:
+    //    解析成功返回 true
+    bool parseHeader(const unsigned char *data, std::size_t size, Header &header, std::size_t &headerSize) {
+        if (size < PREAMBLE_SIZE || std::memcmp(data, MAGIC, 4) != 0) {
+            return false;
+        }
+        header.version = data[4];
+        if (header.version != VERSION) {
+            return false;
+        }
+        header.flags = static_cast<uint16_t>(getLE(data + 6, 2));
+        // LZ77 模式与 BWT 模式只用于分块模式，且与上下文模式三者互斥
+        uint16_t transforms = header.flags & (FLAG_LZ77 | FLAG_BWT | FLAG_CONTEXT);
+        if ((header.flags & (FLAG_LZ77 | FLAG_BWT)) &&
+            (!(header.flags & FLAG_BLOCKS) || (transforms & (transforms - 1)) != 0)) {
+            return false;
+        }
+        // 原样存储不与其他编码方式同时使用
+        if ((header.flags & FLAG_STORED) &&
+            (header.flags & (FLAG_BLOCKS | FLAG_SYNC_POINTS | FLAG_CONTEXT | FLAG_LZ77 | FLAG_BWT))) {
+            return false;
+        }
+        // 共享字典只用于单一码表模式
+        if ((header.flags & FLAG_DICTIONARY) && (header.flags & (FLAG_BLOCKS | FLAG_STORED))) {
+            return false;
+        }
+        // ChaCha20 加密须同时设置加密标志，且不与异或加密同时使用
+        if ((header.flags & FLAG_CHACHA20) &&
+            (!(header.flags & FLAG_ENCRYPTED) || (header.flags & FLAG_XOR_KEY))) {
+            return false;
+        }
+        headerSize = static_cast<std::size_t>(getLE(data + HEADER_SIZE_OFFSET, 4));
+        if (headerSize > size || headerSize < PREAMBLE_SIZE) {
+            return false;
+        }
+        ByteReader reader(data + PREAMBLE_SIZE, headerSize - PREAMBLE_SIZE);
+        header.originalLength = reader.get(8);
+        header.nonce = 0;
+        header.kdfIterations = 0;
+        if (header.flags & FLAG_CHACHA20) {
+            reader.copy(header.salt.data(), SALT_SIZE);
+            header.nonce = reader.get(8);
+            header.kdfIterations = static_cast<uint32_t>(reader.get(4));
+            if (header.kdfIterations == 0 || header.kdfIterations > MAX_KDF_ITERATIONS) {
+                return false;
+            }
+        }
+        header.senderInfo.clear();
+        header.receiverInfo.clear();
+        if (header.flags & FLAG_PARTIES) {
+            for (std::string *info : {&header.senderInfo, &header.receiverInfo}) {
+                uint64_t length = reader.get(4);
+                if (length > reader.remaining()) {
+                    return false;
+                }
+                info->resize(static_cast<std::size_t>(length));
+                reader.copy(reinterpret_cast<unsigned char *>(&(*info)[0]), info->size());
+            }
+        }
+        header.checksum = hasStreamChecksum(header) ? static_cast<uint32_t>(reader.get(4)) : 0;
+        header.blocks.clear();
+        if (header.flags & FLAG_STORED) {
+            return reader.ok();
+        }
+        if (header.flags & FLAG_BLOCKS) {
+            uint64_t blockCount = reader.get(4);
+            bool blockChecksums = (header.flags & FLAG_CHECKSUM) != 0;
+            if (blockCount > reader.remaining() / (blockChecksums ? 28 : 24)) {
+                return false;
+            }
+            header.blocks.resize(static_cast<std::size_t>(blockCount));
+            uint64_t total = 0;
+            for (BlockEntry &block : header.blocks) {
+                block.offset = reader.get(8);
+                block.compressedSize = reader.get(8);
+                block.rawSize = reader.get(8);
+                block.checksum = blockChecksums ? static_cast<uint32_t>(reader.get(4)) : 0;
+                total += block.rawSize;
+            }
+            if (total != header.originalLength) {
+                return false;
+            }
+        } else {
+            header.dictionaryId = 0;
+            if (header.flags & FLAG_DICTIONARY) {
+                header.dictionaryId = static_cast<uint32_t>(reader.get(4));
+            } else if (header.flags & FLAG_CONTEXT) {
+                if (!readContextTables(reader, header.contexts)) {
+                    return false;
+                }
+            } else {
+                reader.copy(header.codeLengths.data(), 256);
+            }
+            header.syncInterval = 0;
+            header.syncPoints.clear();
+            if (header.flags & FLAG_SYNC_POINTS) {
+                header.syncInterval = reader.get(8);
+                uint64_t pointCount = reader.get(4);
+                if (pointCount > reader.remaining() / 16) {
+                    return false;
+                }
+                header.syncPoints.resize(static_cast<std::size_t>(pointCount));
+                uint64_t lastOutput = 0;
+                for (SyncPoint &point : header.syncPoints) {
+                    point.bitOffset = reader.get(8);
+                    point.outputOffset = reader.get(8);
+                    // 同步点须按原始数据偏移严格递增且不超过原始数据长度
+                    if (point.outputOffset <= lastOutput || point.outputOffset > header.originalLength) {
+                        return false;
+                    }
+                    lastOutput = point.outputOffset;
+                }
+            }
+        }
+        return reader.ok();
+    }
+
+    // 函数: readHeader
+    // 用途: 先读取定长前导部分得到文件头总长度，再读取并解析完整文件头
+    bool readHeader(std::istream &in, Header &header) {
+        std::vector<unsigned char> buffer(PREAMBLE_SIZE);
+        if (!in.read(reinterpret_cast<char *>(buffer.data()), PREAMBLE_SIZE)) {
+            return false;
+        }
+        std::size_t headerSize = static_cast<std::size_t>(getLE(buffer.data() + HEADER_SIZE_OFFSET, 4));
+        if (headerSize < PREAMBLE_SIZE || headerSize > (1u << 30)) {
+            return false;
+        }
+        buffer.resize(headerSize);
+        if (!in.read(reinterpret_cast<char *>(buffer.data() + PREAMBLE_SIZE), headerSize - PREAMBLE_SIZE)) {
+            return false;
+        }
+        std::size_t parsedSize = 0;
+        return parseHeader(buffer.data(), buffer.size(), header, parsedSize);
+    }
+
+    // 函数: serializeContextTables
+    // 用途: 写出上下文位图，再依次写出后备表与各上下文自己的码表（按上下文递增）
+    void serializeContextTables(const ContextTables &tables, std::vector<unsigned char> &out) {
+        std::size_t bitmap = out.size();
+        out.resize(bitmap + 32, 0);
+        std::vector<uint16_t> order;
+        for (unsigned context = 0; context < 256; context++) {
+            if (tables.tableOf[context] != 0) {
+                out[bitmap + (context >> 3)] |= static_cast<unsigned char>(1u << (context & 7));
+                order.push_back(tables.tableOf[context]);
+            }
+        }
+        putTable(tables.lengths[0], out);
+        for (uint16_t table : order) {
+            putTable(tables.lengths[table], out);
+        }
+    }
+
+    // 函数: parseContextTables
+    // 用途: 解析上下文码表（分块模式下位于每块数据开头）
+    //
+    // 参数:
+    //    data   - 码表起始地址
+    //    size   - 可用字节数
+    //    tables - 输出：解析得到的码表，自有码表的下标按上下文递增依次为 1、2、...
+    //    used   - 输出：码表的字节数
+    //
+    // 返回:
+    //    解析成功返回 true
+    bool parseContextTables(const unsigned char *data, std::size_t size, ContextTables &tables, std::size_t &used) {
+        ByteReader reader(data, size);
+        if (!readContextTables(reader, tables)) {
+            return false;
+        }
+        used = static_cast<std::size_t>(reader.position() - data);
+        return true;
+    }
+}
@@ -0,0 +1,349 @@
+#include "huffman.h"
+#include <algorithm>
+#include <map>
+
+namespace {
+    using Huffman::AlignedCode;
+
+    // 函数: putGroups
+    // 用途: 从第 i 个符号起，每次放入 GROUP 个编码后写出一次整字节，直到剩余不足 GROUP 个符号
+    //       （GROUP 个编码的总长度须不超过 56 位）。累加器高位对齐，放入编码只需一次移位与按位或，
+    //       移位量只依赖位数的累加，不在累加器的依赖链上；lookup(j) 返回第 j 个符号的编码
+    template<unsigned GROUP, typename Lookup>
+    inline unsigned char *putGroups(std::size_t size, const Lookup &lookup,
+                                    uint64_t &acc, unsigned &bits, unsigned char *cursor, std::size_t &i) {
+        uint64_t localAcc = acc;
+        uint64_t localBits = bits;
+        for (; i + GROUP <= size; i += GROUP) {
+            for (unsigned k = 0; k < GROUP; k++) {
+                const AlignedCode &code = lookup(i + k);
+                localAcc |= code.bits >> localBits;
+                localBits += code.length;
+            }
+            Huffman::storeBigEndian64(cursor, localAcc);
+            // 放入编码后累加器中至多 63 位，因此左移量至多 56 位
+            uint64_t bytes = localBits >> 3;
+            cursor += bytes;
+            localAcc <<= bytes * 8;
+            localBits &= 7;
+        }
+        acc = localAcc;
+        bits = static_cast<unsigned>(localBits);
+        return cursor;
+    }
+
+    // 函数: extractBits
+    // 用途: 取出编码中从第 depth 位（高位起算）开始的 n 位
+    inline uint64_t extractBits(const Huffman::Code &code, unsigned depth, unsigned n) {
+        uint64_t value = code.bits >> (code.length - depth - n);
+        return n >= 64 ? value : (value & ((1ULL << n) - 1));
+    }
+
+    // 函数: alignCode
+    // 用途: 将编码转换为高位对齐形式
+    inline AlignedCode alignCode(const Huffman::Code &code) {
+        return AlignedCode{code.length ? code.bits << (64 - code.length) : 0, code.length};
+    }
+}
+
+namespace Huffman {
+    // 函数: BitWriter::putAligned
+    // 用途: 编码主循环。累加器、位数与写入位置在循环内保存在局部变量中，
+    //       避免每次写出后编译器因别名问题重新从内存读取成员；
+    //       每批至多 SYMBOL_BATCH 个符号，批前确保输出数组容量足够，循环内不再检查
+    //
+    // 参数:
+    //    begin     - 起始符号下标
+    //    size      - 符号总数
+    //    maxLength - 各编码的最长位数（不超过 56）
+    //    lookup    - lookup(i) 返回第 i 个符号的高位对齐编码
+    template<typename Lookup>
+    void BitWriter::putAligned(std::size_t begin, std::size_t size, unsigned maxLength, const Lookup &lookup) {
+        constexpr std::size_t SYMBOL_BATCH = 4096;
+        uint64_t acc = count ? buffer << (64 - count) : 0;
+        unsigned bits = count;
+        std::size_t done = begin;
+        while (done < size) {
+            std::size_t batch = std::min(size - done, SYMBOL_BATCH);
+            reserve(batch * 8);
+            unsigned char *cursor = out.data() + pos;
+            unsigned char *start = cursor;
+            auto at = [&lookup, done](std::size_t i) -> const AlignedCode & { return lookup(done + i); };
+            std::size_t i = 0;
+            // 写出后累加器中不足 8 位，因此最长编码不超过 14/18/28 位时，每写出一次可连续放入 4/3/2 个编码
+            if (maxLength <= 14) {
+                cursor = putGroups<4>(batch, at, acc, bits, cursor, i);
+            } else if (maxLength <= 18) {
+                cursor = putGroups<3>(batch, at, acc, bits, cursor, i);
+            } else if (maxLength <= 28) {
+                cursor = putGroups<2>(batch, at, acc, bits, cursor, i);
+            }
+            cursor = putGroups<1>(batch, at, acc, bits, cursor, i);
+            pos += static_cast<std::size_t>(cursor - start);
+            done += batch;
+        }
+        buffer = bits ? acc >> (64 - bits) : 0;
+        count = bits;
+    }
+
+    // 函数: BitWriter::putSymbols
+    // 用途: 按单一编码表编码，编码表先转换为高位对齐形式，再进入编码主循环
+    void BitWriter::putSymbols(const unsigned char *data, std::size_t size, const Code *codes) {
+        unsigned maxLength = 0;
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            maxLength = std::max(maxLength, codes[symbol].length);
+        }
+        if (maxLength > 56) {
+            for (std::size_t i = 0; i < size; i++) {
+                put(codes[data[i]].bits, codes[data[i]].length);
+            }
+            return;
+        }
+        // 累加器在主循环中改为高位对齐
+        AlignedCode aligned[256];
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            aligned[symbol] = alignCode(codes[symbol]);
+        }
+        putAligned(0, size, maxLength, [&](std::size_t i) -> const AlignedCode & { return aligned[data[i]]; });
+    }
+
+    // 函数: BitWriter::putContextSymbols
+    // 用途: 按一阶上下文编码表编码。第一个字节以 previous 为上下文单独写入，
+    //       其后第 i 个字节的上下文即 data[i - 1]，主循环中无需分支
+    void BitWriter::putContextSymbols(const unsigned char *data, std::size_t size, unsigned char previous,
+                                      const ContextCodes &contexts) {
+        if (size == 0) {
+            return;
+        }
+        const Code &first = contexts.code(previous, data[0]);
+        put(first.bits, first.length);
+        if (contexts.longest > 56) {
+            for (std::size_t i = 1; i < size; i++) {
+                const Code &code = contexts.code(data[i - 1], data[i]);
+                put(code.bits, code.length);
+            }
+            return;
+        }
+        const AlignedCode *aligned = contexts.aligned.data();
+        const std::size_t *offset = contexts.offset.data();
+        putAligned(1, size, contexts.longest, [&](std::size_t i) -> const AlignedCode & {
+            return aligned[offset[data[i - 1]] + data[i]];
+        });
+    }
+
+    // 函数: ContextCodes::ContextCodes
+    // 用途: 将各编码表依次存放，并记录各上下文所用表的起始下标
+    ContextCodes::ContextCodes(const std::vector<std::vector<Code>> &tables, const std::array<uint16_t, 256> &tableOf) {
+        for (const std::vector<Code> &table : tables) {
+            for (unsigned symbol = 0; symbol < 256; symbol++) {
+                codes.push_back(table[symbol]);
+                aligned.push_back(alignCode(table[symbol]));
+                longest = std::max(longest, table[symbol].length);
+            }
+        }
+        for (unsigned context = 0; context < 256; context++) {
+            offset[context] = static_cast<std::size_t>(tableOf[context]) * 256;
+        }
+    }
+
+    // 函数: canonicalCodes
+    // 用途: 由编码长度生成范式哈夫曼编码（与 DEFLATE 相同的分配方式）
+    //
+    // 参数:
+    //    lengths - 下标为符号值、值为编码长度的数组
+    //
+    // 返回:
+    //    各符号的编码；长度非法时返回空数组
+    std::vector<Code> canonicalCodes(const std::vector<uint8_t> &lengths) {
+        // 统计每种长度的编码个数
+        std::vector<uint64_t> lengthCount(MAX_CODE_LENGTH + 1, 0);
+        for (uint8_t length : lengths) {
+            if (length > MAX_CODE_LENGTH) {
+                return {};
+            }
+            lengthCount[length]++;
+        }
+        lengthCount[0] = 0;
+
+        // 校验 Kraft 不等式：逐层计算剩余可用的编码空间（超过符号总数后不再增长，避免溢出）
+        uint64_t available = 1;
+        for (unsigned length = 1; length <= MAX_CODE_LENGTH; length++) {
+            available = std::min<uint64_t>(available * 2, lengths.size() + 1);
+            if (lengthCount[length] > available) {
+                return {};
+            }
+            available -= lengthCount[length];
+        }
+
+        // 计算每种长度的第一个编码值
+        std::vector<uint64_t> nextCode(MAX_CODE_LENGTH + 1, 0);
+        uint64_t code = 0;
+        for (unsigned length = 1; length <= MAX_CODE_LENGTH; length++) {
+            code = (code + lengthCount[length - 1]) << 1;
+            nextCode[length] = code;
+        }
+
+        // 按符号值顺序为同一长度的符号依次分配编码
+        std::vector<Code> codes(lengths.size());
+        for (std::size_t symbol = 0; symbol < lengths.size(); symbol++) {
+            codes[symbol].symbol = static_cast<uint32_t>(symbol);
+            codes[symbol].length = lengths[symbol];
+            codes[symbol].bits = lengths[symbol] ? nextCode[lengths[symbol]]++ : 0;
+        }
+        return codes;
+    }
+
+    // 函数: limitedCodeLengths
+    // 用途: 包合并算法。自最深一层起，每层的物品由全部符号（叶子）与上一层物品两两打包所得的包
+    //       按权重归并而成；在最浅一层选取权重最小的 2n-2 个物品，逐层展开所选的包，
+    //       每个符号被选中的次数即为其编码长度
+    std::vector<uint8_t> limitedCodeLengths(const std::vector<uint64_t> &freq, unsigned maxLength) {
+        std::vector<uint8_t> lengths(freq.size(), 0);
+        std::vector<uint32_t> leaves;
+        for (std::size_t symbol = 0; symbol < freq.size(); symbol++) {
+            if (freq[symbol] > 0) {
+                leaves.push_back(static_cast<uint32_t>(symbol));
+            }
+        }
+        std::size_t n = leaves.size();
+        if (maxLength == 0 || maxLength > MAX_CODE_LENGTH ||
+            (maxLength < 63 && n > (uint64_t(1) << maxLength))) {
+            return {};
+        }
+        if (n <= 1) {
+            if (n == 1) {
+                lengths[leaves[0]] = 1;
+            }
+            return lengths;
+        }
+        // 叶子按（频率, 符号值）递增排序
+        std::sort(leaves.begin(), leaves.end(), [&](uint32_t a, uint32_t b) {
+            return freq[a] != freq[b] ? freq[a] < freq[b] : a < b;
+        });
+
+        // 物品：weight 为权重；symbol 为叶子的符号值，包则为 PACKAGE
+        constexpr uint32_t PACKAGE = 0xFFFFFFFFu;
+        struct Item {
+            uint64_t weight;
+            uint32_t symbol;
+        };
+        // levels[0] 为最浅一层（编码第 1 位），levels[maxLength - 1] 为最深一层
+        std::vector<std::vector<Item>> levels(maxLength);
+        for (unsigned level = maxLength; level-- > 0;) {
+            std::vector<Item> &items = levels[level];
+            items.reserve(2 * n);
+            std::vector<Item> packages;
+            if (level + 1 < maxLength) {
+                const std::vector<Item> &deeper = levels[level + 1];
+                for (std::size_t i = 0; i + 1 < deeper.size(); i += 2) {
+                    packages.push_back(Item{deeper[i].weight + deeper[i + 1].weight, PACKAGE});
+                }
+            }
+            // 归并叶子与包，权重相同时叶子在前
+            std::size_t leaf = 0, package = 0;
+            while (leaf < n || package < packages.size()) {
+                if (package == packages.size() ||
+                    (leaf < n && freq[leaves[leaf]] <= packages[package].weight)) {
+                    items.push_back(Item{freq[leaves[leaf]], leaves[leaf]});
+                    leaf++;
+                } else {
+                    items.push_back(packages[package++]);
+                }
+            }
+        }
+
+        // 自最浅一层起展开：本层选中的每个包对应下一层的两个物品
+        std::size_t selected = 2 * n - 2;
+        for (unsigned level = 0; level < maxLength && selected > 0; level++) {
+            const std::vector<Item> &items = levels[level];
+            std::size_t packagesSelected = 0;
+            for (std::size_t i = 0; i < selected && i < items.size(); i++) {
+                if (items[i].symbol == PACKAGE) {
+                    packagesSelected++;
+                } else {
+                    lengths[items[i].symbol]++;
+                }
+            }
+            selected = 2 * packagesSelected;
+        }
+        return lengths;
+    }
+
+    // 函数: DecodeTable::build
+    // 用途: 由编码列表构建多级解码表
+    //
+    // 参数:
+    //    codes       - 各符号的编码（长度为 0 的项被忽略）
+    //    primaryBits - 主表索引位数，同时也是各级子表索引位数的上限
+    //
+    // 返回:
+    //    构建成功返回 true；编码超长或不满足前缀性质时返回 false
+    bool DecodeTable::build(const std::vector<Code> &codes, unsigned primaryBits) {
+        entries.clear();
+        std::vector<const Code *> used;
+        unsigned maxLength = 0;
+        for (const Code &code : codes) {
+            if (code.length == 0) {
+                continue;
+            }
+            if (code.length > 64) {
+                return false;
+            }
+            used.push_back(&code);
+            maxLength = std::max(maxLength, code.length);
+        }
+        primaryBits = std::max(1u, std::min(primaryBits, 24u));
+        rootBits = std::max(1u, std::min(primaryBits, maxLength));
+        entries.assign(std::size_t(1) << rootBits, Entry{0, 0, 0, EMPTY});
+        return buildLevel(used, 0, 0, rootBits, primaryBits);
+    }
+
+    // 函数: DecodeTable::buildLevel
+    // 用途: 填充一级（主表或子表）。剩余长度不超过本级位数的编码直接展开为符号项，
+    //       其余编码按本级前缀分组，每组递归建立子表
+    //
+    // 参数:
+    //    codes   - 共享同一前缀、需放入本级的编码
+    //    depth   - 已被上级消耗的位数
+    //    offset  - 本级表在 entries 中的起始下标
+    //    bits    - 本级索引位数
+    //    maxBits - 子表索引位数上限
+    bool DecodeTable::buildLevel(const std::vector<const Code *> &codes, unsigned depth,
+                                 std::size_t offset, unsigned bits, unsigned maxBits) {
+        std::map<uint64_t, std::vector<const Code *>> groups;
+        for (const Code *code : codes) {
+            unsigned remain = code->length - depth;
+            if (remain <= bits) {
+                std::size_t first = static_cast<std::size_t>(extractBits(*code, depth, remain)) << (bits - remain);
+                std::size_t span = std::size_t(1) << (bits - remain);
+                for (std::size_t i = first; i < first + span; i++) {
+                    if (entries[offset + i].kind != EMPTY) {
+                        return false;
+                    }
+                    entries[offset + i] = Entry{code->symbol, static_cast<uint8_t>(remain), 0, SYMBOL};
+                }
+            } else {
+                groups[extractBits(*code, depth, bits)].push_back(code);
+            }
+        }
+        for (auto &group : groups) {
+            std::size_t index = offset + static_cast<std::size_t>(group.first);
+            if (entries[index].kind != EMPTY) {
+                return false;
+            }
+            unsigned longest = 0;
+            for (const Code *code : group.second) {
+                longest = std::max(longest, code->length);
+            }
+            unsigned subBits = std::min(maxBits, longest - depth - bits);
+            std::size_t child = entries.size();
+            entries.resize(child + (std::size_t(1) << subBits), Entry{0, 0, 0, EMPTY});
+            entries[index] = Entry{static_cast<uint32_t>(child), static_cast<uint8_t>(bits),
+                                   static_cast<uint8_t>(subBits), LINK};
+            if (!buildLevel(group.second, depth + bits, child, subBits, maxBits)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,430 @@
+#include "lz77.h"
+#include "format.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace LZ77 {
+    const SymbolRange LENGTH_RANGES[LITLEN_SYMBOLS - LITERALS - 1] = {
+        {3, 0}, {4, 0}, {5, 0}, {6, 0}, {7, 0}, {8, 0}, {9, 0}, {10, 0}, {11, 1}, {13, 1},
+        {15, 1}, {17, 1}, {19, 2}, {23, 2}, {27, 2}, {31, 2}, {35, 3}, {43, 3}, {51, 3}, {59, 3},
+        {67, 4}, {83, 4}, {99, 4}, {115, 4}, {131, 5}, {163, 5}, {195, 5}, {227, 5}, {258, 0}};
+
+    const SymbolRange DISTANCE_RANGES[DISTANCE_SYMBOLS] = {
+        {1, 0}, {2, 0}, {3, 0}, {4, 0}, {5, 1}, {7, 1}, {9, 2}, {13, 2}, {17, 3}, {25, 3},
+        {33, 4}, {49, 4}, {65, 5}, {97, 5}, {129, 6}, {193, 6}, {257, 7}, {385, 7}, {513, 8}, {769, 8},
+        {1025, 9}, {1537, 9}, {2049, 10}, {3073, 10}, {4097, 11}, {6145, 11}, {8193, 12}, {12289, 12},
+        {16385, 13}, {24577, 13}};
+
+    static_assert(LITLEN_SYMBOLS + DISTANCE_SYMBOLS == Format::LZ_TABLE_SIZE,
+                  "LZ77 block tables must match the file format");
+}
+
+namespace {
+    using LZ77::Token;
+    using LZ77::MIN_MATCH;
+    using LZ77::MAX_MATCH;
+    using LZ77::WINDOW_SIZE;
+
+    // 哈希表以每个位置起的 3 个字节为键，共 2^HASH_BITS 个链头
+    constexpr unsigned HASH_BITS = 15;
+
+    // 贪心与惰性解析中，距离超过此值的 3 字节匹配不如输出 3 个字面量，不予采用
+    constexpr unsigned TOO_FAR = 4096;
+
+    // 各策略的匹配查找参数
+    struct Config {
+        unsigned maxChain;   // 每次查找最多比较的候选位置个数
+        unsigned niceLength; // 找到不短于此长度的匹配即停止查找
+        unsigned lazyLength; // 惰性解析：当前匹配短于此长度时才查看下一位置
+    };
+
+    const Config GREEDY_CONFIG = {16, 32, 0};
+    const Config LAZY_CONFIG = {128, 128, 32};
+    const Config OPTIMAL_CONFIG = {64, 128, 0};
+
+    // 长度、距离到符号的查找表
+    struct SymbolTables {
+        uint16_t lengthSymbol[MAX_MATCH + 1]; // 下标为匹配长度
+        uint8_t distanceSymbol[512];          // 距离 d：d <= 256 时下标为 d-1，否则为 256 + ((d-1) >> 7)
+
+        SymbolTables() {
+            for (unsigned s = 0; s < LZ77::LITLEN_SYMBOLS - LZ77::LITERALS - 1; s++) {
+                const LZ77::SymbolRange &range = LZ77::LENGTH_RANGES[s];
+                for (unsigned length = range.base; length < range.base + (1u << range.extra) && length <= MAX_MATCH;
+                     length++) {
+                    lengthSymbol[length] = static_cast<uint16_t>(LZ77::LITERALS + 1 + s);
+                }
+            }
+            for (unsigned s = 0; s < LZ77::DISTANCE_SYMBOLS; s++) {
+                const LZ77::SymbolRange &range = LZ77::DISTANCE_RANGES[s];
+                for (unsigned distance = range.base; distance < range.base + (1u << range.extra); distance++) {
+                    unsigned d = distance - 1;
+                    distanceSymbol[d < 256 ? d : 256 + (d >> 7)] = static_cast<uint8_t>(s);
+                }
+            }
+        }
+    };
+
+    const SymbolTables TABLES;
+
+    inline unsigned lengthSymbol(unsigned length) {
+        return TABLES.lengthSymbol[length];
+    }
+
+    inline unsigned distanceSymbol(unsigned distance) {
+        unsigned d = distance - 1;
+        return TABLES.distanceSymbol[d < 256 ? d : 256 + (d >> 7)];
+    }
+
+    // 函数: putWithExtra
+    // 作用: 写入符号的编码及其后的 extra 个附加位（合计不超过 64 位时合并为一次写入）
+    inline void putWithExtra(Huffman::BitWriter &writer, const Huffman::Code &code, unsigned extra, unsigned value) {
+        if (code.length + extra <= 64) {
+            writer.put((code.bits << extra) | value, code.length + extra);
+            return;
+        }
+        writer.put(code.bits, code.length);
+        writer.put(value, extra);
+    }
+
+    // 函数: matchLength
+    // 作用: a、b 两处起相同字节的个数（不超过 limit），每次比较 8 个字节
+    inline unsigned matchLength(const unsigned char *a, const unsigned char *b, unsigned limit) {
+        unsigned n = 0;
+        while (n + 8 <= limit) {
+            uint64_t x, y;
+            std::memcpy(&x, a + n, 8);
+            std::memcpy(&y, b + n, 8);
+            if (x != y) {
+                break;
+            }
+            n += 8;
+        }
+        while (n < limit && a[n] == b[n]) {
+            n++;
+        }
+        return n;
+    }
+
+    // 类: MatchFinder
+    // 作用: 哈希链匹配查找。以每个位置起的 3 个字节为键，head 记录各键最近出现的位置，
+    //       prev 记录窗口内每个位置上一次出现相同键的位置（以位置对窗口大小取模为下标），
+    //       沿链即可由近及远枚举窗口内的候选位置。位置须按递增顺序加入
+    class MatchFinder {
+    public:
+        MatchFinder(const unsigned char *data, std::size_t size, unsigned maxChain)
+            : data(data), size(size), maxChain(maxChain), head(std::size_t(1) << HASH_BITS, NO_POS),
+              prev(WINDOW_SIZE, NO_POS) {}
+
+        // 将位置 pos 加入哈希链（其后不足 MIN_MATCH 个字节时忽略）
+        void insert(std::size_t pos) {
+            if (pos + MIN_MATCH > size) {
+                return;
+            }
+            uint32_t h = hash(pos);
+            prev[pos & (WINDOW_SIZE - 1)] = head[h];
+            head[h] = pos;
+        }
+
+        // 查找位置 pos（尚未加入哈希链）的最长匹配，返回其长度（不足 MIN_MATCH 时为 0），distance 返回距离
+        unsigned longest(std::size_t pos, unsigned niceLength, unsigned &distance) const {
+            unsigned best = 0;
+            walk(pos, niceLength, [&](unsigned length, unsigned dist) {
+                best = length;
+                distance = dist;
+            });
+            return best;
+        }
+
+        // 收集位置 pos（尚未加入哈希链）的匹配，按长度递增排列：
+        // 每个长度更长的匹配只保留最先找到（即距离最近）的一个
+        void matches(std::size_t pos, unsigned niceLength, std::vector<Token> &out) const {
+            out.clear();
+            walk(pos, niceLength, [&](unsigned length, unsigned dist) {
+                out.push_back(Token{static_cast<uint16_t>(length), static_cast<uint16_t>(dist)});
+            });
+        }
+
+    private:
+        static constexpr std::size_t NO_POS = std::numeric_limits<std::size_t>::max();
+
+        const unsigned char *data;
+        std::size_t size;
+        unsigned maxChain;
+        std::vector<std::size_t> head;
+        std::vector<std::size_t> prev;
+
+        inline uint32_t hash(std::size_t pos) const {
+            uint32_t key = (static_cast<uint32_t>(data[pos]) << 16) | (static_cast<uint32_t>(data[pos + 1]) << 8) |
+                           data[pos + 2];
+            return (key * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        // 沿哈希链由近及远比较候选位置，每找到一个更长的匹配调用一次 found(length, distance)
+        template<typename Found>
+        void walk(std::size_t pos, unsigned niceLength, const Found &found) const {
+            if (pos + MIN_MATCH > size) {
+                return;
+            }
+            unsigned limit = static_cast<unsigned>(std::min<std::size_t>(MAX_MATCH, size - pos));
+            niceLength = std::min(niceLength, limit);
+            unsigned best = MIN_MATCH - 1;
+            const unsigned char *current = data + pos;
+            std::size_t candidate = head[hash(pos)];
+            for (unsigned chain = maxChain; chain > 0 && candidate != NO_POS && pos - candidate <= WINDOW_SIZE;
+                 chain--) {
+                const unsigned char *match = data + candidate;
+                // 先比较当前最长匹配之后的一个字节，不同则不可能更长
+                if (match[best] == current[best]) {
+                    unsigned length = matchLength(match, current, limit);
+                    if (length > best) {
+                        best = length;
+                        found(length, static_cast<unsigned>(pos - candidate));
+                        if (length >= niceLength) {
+                            return;
+                        }
+                    }
+                }
+                candidate = prev[candidate & (WINDOW_SIZE - 1)];
+            }
+        }
+    };
+
+    // 函数: parseGreedy
+    // 作用: 贪心解析：每个位置使用找到的最长匹配，没有匹配时输出字面量
+    void parseGreedy(const unsigned char *data, std::size_t size, const Config &config, std::vector<Token> &tokens) {
+        MatchFinder finder(data, size, config.maxChain);
+        std::size_t pos = 0;
+        while (pos < size) {
+            unsigned distance = 0;
+            unsigned length = finder.longest(pos, config.niceLength, distance);
+            finder.insert(pos);
+            if (length < MIN_MATCH || (length == MIN_MATCH && distance > TOO_FAR)) {
+                tokens.push_back(Token{0, data[pos]});
+                pos++;
+                continue;
+            }
+            tokens.push_back(Token{static_cast<uint16_t>(length), static_cast<uint16_t>(distance)});
+            for (std::size_t end = pos + length; ++pos < end;) {
+                finder.insert(pos);
+            }
+        }
+    }
+
+    // 函数: parseLazy
+    // 作用: 惰性解析：找到匹配后再查看下一位置，若其匹配更长则当前位置改为输出字面量，
+    //       当前匹配已足够长（不短于 lazyLength）时直接采用
+    void parseLazy(const unsigned char *data, std::size_t size, const Config &config, std::vector<Token> &tokens) {
+        MatchFinder finder(data, size, config.maxChain);
+        // 查找位置 p 的匹配并将 p 加入哈希链，不值得采用的匹配记为 0
+        auto find = [&](std::size_t p, unsigned &distance) {
+            unsigned length = finder.longest(p, config.niceLength, distance);
+            finder.insert(p);
+            return length < MIN_MATCH || (length == MIN_MATCH && distance > TOO_FAR) ? 0u : length;
+        };
+        std::size_t pos = 0;
+        unsigned distance = 0;
+        unsigned length = size > 0 ? find(0, distance) : 0;
+        while (pos < size) {
+            if (length == 0) {
+                tokens.push_back(Token{0, data[pos]});
+                if (++pos < size) {
+                    length = find(pos, distance);
+                }
+                continue;
+            }
+            std::size_t inserted = pos + 1; // 下一个待加入哈希链的位置
+            if (length < config.lazyLength && pos + 1 < size) {
+                unsigned nextDistance = 0;
+                unsigned nextLength = find(pos + 1, nextDistance);
+                if (nextLength > length) {
+                    tokens.push_back(Token{0, data[pos]});
+                    pos++;
+                    length = nextLength;
+                    distance = nextDistance;
+                    continue;
+                }
+                inserted = pos + 2;
+            }
+            tokens.push_back(Token{static_cast<uint16_t>(length), static_cast<uint16_t>(distance)});
+            for (pos += length; inserted < pos; inserted++) {
+                finder.insert(inserted);
+            }
+            if (pos < size) {
+                length = find(pos, distance);
+            }
+        }
+    }
+
+    // 函数: symbolCosts
+    // 作用: 由符号出现次数估计各符号的编码位数 log2(总数 / 次数)（加一平滑，未出现的符号代价较高）
+    std::vector<float> symbolCosts(const std::vector<uint64_t> &freq) {
+        double total = static_cast<double>(freq.size());
+        for (uint64_t f : freq) {
+            total += static_cast<double>(f);
+        }
+        std::vector<float> costs(freq.size());
+        for (std::size_t s = 0; s < freq.size(); s++) {
+            costs[s] = static_cast<float>(std::max(1.0, std::log2(total / static_cast<double>(freq[s] + 1))));
+        }
+        return costs;
+    }
+
+    // 函数: parseOptimal
+    // 作用: 最优解析：先以惰性解析的符号统计估计各符号的编码位数，再自前向后做动态规划，
+    //       cost[i] 为编码前 i 个字节的最小估计位数，每个位置可输出字面量，或采用其任一匹配的任一长度
+    //       （同一长度使用距离最近的匹配）；最后自末尾回溯得到序列。
+    //       找到不短于 niceLength 的匹配时直接采用，其覆盖的位置不再展开，以限制高度重复数据的耗时
+    void parseOptimal(const unsigned char *data, std::size_t size, const Config &config, std::vector<Token> &tokens) {
+        // 1. 估计各符号的编码位数
+        std::vector<Token> initial;
+        parseLazy(data, size, LAZY_CONFIG, initial);
+        std::vector<uint64_t> litLenFreq, distanceFreq;
+        LZ77::countSymbols(initial, litLenFreq, distanceFreq);
+        initial = std::vector<Token>();
+        std::vector<float> litLenCost = symbolCosts(litLenFreq);
+        std::vector<float> distanceCost = symbolCosts(distanceFreq);
+        std::vector<float> lengthCost(MAX_MATCH + 1, 0.0f);
+        for (unsigned length = MIN_MATCH; length <= MAX_MATCH; length++) {
+            unsigned symbol = lengthSymbol(length);
+            lengthCost[length] = litLenCost[symbol] + LZ77::LENGTH_RANGES[symbol - LZ77::LITERALS - 1].extra;
+        }
+
+        // 2. 动态规划：choice[i] 为到达位置 i 的最后一个字面量或匹配
+        std::vector<float> cost(size + 1, std::numeric_limits<float>::infinity());
+        std::vector<Token> choice(size + 1, Token{0, 0});
+        cost[0] = 0.0f;
+        MatchFinder finder(data, size, config.maxChain);
+        std::vector<Token> found;
+        auto relax = [&](std::size_t from, unsigned length, unsigned distance, float price) {
+            if (cost[from] + price < cost[from + length]) {
+                cost[from + length] = cost[from] + price;
+                choice[from + length] = Token{static_cast<uint16_t>(length), static_cast<uint16_t>(distance)};
+            }
+        };
+        auto distancePrice = [&](unsigned distance) {
+            unsigned symbol = distanceSymbol(distance);
+            return distanceCost[symbol] + LZ77::DISTANCE_RANGES[symbol].extra;
+        };
+        std::size_t pos = 0;
+        while (pos < size) {
+            if (cost[pos] + litLenCost[data[pos]] < cost[pos + 1]) {
+                cost[pos + 1] = cost[pos] + litLenCost[data[pos]];
+                choice[pos + 1] = Token{0, data[pos]};
+            }
+            finder.matches(pos, config.niceLength, found);
+            finder.insert(pos);
+            if (!found.empty() && found.back().length >= config.niceLength) {
+                const Token &match = found.back();
+                relax(pos, match.length, match.value, lengthCost[match.length] + distancePrice(match.value));
+                for (std::size_t end = pos + match.length; ++pos < end;) {
+                    finder.insert(pos);
+                }
+                continue;
+            }
+            unsigned length = MIN_MATCH;
+            for (const Token &match : found) {
+                float price = distancePrice(match.value);
+                for (; length <= match.length; length++) {
+                    relax(pos, length, match.value, lengthCost[length] + price);
+                }
+            }
+            pos++;
+        }
+
+        // 3. 自末尾回溯
+        std::size_t first = tokens.size();
+        for (std::size_t end = size; end > 0;) {
+            const Token &token = choice[end];
+            tokens.push_back(token);
+            end -= token.length ? token.length : 1;
+        }
+        std::reverse(tokens.begin() + static_cast<std::ptrdiff_t>(first), tokens.end());
+    }
+}
+
+namespace LZ77 {
+    // 函数: parseLevel
+    // 用途: 由名称得到匹配查找策略
+    bool parseLevel(const std::string &name, Level &level) {
+        if (name == "greedy") {
+            level = Level::GREEDY;
+        } else if (name == "lazy") {
+            level = Level::LAZY;
+        } else if (name == "optimal") {
+            level = Level::OPTIMAL;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // 函数: levelName
+    // 用途: 匹配查找策略的名称
+    const char *levelName(Level level) {
+        switch (level) {
+        case Level::GREEDY:
+            return "greedy";
+        case Level::LAZY:
+            return "lazy";
+        case Level::OPTIMAL:
+            return "optimal";
+        default:
+            return "none";
+        }
+    }
+
+    // 函数: parse
+    // 用途: 按指定策略将数据转换为字面量与匹配的序列
+    void parse(const unsigned char *data, std::size_t size, Level level, std::vector<Token> &tokens) {
+        tokens.clear();
+        tokens.reserve(size / 4 + 16);
+        switch (level) {
+        case Level::GREEDY:
+            parseGreedy(data, size, GREEDY_CONFIG, tokens);
+            break;
+        case Level::OPTIMAL:
+            parseOptimal(data, size, OPTIMAL_CONFIG, tokens);
+            break;
+        default:
+            parseLazy(data, size, LAZY_CONFIG, tokens);
+            break;
+        }
+    }
+
+    // 函数: countSymbols
+    // 用途: 统计各字面量/长度符号与距离符号的出现次数
+    void countSymbols(const std::vector<Token> &tokens, std::vector<uint64_t> &litLen, std::vector<uint64_t> &distance) {
+        litLen.assign(LITLEN_SYMBOLS, 0);
+        distance.assign(DISTANCE_SYMBOLS, 0);
+        for (const Token &token : tokens) {
+            if (token.length == 0) {
+                litLen[token.value]++;
+            } else {
+                litLen[lengthSymbol(token.length)]++;
+                distance[distanceSymbol(token.value)]++;
+            }
+        }
+    }
+
+    // 函数: encode
+    // 用途: 按两张码表写入字面量与匹配的序列
+    void encode(const std::vector<Token> &tokens, const std::vector<Huffman::Code> &litLen,
+                const std::vector<Huffman::Code> &distance, Huffman::BitWriter &writer) {
+        for (const Token &token : tokens) {
+            if (token.length == 0) {
+                const Huffman::Code &code = litLen[token.value];
+                writer.put(code.bits, code.length);
+                continue;
+            }
+            unsigned symbol = lengthSymbol(token.length);
+            const SymbolRange &lengthRange = LENGTH_RANGES[symbol - LITERALS - 1];
+            putWithExtra(writer, litLen[symbol], lengthRange.extra, token.length - lengthRange.base);
+            symbol = distanceSymbol(token.value);
+            const SymbolRange &distanceRange = DISTANCE_RANGES[symbol];
+            putWithExtra(writer, distance[symbol], distanceRange.extra, token.value - distanceRange.base);
+        }
+    }
+}
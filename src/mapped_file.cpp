@@ -0,0 +1,92 @@
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+// 函数: MappedFile::open
+// 用途: 打开并映射已有文件。空文件不建立映射，data() 为空指针、size() 为 0
+//
+// 参数:
+//    path - 文件路径
+//    mode - 映射方式
+bool MappedFile::open(const std::string &path, Mode mode) {
+    close();
+    fd = ::open(path.c_str(), mode == READ_WRITE ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close();
+        return false;
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    int protection = mode == READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    return map(protection, mode == READ_WRITE ? MAP_SHARED : MAP_PRIVATE);
+}
+
+// 函数: MappedFile::create
+// 用途: 创建（或截断）文件并预先设定长度，再以共享方式映射，写入映射即写入文件
+//
+// 参数:
+//    path - 文件路径
+//    size - 文件字节数
+bool MappedFile::create(const std::string &path, uint64_t size) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close();
+        return false;
+    }
+    length = static_cast<std::size_t>(size);
+    return map(PROT_READ | PROT_WRITE, MAP_SHARED);
+}
+
+void MappedFile::adviseSequential() {
+    if (address) {
+        madvise(address, length, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::adviseWillNeed() {
+    if (address) {
+        madvise(address, length, MADV_WILLNEED);
+    }
+}
+
+// 函数: MappedFile::close
+// 用途: 解除映射并关闭文件（共享映射中的修改由内核写回文件）
+void MappedFile::close() {
+    if (address) {
+        munmap(address, length);
+        address = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    length = 0;
+}
+
+// 函数: MappedFile::map
+// 用途: 按当前长度建立映射，长度为 0 时不映射
+bool MappedFile::map(int protection, int flags) {
+    if (length == 0) {
+        return true;
+    }
+    void *result = mmap(nullptr, length, protection, flags, fd, 0);
+    if (result == MAP_FAILED) {
+        close();
+        return false;
+    }
+    address = static_cast<unsigned char *>(result);
+    return true;
+}
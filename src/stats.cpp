@@ -0,0 +1,186 @@
+#include "stats.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace {
+    // 多个线程（如批处理）同时输出统计信息时保证各条记录完整
+    std::mutex writeMutex;
+
+    // 函数: formatNumber
+    // 用途: 数值格式化：整数不带小数点，其余保留 6 位有效数字
+    std::string formatNumber(double value) {
+        std::ostringstream out;
+        if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 1e18) {
+            out << static_cast<long long>(value);
+        } else if (std::isfinite(value)) {
+            out << std::setprecision(6) << value;
+        } else {
+            out << "null";
+        }
+        return out.str();
+    }
+
+    // 函数: jsonString
+    // 用途: 转义为 JSON 字符串
+    std::string jsonString(const std::string &text) {
+        std::string out = "\"";
+        for (unsigned char c : text) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += static_cast<char>(c);
+                }
+            }
+        }
+        return out + "\"";
+    }
+
+    // 函数: csvField
+    // 用途: 含逗号、引号或换行的字段用引号括起
+    std::string csvField(const std::string &text) {
+        if (text.find_first_of(",\"\n\r") == std::string::npos) {
+            return text;
+        }
+        std::string out = "\"";
+        for (char c : text) {
+            out += c == '"' ? std::string("\"\"") : std::string(1, c);
+        }
+        return out + "\"";
+    }
+}
+
+Stats::Timer::Timer(Stats *stats, const char *phase) : stats(stats), phase(phase) {
+    if (stats) {
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+void Stats::Timer::stop() {
+    if (!stats) {
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    stats->addTime(phase, std::chrono::duration<double, std::milli>(end - start).count());
+    stats = nullptr;
+}
+
+void Stats::addTime(const std::string &phase, double milliseconds) {
+    for (auto &entry : phases) {
+        if (entry.first == phase) {
+            entry.second += milliseconds;
+            return;
+        }
+    }
+    phases.emplace_back(phase, milliseconds);
+}
+
+void Stats::set(const std::string &name, double value) {
+    setValue(name, formatNumber(value), true);
+}
+
+void Stats::set(const std::string &name, const std::string &value) {
+    setValue(name, value, false);
+}
+
+void Stats::setValue(const std::string &name, const std::string &text, bool isNumber) {
+    for (Value &value : values) {
+        if (value.name == name) {
+            value.text = text;
+            value.isNumber = isNumber;
+            return;
+        }
+    }
+    values.push_back(Value{name, text, isNumber});
+}
+
+// 函数: Stats::toJson
+// 用途: 指标依次作为对象成员，阶段耗时放在 "phases_ms" 子对象中
+std::string Stats::toJson() const {
+    std::string out = "{";
+    for (const Value &value : values) {
+        out += jsonString(value.name) + ":" + (value.isNumber ? value.text : jsonString(value.text)) + ",";
+    }
+    out += "\"phases_ms\":{";
+    for (std::size_t i = 0; i < phases.size(); i++) {
+        out += (i ? "," : "") + jsonString(phases[i].first) + ":" + formatNumber(phases[i].second);
+    }
+    return out + "}}";
+}
+
+// 函数: Stats::toCsv
+// 用途: 每项指标一行；各行第一列为本次记录的 file 指标，便于多条记录写入同一文件后区分
+std::string Stats::toCsv() const {
+    std::string file;
+    for (const Value &value : values) {
+        if (value.name == "file") {
+            file = csvField(value.text);
+        }
+    }
+    std::string out;
+    for (const Value &value : values) {
+        out += file + "," + csvField(value.name) + "," + csvField(value.text) + "\n";
+    }
+    for (const auto &phase : phases) {
+        out += file + "," + csvField("time_ms." + phase.first) + "," + formatNumber(phase.second) + "\n";
+    }
+    return out;
+}
+
+// 函数: Stats::write
+// 用途: 追加输出一条记录
+//
+// 参数:
+//    target - "-" 表示标准错误，否则为输出文件路径
+//    format - 输出格式
+//
+// 返回:
+//    成功返回 true，无法写入文件时输出错误信息并返回 false
+bool Stats::write(const std::string &target, Format format) const {
+    std::string record = format == JSON ? toJson() + "\n" : toCsv();
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (target == "-") {
+        std::cerr << record << std::flush;
+        return true;
+    }
+    std::ofstream out(target, std::ios::app | std::ios::ate);
+    if (!out) {
+        std::cerr << "Error opening stats file: " << target << std::endl;
+        return false;
+    }
+    if (format == CSV && out.tellp() == 0) {
+        out << "file,metric,value\n";
+    }
+    out << record;
+    return static_cast<bool>(out);
+}
+
+// 函数: Stats::entropy
+// 用途: 信息熵 H = -Σ p·log2(p)，即理想编码下每字节的平均位数
+double Stats::entropy(const std::vector<uint64_t> &freq) {
+    uint64_t total = 0;
+    for (uint64_t f : freq) {
+        total += f;
+    }
+    double h = 0;
+    for (uint64_t f : freq) {
+        if (f > 0) {
+            double p = static_cast<double>(f) / total;
+            h -= p * std::log2(p);
+        }
+    }
+    return h;
+}
@@ -0,0 +1,122 @@
+#include "thread_pool.h"
+
+namespace {
+    // 当前线程所属的线程池及其在线程池中的下标（非工作线程为 nullptr）
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local std::size_t currentIndex = 0;
+}
+
+// 函数: ThreadPool::resolveThreads
+// 用途: 将 0 解析为硬件并发线程数，保证结果至少为 1
+unsigned ThreadPool::resolveThreads(unsigned threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return threads == 0 ? 1 : threads;
+}
+
+ThreadPool::ThreadPool(unsigned threads) {
+    threads = resolveThreads(threads);
+    for (unsigned i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+// 函数: ThreadPool::submit
+// 用途: 工作线程提交的任务放入自己的队列（随后优先由自己执行），外部线程提交的任务轮流放入各队列
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t index = currentPool == this ? currentIndex : nextQueue++ % queues.size();
+    {
+        // 先在 mutex 内增加计数再放入队列：正在检查等待条件的工作线程不会错过通知，
+        // 任务也不会在计数增加之前被取出并完成
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+        queued++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this]() { return pending == 0; });
+}
+
+// 函数: ThreadPool::parallelFor
+// 用途: 每个下标提交为一个任务并等待全部完成
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &func) {
+    for (std::size_t i = 0; i < count; i++) {
+        submit([&func, i]() { func(i); });
+    }
+    wait();
+}
+
+// 函数: ThreadPool::takeTask
+// 用途: 取出一个任务：先从自己队列的尾部取（最近提交、数据仍在缓存中），
+//       再依次从其他队列的头部窃取（最早提交的任务）
+//
+// 返回:
+//    取到任务返回 true
+bool ThreadPool::takeTask(std::size_t self, std::function<void()> &task) {
+    for (std::size_t k = 0; k < queues.size(); k++) {
+        std::size_t index = (self + k) % queues.size();
+        Queue &queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (k == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+// 函数: ThreadPool::workerLoop
+// 用途: 工作线程主循环：取出或窃取任务并执行，所有队列为空时休眠，直至线程池析构
+void ThreadPool::workerLoop(std::size_t self) {
+    currentPool = this;
+    currentIndex = self;
+    while (true) {
+        std::function<void()> task;
+        if (!takeTask(self, task)) {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [this]() { return stopping || queued > 0; });
+            if (queued == 0) {
+                return;
+            }
+            continue;
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+            if (pending == 0) {
+                allDone.notify_all();
+            }
+        }
+    }
+}
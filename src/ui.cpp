@@ -4,6 +4,8 @@
 #include <array>
 #include <memory>
 #include <stdexcept>
+#include <filesystem>
+#include <system_error>
 #include "compressor.h"
 #include "decompressor.h"
 
@@ -37,6 +39,14 @@ std::string executeCommand(const char* cmd) {
     return result;
 }
 
+// UI 类成员函数: useStreaming
+// 用途: 判断文件是否足够大，需要使用流式处理
+bool UI::useStreaming(const std::string &path) {
+    std::error_code ec;
+    std::uintmax_t size = std::filesystem::file_size(path, ec);
+    return !ec && size >= STREAMING_THRESHOLD;
+}
+
 // UI 类成员函数: showMenu
 // 用途: 显示 Zenity 图形界面菜单，供用户选择操作（压缩或解压文件）
 //
@@ -76,8 +86,12 @@ void UI::processCompression() {
         key = executeCommand("zenity --entry --title=\"Encryption Key\" --text=\"Please enter encryption key\" --hide-text");
     }
 
-    // 调用 Compressor 进行文件压缩处理，传入必要的参数
-    Compressor::compressFile(inputFile, senderInfo, receiverInfo, encrypt, key);
+    // 调用 Compressor 进行文件压缩处理，传入必要的参数（大文件使用流式压缩）
+    Compressor::Options options;
+    options.streaming = useStreaming(inputFile);
+    options.syncInterval = SYNC_INTERVAL;
+    options.verbosity = Verbosity::DEBUG;
+    Compressor::compressFile(inputFile, senderInfo, receiverInfo, encrypt, key, options);
     
     // 压缩完成后通过 Zenity 显示提示信息，告知压缩后的文件位置
     system(("zenity --info --text=\"File compressed: " + inputFile + ".compressed\"").c_str());
@@ -103,10 +117,16 @@ void UI::processDecompression() {
         key = executeCommand("zenity --entry --title=\"Decryption Key\" --text=\"Please enter decryption key\" --hide-text");
     }
 
-    // 调用两种不同的解压缩函数：
-    //  HashDecompressor 使用哈希表方式解码，TrieDecompressor 使用字典树解码
-    HashDecompressor::decompressFile(compressedFile, senderInfo, receiverInfo, decrypt, key);
-    TrieDecompressor::decompressFile(compressedFile, senderInfo, receiverInfo, decrypt, key);
+    // 调用三种不同的解压缩函数：
+    //  HashDecompressor 使用哈希表方式解码，TrieDecompressor 使用字典树解码，
+    //  TableDecompressor 使用多位查表方式解码
+    //  大文件使用流式解压，分块压缩的文件使用全部硬件线程并行解码
+    Decompressor::Options options;
+    options.streaming = useStreaming(compressedFile);
+    options.threads = 0;
+    HashDecompressor::decompressFile(compressedFile, senderInfo, receiverInfo, decrypt, key, options);
+    TrieDecompressor::decompressFile(compressedFile, senderInfo, receiverInfo, decrypt, key, options);
+    TableDecompressor::decompressFile(compressedFile, senderInfo, receiverInfo, decrypt, key, options);
     
     // 解压完成后显示提示信息
     system(("zenity --info --text=\"File decompressed: " + compressedFile + ".decompressed\"").c_str());